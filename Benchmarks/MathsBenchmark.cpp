@@ -0,0 +1,120 @@
+/*
+Compares the FastMaths functions against the exact versions they replace -
+how long each takes per call, and the worst relative error seen over a large
+set of random inputs. Run it in Release, or the timings are meaningless!
+*/
+#include "../Common/FastMaths.h"
+#include "../Common/Vector3.h"
+#include "../Common/Quaternion.h"
+
+#include <chrono>
+#include <vector>
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace NCL::Maths;
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+const int INPUT_COUNT	= 1 << 20;
+const int REPEATS		= 10;
+
+//Stops the compiler from throwing away results we never look at
+volatile float benchSink = 0.0f;
+
+//Templated on the function, rather than using std::function, so the call
+//gets inlined - otherwise we'd mostly be timing the call overhead!
+template<class F>
+double TimeNanoseconds(const F& func) {
+	float sum = 0.0f;
+	auto start = BenchClock::now();
+	for (int r = 0; r < REPEATS; ++r) {
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			sum += func(i);
+		}
+	}
+	auto end = BenchClock::now();
+	benchSink = sum;
+	return std::chrono::duration<double, std::nano>(end - start).count() / ((double)INPUT_COUNT * REPEATS);
+}
+
+template<class E, class F>
+float MaxRelativeError(const E& exact, const F& fast, float absFloor) {
+	float worst = 0.0f;
+	for (int i = 0; i < INPUT_COUNT; ++i) {
+		float e = exact(i);
+		float f = fast(i);
+		//Near zero, relative error is meaningless - so below absFloor it's absolute
+		float err = std::fabs(f - e) / std::max(std::fabs(e), absFloor);
+		worst = std::max(worst, err);
+	}
+	return worst;
+}
+
+template<class E, class F>
+void Report(const std::string& name, const E& exact, const F& fast, float absFloor = 1e-30f) {
+	double exactTime	= TimeNanoseconds(exact);
+	double fastTime		= TimeNanoseconds(fast);
+	float  error		= MaxRelativeError(exact, fast, absFloor);
+
+	std::cout << std::left << std::setw(24) << name << std::right
+		<< std::setw(12) << std::fixed << std::setprecision(3) << exactTime
+		<< std::setw(12) << fastTime
+		<< std::setw(10) << std::setprecision(2) << (exactTime / fastTime) << "x"
+		<< std::setw(14) << std::scientific << std::setprecision(2) << error
+		<< std::defaultfloat << std::endl;
+}
+
+int main() {
+	std::mt19937 gen(1234);
+	std::uniform_real_distribution<float> positive(1e-4f, 1e4f);
+	std::uniform_real_distribution<float> angles(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> drift(-1e-3f, 1e-3f);
+
+	std::vector<float>		scalars(INPUT_COUNT);
+	std::vector<float>		angleInputs(INPUT_COUNT);
+	std::vector<Vector3>	vectors(INPUT_COUNT);
+	std::vector<Quaternion>	quats(INPUT_COUNT);
+
+	for (int i = 0; i < INPUT_COUNT; ++i) {
+		scalars[i]		= positive(gen);
+		angleInputs[i]	= angles(gen);
+		vectors[i]		= Vector3(unit(gen), unit(gen), unit(gen)) * 100.0f;
+
+		//Unit quaternions, nudged off unit length as integration would
+		Quaternion q(unit(gen), unit(gen), unit(gen), unit(gen));
+		q.Normalise();
+		quats[i] = q * (1.0f + drift(gen));
+	}
+
+	std::cout << std::left << std::setw(24) << "Function" << std::right
+		<< std::setw(12) << "exact ns" << std::setw(12) << "fast ns"
+		<< std::setw(11) << "speedup" << std::setw(14) << "max error" << std::endl;
+
+	Report("InvSqrt",
+		[&](int i) { return 1.0f / std::sqrt(scalars[i]); },
+		[&](int i) { return FastInvSqrt(scalars[i]); });
+
+	Report("Sin |x| < 1000",
+		[&](int i) { return std::sin(angleInputs[i]); },
+		[&](int i) { return FastSin(angleInputs[i]); }, 1.0f);
+
+	Report("Cos |x| < 1000",
+		[&](int i) { return std::cos(angleInputs[i]); },
+		[&](int i) { return FastCos(angleInputs[i]); }, 1.0f);
+
+	Report("Vector3 Normalise",
+		[&](int i) { return vectors[i].Normalised().x; },
+		[&](int i) { return FastNormalised(vectors[i]).x; }, 1e-3f);
+
+	Report("Quaternion Normalise",
+		[&](int i) { Quaternion q = quats[i]; q.Normalise(); return q.x; },
+		[&](int i) { Quaternion q = quats[i]; FastRenormalise(q); return q.x; }, 1e-3f);
+
+	return 0;
+}
@@ -0,0 +1,223 @@
+/*
+Checks the SSE paths of the maths classes against the plain C++ versions they
+replace. The same program is built twice - once as normal, and once as
+MathsCheckScalar, with NCL_FORCE_SCALAR defined, so every maths class falls
+back to its scalar code. The scalar build writes out its results for a fixed
+set of random inputs, and the normal build works out the same things and
+compares them, printing a line for each operation that's out by more than
+rounding error, and returning non-zero if any are.
+
+Usage:
+	MathsCheckScalar --write maths_scalar.bin
+	MathsCheck --compare maths_scalar.bin
+
+The inputs always come from the same seed, so the two builds always agree on
+them. Built without SSE, both sides are scalar, and the check is trivial.
+*/
+#include "../Common/Matrix4.h"
+#include "../Common/Vector3.h"
+#include "../Common/Vector4.h"
+#include "../Common/Quaternion.h"
+#include "../Common/TRSBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::Maths;
+
+namespace {
+	const int			INPUT_COUNT	= 4096;
+	const unsigned int	INPUT_SEED	= 1;
+
+	//Summing the same products in a different order can move the last bit or
+	//so - anything more than that is a real difference
+	const float TOLERANCE = 1e-5f;
+
+	enum Operation {
+		MATRIX_MATRIX,
+		MATRIX_VECTOR4,
+		MATRIX_VECTOR3,
+		QUATERNION_QUATERNION,
+		QUATERNION_NORMALISE,
+		TRS_COMPOSE,
+		OPERATION_COUNT
+	};
+
+	const char* OPERATION_NAMES[OPERATION_COUNT] = {
+		"Matrix4 * Matrix4",
+		"Matrix4 * Vector4",
+		"Matrix4 * Vector3",
+		"Quaternion * Quaternion",
+		"Quaternion::Normalise",
+		"TRSBatch::Compose"
+	};
+
+	typedef std::vector<float> Results[OPERATION_COUNT];
+
+	void Append(std::vector<float>& out, const float* values, int count) {
+		out.insert(out.end(), values, values + count);
+	}
+
+	Quaternion RandomQuaternion(std::mt19937& rng) {
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		return Quaternion(value(rng), value(rng), value(rng), value(rng));
+	}
+
+	/*
+	General matrices are fine for multiplying together, but a Vector3 gets
+	divided by w at the end, which blows up any difference when w is near
+	zero - so those get affine matrices, like real transforms.
+	*/
+	void RunOperations(Results& results) {
+		std::mt19937 rng(INPUT_SEED);
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> scale(0.1f, 5.0f);
+
+		TRSBatch batch;
+		for (int i = 0; i < INPUT_COUNT; ++i) {
+			Matrix4 a;
+			Matrix4 b;
+			for (int j = 0; j < 16; ++j) {
+				a.values[j] = value(rng);
+				b.values[j] = value(rng);
+			}
+			Vector4 v4(value(rng), value(rng), value(rng), value(rng));
+			Vector3 v3(value(rng), value(rng), value(rng));
+
+			Matrix4 affine = a;
+			affine.values[3] = affine.values[7] = affine.values[11] = 0.0f;
+			affine.values[15] = 1.0f;
+
+			Matrix4 ab = a * b;
+			Append(results[MATRIX_MATRIX], ab.values, 16);
+
+			Vector4 av4 = a * v4;
+			Append(results[MATRIX_VECTOR4], &av4.x, 4);
+
+			Vector3 av3 = affine * v3;
+			Append(results[MATRIX_VECTOR3], av3.array, 3);
+
+			Quaternion qa = RandomQuaternion(rng);
+			Quaternion qb = RandomQuaternion(rng);
+			Quaternion qab = qa * qb;
+			Append(results[QUATERNION_QUATERNION], qab.array, 4);
+
+			qa.Normalise();
+			Append(results[QUATERNION_NORMALISE], qa.array, 4);
+
+			batch.Add(v3, qa, Vector3(scale(rng), scale(rng), scale(rng)));
+		}
+		std::vector<Matrix4> composed(batch.Size());
+		batch.Compose(composed.data());
+		for (const Matrix4& m : composed) {
+			Append(results[TRS_COMPOSE], m.values, 16);
+		}
+	}
+
+	bool WriteResults(const Results& results, const std::string& filename) {
+		std::ofstream file(filename, std::ios::binary);
+		for (const std::vector<float>& r : results) {
+			uint32_t count = (uint32_t)r.size();
+			file.write((const char*)&count, sizeof(count));
+			file.write((const char*)r.data(), count * sizeof(float));
+		}
+		return (bool)file;
+	}
+
+	bool ReadResults(Results& results, const std::string& filename) {
+		std::ifstream file(filename, std::ios::binary);
+		for (std::vector<float>& r : results) {
+			uint32_t count = 0;
+			file.read((char*)&count, sizeof(count));
+			r.resize(count);
+			file.read((char*)r.data(), count * sizeof(float));
+		}
+		return (bool)file;
+	}
+
+	//Relative error, except near zero, where it's absolute
+	float Difference(float a, float b) {
+		return std::fabs(a - b) / std::max(std::max(std::fabs(a), std::fabs(b)), 1.0f);
+	}
+
+	bool CompareResults(const Results& results, const Results& reference) {
+		int failures = 0;
+		for (int op = 0; op < OPERATION_COUNT; ++op) {
+			const std::vector<float>& ours		= results[op];
+			const std::vector<float>& theirs	= reference[op];
+			if (ours.size() != theirs.size()) {
+				std::cout << "FAILED: " << OPERATION_NAMES[op] << " has " << ours.size() << " results, but the scalar build has " << theirs.size() << "\n";
+				failures++;
+				continue;
+			}
+			float	worst		= 0.0f;
+			size_t	mismatches	= 0;
+			for (size_t i = 0; i < ours.size(); ++i) {
+				float d = Difference(ours[i], theirs[i]);
+				worst = std::max(worst, d);
+				if (d > TOLERANCE) {
+					mismatches++;
+				}
+			}
+			if (mismatches > 0) {
+				std::cout << "FAILED: " << OPERATION_NAMES[op] << " differs from the scalar build in " << mismatches << " of " << ours.size() << " values, by up to " << worst << "\n";
+				failures++;
+			}
+			else {
+				std::cout << OPERATION_NAMES[op] << ": worst difference " << worst << "\n";
+			}
+		}
+		std::cout << OPERATION_COUNT - failures << " of " << OPERATION_COUNT << " operations match the scalar build\n";
+		return failures == 0;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string writeFile;
+	std::string compareFile;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--write" && i + 1 < argc) {
+			writeFile = argv[++i];
+		}
+		else if (arg == "--compare" && i + 1 < argc) {
+			compareFile = argv[++i];
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << "\n";
+			return 1;
+		}
+	}
+	if (writeFile.empty() == compareFile.empty()) {
+		std::cerr << "Needs one of --write or --compare\n";
+		return 1;
+	}
+#ifdef NCL_USE_SSE
+	std::cout << "Maths paths: SSE\n";
+#else
+	std::cout << "Maths paths: scalar\n";
+#endif
+	Results results;
+	RunOperations(results);
+
+	if (!writeFile.empty()) {
+		if (!WriteResults(results, writeFile)) {
+			std::cerr << "Couldn't write " << writeFile << "\n";
+			return 1;
+		}
+		return 0;
+	}
+	Results reference;
+	if (!ReadResults(reference, compareFile)) {
+		std::cerr << "Couldn't read " << compareFile << " - run MathsCheckScalar --write first\n";
+		return 1;
+	}
+	return CompareResults(results, reference) ? 0 : 1;
+}
@@ -0,0 +1,406 @@
+/*
+Builds synthetic NavigationGrids, runs the same set of random queries over
+them with each search mode, and reports how long the queries took, how many
+nodes they took off the open list, and how many waypoints the paths had. The
+results go out as CSV (the default) or JSON, like the PhysicsBenchmark.
+
+Usage:
+	PathBenchmark [--maps random,rooms] [--sizes 256,1024] [--modes astar,jps,jps+,hpa]
+		[--neighbours 4,8] [--queries 200] [--cluster-size 16] [--format csv|json] [--out file]
+
+random scatters walls over a fifth of the cells. rooms is a grid of 32x32
+rooms, with a doorway or two in each of their walls, so most long paths
+have to wind through a lot of them.
+
+jps+ includes the time to bake the jump table in setup_ms, and hpa the time
+to build the HierarchicalGrid's clusters. For hpa, nodes_expanded counts the
+search of the entrance graph, plus the searches that fill in each leg of the
+route, and length is how much longer than the shortest path it was, on
+average.
+
+Run it in Release, or the timings are meaningless!
+*/
+#include "../CSC8503/CSC8503Common/NavigationGrid.h"
+#include "../CSC8503/CSC8503Common/HierarchicalGrid.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	struct Settings {
+		std::vector<std::string>	maps		= { "random", "rooms" };
+		std::vector<int>			sizes		= { 256, 1024 };
+		std::vector<std::string>	modes		= { "astar", "jps", "jps+", "hpa" };
+		std::vector<int>			neighbours	= { 4, 8 };
+		int			queries		= 200;
+		int			clusterSize = 16;
+		std::string	format	= "csv";
+		std::string	outFile;
+	};
+
+	struct Result {
+		std::string map;
+		std::string mode;
+		int		size;
+		int		neighbours;
+		int		queries;
+		int		found;
+		double	setupTime;	//milliseconds
+		double	queryTime;	//milliseconds per query
+		double	nodesExpanded;	//and these are per query
+		double	waypoints;
+		double	length;			//compared to the shortest path
+	};
+
+	struct Query {
+		Vector3 from;
+		Vector3 to;
+	};
+
+	std::vector<char> BuildRandom(int size, std::mt19937& rng) {
+		std::vector<char> cells(size * size, '.');
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		for (char& c : cells) {
+			if (chance(rng) < 0.2f) {
+				c = 'x';
+			}
+		}
+		return cells;
+	}
+
+	std::vector<char> BuildRooms(int size, std::mt19937& rng) {
+		const int roomSize = 32;
+		std::vector<char> cells(size * size, '.');
+		std::uniform_int_distribution<int> door(1, roomSize - 2);
+
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				if (x % roomSize == 0 || z % roomSize == 0) {
+					cells[(z * size) + x] = 'x';
+				}
+			}
+		}
+		for (int rz = 0; rz < size; rz += roomSize) {
+			for (int rx = 0; rx < size; rx += roomSize) {
+				int doors = 1 + (int)(rng() % 2);
+				for (int d = 0; d < doors; ++d) {
+					int along = door(rng);
+					if (rx + along < size && rz > 0) {
+						cells[(rz * size) + rx + along] = '.';	//top wall
+					}
+					along = door(rng);
+					if (rz + along < size && rx > 0) {
+						cells[((rz + along) * size) + rx] = '.';	//left wall
+					}
+				}
+			}
+		}
+		return cells;
+	}
+
+	std::vector<char> BuildMap(const std::string& name, int size) {
+		std::mt19937 rng(12345);	//same map every run
+		if (name == "rooms") {
+			return BuildRooms(size, rng);
+		}
+		return BuildRandom(size, rng);
+	}
+
+	std::string ToGridFile(const std::vector<char>& cells, int size) {
+		std::ostringstream file;
+		file << 1 << "\n" << size << "\n" << size << "\n";
+		for (int z = 0; z < size; ++z) {
+			file.write(&cells[z * size], size);
+			file << "\n";
+		}
+		return file.str();
+	}
+
+	//Random pairs of floor cells, at their node positions. Text grids start
+	//at (-100, 0, 100), with rows going towards -z
+	std::vector<Query> BuildQueries(const std::vector<char>& cells, int size, int count) {
+		std::mt19937 rng(54321);
+		std::uniform_int_distribution<int> coord(0, size - 1);
+
+		auto randomFloor = [&]() {
+			while (true) {
+				int x = coord(rng);
+				int z = coord(rng);
+				if (cells[(z * size) + x] != 'x') {
+					return Vector3(x - 100.0f, 0.0f, 100.0f - z);
+				}
+			}
+		};
+		std::vector<Query> queries;
+		for (int i = 0; i < count; ++i) {
+			Query q;
+			q.from	= randomFloor();
+			q.to	= randomFloor();
+			queries.emplace_back(q);
+		}
+		return queries;
+	}
+
+	float PathLength(NavigationPath& path, int& waypoints) {
+		float	length = 0.0f;
+		Vector3 previous;
+		Vector3 waypoint;
+		waypoints = 0;
+		while (path.PopWaypoint(waypoint)) {
+			if (waypoints > 0) {
+				length += (waypoint - previous).Length();
+			}
+			previous = waypoint;
+			waypoints++;
+		}
+		return length;
+	}
+
+	Result RunMode(const std::string& gridFile, const std::vector<Query>& queries, const std::vector<float>& shortest,
+		const std::string& map, int size, const std::string& mode, int neighbours, int clusterSize) {
+		Result r;
+		r.map			= map;
+		r.mode			= mode;
+		r.size			= size;
+		r.neighbours	= neighbours;
+		r.queries		= (int)queries.size();
+		r.found			= 0;
+		r.queryTime		= r.nodesExpanded = r.waypoints = r.length = 0.0;
+
+		auto setupStart = std::chrono::high_resolution_clock::now();
+		std::istringstream input(gridFile);
+		NavigationGrid grid(input);
+		grid.SetDiagonalMoves(neighbours == 8);
+		grid.SetSearchType(mode == "astar" ? GridSearchType::AStar : GridSearchType::JumpPoint);
+		if (mode == "jps+") {
+			grid.BakeJumpTable();
+		}
+		std::unique_ptr<HierarchicalGrid> hierarchy;
+		if (mode == "hpa") {
+			hierarchy.reset(new HierarchicalGrid(grid, clusterSize));
+		}
+		r.setupTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - setupStart).count();
+
+		PathSearchContext context;
+		for (size_t i = 0; i < queries.size(); ++i) {
+			const Query& q = queries[i];
+			NavigationPath path;
+			bool found = false;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			if (hierarchy) {
+				HierarchicalRoute route;
+				found = hierarchy->FindRoute(q.from, q.to, route, context);
+				r.nodesExpanded += context.GetNodesExpanded();
+
+				//Stitch the legs back together, to measure the whole path
+				NavigationPath leg;
+				std::vector<Vector3> waypoints;
+				if (found) {
+					Vector3 waypoint;
+					waypoints.push_back(grid.GetNodePosition(route.cells[0]));
+					while (hierarchy->RefineNextLeg(route, leg, context)) {
+						r.nodesExpanded += context.GetNodesExpanded();
+						while (leg.PopWaypoint(waypoint)) {
+							waypoints.push_back(waypoint);
+						}
+					}
+				}
+				for (auto w = waypoints.rbegin(); w != waypoints.rend(); ++w) {
+					path.PushWaypoint(*w);
+				}
+			}
+			else {
+				found = grid.FindPath(q.from, q.to, path, context);
+				r.nodesExpanded += context.GetNodesExpanded();
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			r.queryTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+			if (found) {
+				int waypoints = 0;
+				r.found++;
+				r.length	+= shortest[i] > 0.0f ? PathLength(path, waypoints) / shortest[i] : 1.0f;
+				r.waypoints += waypoints;
+			}
+		}
+		double perQuery = 1.0 / std::max(r.queries, 1);
+		r.queryTime		*= perQuery;
+		r.nodesExpanded *= perQuery;
+		r.waypoints		*= perQuery;
+		r.length		/= std::max(r.found, 1);
+		return r;
+	}
+
+	//The jump point search paths are always the shortest, so they're what
+	//everything else is measured against
+	std::vector<float> ShortestLengths(const std::string& gridFile, const std::vector<Query>& queries, int neighbours) {
+		std::istringstream input(gridFile);
+		NavigationGrid grid(input);
+		grid.SetDiagonalMoves(neighbours == 8);
+		grid.SetSearchType(GridSearchType::JumpPoint);
+
+		std::vector<float> lengths;
+		for (const Query& q : queries) {
+			NavigationPath path;
+			int waypoints = 0;
+			lengths.push_back(grid.FindPath(q.from, q.to, path) ? PathLength(path, waypoints) : 0.0f);
+		}
+		return lengths;
+	}
+
+	void WriteCSV(std::ostream& o, const std::vector<Result>& results) {
+		o << "map,size,mode,neighbours,queries,found,setup_ms,query_ms,nodes_expanded,waypoints,length\n";
+		for (const Result& r : results) {
+			o << r.map << "," << r.size << "," << r.mode << "," << r.neighbours << ","
+				<< r.queries << "," << r.found << "," << r.setupTime << "," << r.queryTime << ","
+				<< r.nodesExpanded << "," << r.waypoints << "," << r.length << "\n";
+		}
+	}
+
+	void WriteJSON(std::ostream& o, const std::vector<Result>& results) {
+		o << "[\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& r = results[i];
+			o << "  {\"map\": \"" << r.map << "\", \"size\": " << r.size
+				<< ", \"mode\": \"" << r.mode << "\", \"neighbours\": " << r.neighbours
+				<< ", \"queries\": " << r.queries << ", \"found\": " << r.found
+				<< ", \"setup_ms\": " << r.setupTime
+				<< ", \"query_ms\": " << r.queryTime
+				<< ", \"nodes_expanded\": " << r.nodesExpanded
+				<< ", \"waypoints\": " << r.waypoints
+				<< ", \"length\": " << r.length << "}"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		o << "]\n";
+	}
+
+	std::vector<std::string> SplitList(const std::string& list) {
+		std::vector<std::string> out;
+		std::stringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			if (!item.empty()) {
+				out.emplace_back(item);
+			}
+		}
+		return out;
+	}
+
+	bool ParseArguments(int argc, char** argv, Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg		= argv[i];
+			bool		hasNext = i + 1 < argc;
+
+			if (arg == "--maps" && hasNext) {
+				settings.maps = SplitList(argv[++i]);
+			}
+			else if (arg == "--sizes" && hasNext) {
+				settings.sizes.clear();
+				for (const std::string& s : SplitList(argv[++i])) {
+					settings.sizes.emplace_back(std::stoi(s));
+				}
+			}
+			else if (arg == "--modes" && hasNext) {
+				settings.modes = SplitList(argv[++i]);
+			}
+			else if (arg == "--neighbours" && hasNext) {
+				settings.neighbours.clear();
+				for (const std::string& s : SplitList(argv[++i])) {
+					settings.neighbours.emplace_back(std::stoi(s));
+				}
+			}
+			else if (arg == "--queries" && hasNext) {
+				settings.queries = std::stoi(argv[++i]);
+			}
+			else if (arg == "--cluster-size" && hasNext) {
+				settings.clusterSize = std::stoi(argv[++i]);
+			}
+			else if (arg == "--format" && hasNext) {
+				settings.format = argv[++i];
+			}
+			else if (arg == "--out" && hasNext) {
+				settings.outFile = argv[++i];
+			}
+			else {
+				std::cerr << "Unknown argument " << arg << "\n";
+				return false;
+			}
+		}
+		for (const std::string& m : settings.maps) {
+			if (m != "random" && m != "rooms") {
+				std::cerr << "Unknown map " << m << " (expected random or rooms)\n";
+				return false;
+			}
+		}
+		for (const std::string& m : settings.modes) {
+			if (m != "astar" && m != "jps" && m != "jps+" && m != "hpa") {
+				std::cerr << "Unknown mode " << m << " (expected astar, jps, jps+ or hpa)\n";
+				return false;
+			}
+		}
+		for (int n : settings.neighbours) {
+			if (n != 4 && n != 8) {
+				std::cerr << "Unknown neighbourhood " << n << " (expected 4 or 8)\n";
+				return false;
+			}
+		}
+		if (settings.format != "csv" && settings.format != "json") {
+			std::cerr << "Unknown format " << settings.format << " (expected csv or json)\n";
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	Settings settings;
+	if (!ParseArguments(argc, argv, settings)) {
+		return 1;
+	}
+
+	std::vector<Result> results;
+	for (const std::string& map : settings.maps) {
+		for (int size : settings.sizes) {
+			std::vector<char>	cells	= BuildMap(map, size);
+			std::string			file	= ToGridFile(cells, size);
+			std::vector<Query>	queries = BuildQueries(cells, size, settings.queries);
+
+			for (int neighbours : settings.neighbours) {
+				std::vector<float> shortest = ShortestLengths(file, queries, neighbours);
+
+				for (const std::string& mode : settings.modes) {
+					std::cerr << "Running " << map << " / " << size << " / " << mode << " / " << neighbours << "...\n";
+					results.emplace_back(RunMode(file, queries, shortest, map, size, mode, neighbours, settings.clusterSize));
+				}
+			}
+		}
+	}
+
+	std::ofstream	file;
+	std::ostream*	out = &std::cout;
+	if (!settings.outFile.empty()) {
+		file.open(settings.outFile);
+		if (!file) {
+			std::cerr << "Couldn't open " << settings.outFile << " for writing\n";
+			return 1;
+		}
+		out = &file;
+	}
+	if (settings.format == "json") {
+		WriteJSON(*out, results);
+	}
+	else {
+		WriteCSV(*out, results);
+	}
+	return 0;
+}
@@ -0,0 +1,970 @@
+/*
+Checks the pathfinding against itself - every search mode, and everything
+built on top of the grids, against plain searches that are simple enough to
+be obviously right - over randomised maps, that the funnel keeps paths
+over baked navigation meshes on the mesh, that mesh files can be read back
+and damaged ones are turned away, and that the NavigationBaker
+bakes some simple scenes the way it should. Prints a line for each failure,
+and a summary, and returns non-zero if anything failed, so it can be run as
+a test.
+
+Usage:
+	PathCheck [--seed 1]
+
+The checks are deterministic for any one seed, so a failure can always be
+reproduced with the seed it printed.
+*/
+#include "../CSC8503/CSC8503Common/NavigationGrid.h"
+#include "../CSC8503/CSC8503Common/NavigationMesh.h"
+#include "../CSC8503/CSC8503Common/HierarchicalGrid.h"
+#include "../CSC8503/CSC8503Common/FlowField.h"
+#include "../CSC8503/CSC8503Common/DStarLite.h"
+#include "../CSC8503/CSC8503Common/NavigationBaker.h"
+#include "../CSC8503/CSC8503Common/PathRequestQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	int checks		= 0;
+	int failures	= 0;
+
+	bool Check(bool passed, const std::string& what) {
+		checks++;
+		if (!passed) {
+			failures++;
+			std::cout << "FAILED: " << what << "\n";
+		}
+		return passed;
+	}
+
+	std::vector<char> RandomCells(int width, int height, float wallChance, std::mt19937& rng) {
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+		std::vector<char> cells(width * height, '.');
+		for (char& c : cells) {
+			if (chance(rng) < wallChance) {
+				c = 'x';
+			}
+		}
+		return cells;
+	}
+
+	std::string TextGridFile(const std::vector<char>& cells, int width, int height, int nodeSize) {
+		std::ostringstream file;
+		file << nodeSize << "\n" << width << "\n" << height << "\n";
+		for (int z = 0; z < height; ++z) {
+			file.write(&cells[z * width], width);
+			file << "\n";
+		}
+		return file.str();
+	}
+
+	template <typename T>
+	void WriteValue(std::ostream& o, T value) {
+		o.write((const char*)&value, sizeof(T));
+	}
+
+	//A NAVG file, for grids that don't start where the text ones do
+	std::string BinaryGridFile(const std::vector<char>& cells, int width, int height, int nodeSize, const Vector3& origin) {
+		std::ostringstream file;
+		file.write("NAVG", 4);
+		WriteValue(file, (uint32_t)1);
+		WriteValue(file, (uint32_t)0);
+		WriteValue(file, (uint32_t)width);
+		WriteValue(file, (uint32_t)height);
+		WriteValue(file, (uint32_t)nodeSize);
+		WriteValue(file, origin.x);
+		WriteValue(file, origin.y);
+		WriteValue(file, origin.z);
+
+		std::vector<unsigned char> walkBits((cells.size() + 7) / 8, 0);
+		for (size_t i = 0; i < cells.size(); ++i) {
+			if (cells[i] != 'x') {
+				walkBits[i >> 3] |= (unsigned char)(1 << (i & 7));
+			}
+		}
+		file.write((const char*)walkBits.data(), walkBits.size());
+		return file.str();
+	}
+
+	/*
+	Every node position has to come back as its own cell, as does anywhere
+	less than half a node from it, and anywhere past the edges of the grid
+	has to be off it.
+	*/
+	void CheckRoundTrip(const NavigationGrid& grid, const std::string& name, std::mt19937& rng) {
+		int		width	= grid.GetWidth();
+		int		height	= grid.GetHeight();
+		float	half	= grid.GetNodeSize() * 0.499f;
+		std::uniform_real_distribution<float> offset(-half, half);
+
+		int wrong = 0;
+		for (int cell = 0; cell < width * height; ++cell) {
+			Vector3 position = grid.GetNodePosition(cell);
+			if (grid.GetNodeAt(position) != cell) {
+				wrong++;
+			}
+			if (grid.GetNodeAt(position + Vector3(offset(rng), 0.0f, offset(rng))) != cell) {
+				wrong++;
+			}
+		}
+		Check(wrong == 0, name + ": " + std::to_string(wrong) + " positions didn't come back as their own cell");
+
+		float	size	= (float)grid.GetNodeSize();
+		Vector3 first	= grid.GetNodePosition(0);
+		Vector3 last	= grid.GetNodePosition((width * height) - 1);
+		Check(grid.GetNodeAt(first + Vector3(-size, 0.0f, 0.0f)) == -1
+			&& grid.GetNodeAt(first + Vector3(0.0f, 0.0f, size)) == -1
+			&& grid.GetNodeAt(last + Vector3(size, 0.0f, 0.0f)) == -1
+			&& grid.GetNodeAt(last + Vector3(0.0f, 0.0f, -size)) == -1,
+			name + ": positions past the edges weren't off the grid");
+	}
+
+	void CheckPositions(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(20, 20, 0.2f, rng);
+		std::istringstream textFile(TextGridFile(cells, 20, 20, 1));
+		NavigationGrid textGrid(textFile);
+		CheckRoundTrip(textGrid, "text grid", rng);
+
+		cells = RandomCells(37, 23, 0.2f, rng);
+		std::istringstream binaryFile(BinaryGridFile(cells, 37, 23, 4, Vector3(-312.5f, 2.0f, 57.0f)));
+		NavigationGrid binaryGrid(binaryFile);
+		CheckRoundTrip(binaryGrid, "binary grid", rng);
+
+		//Paths between node positions start and end at those nodes
+		std::uniform_int_distribution<int> anyCell(0, (37 * 23) - 1);
+		int wrong = 0;
+		for (int i = 0; i < 50; ++i) {
+			int from	= anyCell(rng);
+			int to		= anyCell(rng);
+			NavigationPath path;
+			if (!binaryGrid.FindPath(binaryGrid.GetNodePosition(from), binaryGrid.GetNodePosition(to), path)) {
+				continue;
+			}
+			Vector3 first;
+			Vector3 last;
+			path.PopWaypoint(first);
+			last = first;
+			while (path.PopWaypoint(last)) {
+			}
+			if (binaryGrid.GetNodeAt(first) != from || binaryGrid.GetNodeAt(last) != to) {
+				wrong++;
+			}
+		}
+		Check(wrong == 0, "binary grid: " + std::to_string(wrong) + " paths didn't start and end at the right nodes");
+	}
+
+	/*
+	The plain search everything else is checked against - Dijkstra, out from
+	one cell to every other, over the same moves the grid hands out. Cells
+	it can't get to are left at UNREACHABLE.
+	*/
+	const float UNREACHABLE = 1e30f;
+
+	std::vector<float> DijkstraCosts(const NavigationGrid& grid, int source) {
+		typedef std::pair<float, int> Entry;
+		std::vector<float> costs(grid.GetWidth() * grid.GetHeight(), UNREACHABLE);
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+		costs[source] = 0.0f;
+		open.push(Entry(0.0f, source));
+
+		int		neighbours[8];
+		float	moveCosts[8];
+		while (!open.empty()) {
+			Entry e = open.top();
+			open.pop();
+			if (e.first > costs[e.second]) {
+				continue;
+			}
+			int count = grid.GetNeighbours(e.second, neighbours, moveCosts);
+			for (int i = 0; i < count; ++i) {
+				float cost = e.first + moveCosts[i];
+				if (cost < costs[neighbours[i]]) {
+					costs[neighbours[i]] = cost;
+					open.push(Entry(cost, neighbours[i]));
+				}
+			}
+		}
+		return costs;
+	}
+
+	bool SameCost(float a, float b) {
+		return std::fabs(a - b) <= 1e-3f * std::max(1.0f, std::fabs(b));
+	}
+
+	/*
+	Follows a path over a grid, adding up what it costs. Waypoints don't
+	have to be next to each other - Jump Point Search only gives the corners
+	- but the way between two of them has to be a straight line, along an
+	axis or a diagonal, and every step along it has to be a move the grid
+	allows. Returns false if it isn't, or if it doesn't start at from and
+	end at to.
+	*/
+	bool FollowPath(const NavigationGrid& grid, NavigationPath& path, int from, int to, float& outCost) {
+		int		width = grid.GetWidth();
+		int		neighbours[8];
+		float	moveCosts[8];
+		Vector3 waypoint;
+		int		previous = -1;
+		outCost = 0.0f;
+		while (path.PopWaypoint(waypoint)) {
+			int cell = grid.GetNodeAt(waypoint);
+			if (cell < 0) {
+				return false;
+			}
+			if (previous < 0) {
+				if (cell != from) {
+					return false;
+				}
+				previous = cell;
+				continue;
+			}
+			int dx = (cell % width) - (previous % width);
+			int dz = (cell / width) - (previous / width);
+			if (dx != 0 && dz != 0 && std::abs(dx) != std::abs(dz)) {
+				return false;
+			}
+			int stepX = (dx > 0) - (dx < 0);
+			int stepZ = (dz > 0) - (dz < 0);
+			while (previous != cell) {
+				int next	= previous + stepX + (stepZ * width);
+				int count	= grid.GetNeighbours(previous, neighbours, moveCosts);
+				int move	= (int)(std::find(neighbours, neighbours + count, next) - neighbours);
+				if (move == count) {
+					return false;
+				}
+				outCost += moveCosts[move];
+				previous = next;
+			}
+		}
+		return previous == to || (previous == -1 && from == to);
+	}
+
+	int RandomWalkableCell(const NavigationGrid& grid, std::mt19937& rng) {
+		std::uniform_int_distribution<int> anyCell(0, (grid.GetWidth() * grid.GetHeight()) - 1);
+		int cell = anyCell(rng);
+		while (!grid.IsWalkable(cell % grid.GetWidth(), cell / grid.GetWidth())) {
+			cell = anyCell(rng);
+		}
+		return cell;
+	}
+
+	/*
+	A* and Jump Point Search, with and without diagonals, and with and
+	without the jump table, all have to find a path exactly when Dijkstra
+	can, and it has to cost exactly what Dijkstra says the cheapest way
+	costs. A* also gets grids with cell costs.
+	*/
+	void CheckGridSearches(std::mt19937& rng) {
+		struct Mode {
+			GridSearchType	type;
+			bool			diagonals;
+			bool			jumpTable;
+			bool			cellCosts;
+			const char*		name;
+		};
+		const Mode modes[] = {
+			{ GridSearchType::AStar,		false,	false,	false,	"A*" },
+			{ GridSearchType::AStar,		true,	false,	false,	"A* with diagonals" },
+			{ GridSearchType::AStar,		true,	false,	true,	"A* with diagonals and cell costs" },
+			{ GridSearchType::JumpPoint,	false,	false,	false,	"JPS" },
+			{ GridSearchType::JumpPoint,	true,	false,	false,	"JPS with diagonals" },
+			{ GridSearchType::JumpPoint,	false,	true,	false,	"JPS with a jump table" },
+			{ GridSearchType::JumpPoint,	true,	true,	false,	"JPS with diagonals and a jump table" },
+		};
+		std::uniform_int_distribution<int> anyCost(1, 5);
+		for (const Mode& mode : modes) {
+			std::vector<char> cells = RandomCells(64, 48, 0.3f, rng);
+			std::istringstream file(BinaryGridFile(cells, 64, 48, 2, Vector3(-20.0f, 0.0f, 9.0f)));
+			NavigationGrid grid(file);
+			grid.SetSearchType(mode.type);
+			grid.SetDiagonalMoves(mode.diagonals);
+			if (mode.jumpTable) {
+				grid.BakeJumpTable();
+			}
+			if (mode.cellCosts) {
+				for (int z = 0; z < 48; ++z) {
+					for (int x = 0; x < 64; ++x) {
+						grid.SetCellCost(x, z, anyCost(rng));
+					}
+				}
+			}
+			int missed	= 0;
+			int broken	= 0;
+			int costly	= 0;
+			int found	= 0;
+			for (int i = 0; i < 40; ++i) {
+				int from	= RandomWalkableCell(grid, rng);
+				int to		= RandomWalkableCell(grid, rng);
+				float best	= DijkstraCosts(grid, from)[to];
+
+				NavigationPath path;
+				bool	pathFound	= grid.FindPath(grid.GetNodePosition(from), grid.GetNodePosition(to), path);
+				float	cost		= 0.0f;
+				if (pathFound != (best < UNREACHABLE)) {
+					missed++;
+				}
+				else if (pathFound) {
+					found++;
+					if (!FollowPath(grid, path, from, to, cost)) {
+						broken++;
+					}
+					else if (!SameCost(cost, best)) {
+						costly++;
+					}
+				}
+			}
+			std::string name = mode.name;
+			Check(found > 0, name + ": no paths were found");
+			Check(missed == 0, name + ": " + std::to_string(missed) + " searches disagreed with Dijkstra about whether there was a path");
+			Check(broken == 0, name + ": " + std::to_string(broken) + " paths took moves the grid doesn't allow");
+			Check(costly == 0, name + ": " + std::to_string(costly) + " paths cost more than the cheapest way");
+		}
+	}
+
+	/*
+	HPA* doesn't promise the cheapest path, but it has to find one whenever
+	there is one, made of moves the grid allows - including after cells have
+	changed and it's been updated - and it can never be cheaper than the
+	cheapest.
+	*/
+	void CheckHierarchical(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(80, 64, 0.25f, rng);
+		std::istringstream file(BinaryGridFile(cells, 80, 64, 1, Vector3(0.0f, 0.0f, 0.0f)));
+		NavigationGrid grid(file);
+		grid.SetDiagonalMoves(true);
+		HierarchicalGrid hierarchy(grid, 16);
+
+		std::uniform_int_distribution<int> anyCell(0, (80 * 64) - 1);
+		int missed	= 0;
+		int broken	= 0;
+		int cheap	= 0;
+		int found	= 0;
+		for (int round = 0; round < 4; ++round) {
+			for (int i = 0; i < 30; ++i) {
+				int from	= RandomWalkableCell(grid, rng);
+				int to		= RandomWalkableCell(grid, rng);
+				float best	= DijkstraCosts(grid, from)[to];
+
+				NavigationPath path;
+				bool	pathFound	= hierarchy.FindPath(grid.GetNodePosition(from), grid.GetNodePosition(to), path);
+				float	cost		= 0.0f;
+				if (pathFound != (best < UNREACHABLE)) {
+					missed++;
+				}
+				else if (pathFound) {
+					found++;
+					if (!FollowPath(grid, path, from, to, cost)) {
+						broken++;
+					}
+					else if (cost < best - 1e-3f) {
+						cheap++;
+					}
+				}
+			}
+			for (int i = 0; i < 40; ++i) {
+				int cell = anyCell(rng);
+				grid.SetWalkable(cell % 80, cell / 80, !grid.IsWalkable(cell % 80, cell / 80));
+			}
+			hierarchy.Update();
+		}
+		Check(found > 0, "HPA*: no paths were found");
+		Check(missed == 0, "HPA*: " + std::to_string(missed) + " searches disagreed with Dijkstra about whether there was a path");
+		Check(broken == 0, "HPA*: " + std::to_string(broken) + " paths took moves the grid doesn't allow");
+		Check(cheap == 0, "HPA*: " + std::to_string(cheap) + " paths were cheaper than the cheapest way, so can't be real");
+	}
+
+	/*
+	Every cell of a flow field has to cost what Dijkstra says it does to get
+	from there to the goal, and its next cell has to be a move that costs
+	exactly the difference.
+	*/
+	void CheckFlowFieldCosts(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(50, 50, 0.25f, rng);
+		std::istringstream file(BinaryGridFile(cells, 50, 50, 2, Vector3(5.0f, 0.0f, 5.0f)));
+		NavigationGrid grid(file);
+		std::uniform_int_distribution<int> anyCost(1, 4);
+
+		for (int pass = 0; pass < 3; ++pass) {
+			grid.SetDiagonalMoves(pass > 0);
+			if (pass == 2) {
+				for (int z = 0; z < 50; ++z) {
+					for (int x = 0; x < 50; ++x) {
+						grid.SetCellCost(x, z, anyCost(rng));
+					}
+				}
+			}
+			std::string name = pass == 0 ? "flow field" : pass == 1 ? "flow field with diagonals" : "flow field with cell costs";
+
+			int			goal	= RandomWalkableCell(grid, rng);
+			FlowField	field(grid, goal);
+			std::vector<float> best = DijkstraCosts(grid, goal);
+
+			int		wrongCost	= 0;
+			int		wrongNext	= 0;
+			int		neighbours[8];
+			float	moveCosts[8];
+			for (int cell = 0; cell < 50 * 50; ++cell) {
+				bool reachable = best[cell] < UNREACHABLE;
+				if (field.IsReachable(cell) != reachable || (reachable && !SameCost(field.GetCost(cell), best[cell]))) {
+					wrongCost++;
+					continue;
+				}
+				if (!reachable || cell == goal) {
+					continue;
+				}
+				int next	= field.GetNextCell(cell);
+				int count	= grid.GetNeighbours(cell, neighbours, moveCosts);
+				int move	= (int)(std::find(neighbours, neighbours + count, next) - neighbours);
+				if (move == count || !SameCost(moveCosts[move] + best[next], best[cell])) {
+					wrongNext++;
+				}
+			}
+			Check(wrongCost == 0, name + ": " + std::to_string(wrongCost) + " cells didn't cost what Dijkstra says they do");
+			Check(wrongNext == 0, name + ": " + std::to_string(wrongNext) + " cells didn't point along a cheapest way");
+		}
+	}
+
+	/*
+	Agents start anywhere in a random cell, and take small steps along the
+	field's Sample until they get to the goal's cell. They have to get there
+	without ever standing in a wall, in about as many steps as the cost of
+	the way there says they should.
+	*/
+	void CheckFlowFieldWalk(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(48, 40, 0.25f, rng);
+		std::istringstream file(BinaryGridFile(cells, 48, 40, 2, Vector3(30.0f, 0.0f, -12.0f)));
+		NavigationGrid grid(file);
+		grid.SetDiagonalMoves(true);
+
+		std::uniform_int_distribution<int>		anyCell(0, (48 * 40) - 1);
+		std::uniform_real_distribution<float>	offset(-0.99f, 0.99f);
+		const float stepSize = 0.25f;	//an eighth of a node
+
+		int goal = anyCell(rng);
+		while (cells[goal] == 'x') {
+			goal = anyCell(rng);
+		}
+		FlowField field(grid, goal);
+
+		int walked	= 0;
+		int stuck	= 0;
+		int walls	= 0;
+		for (int agent = 0; agent < 100; ++agent) {
+			int cell = anyCell(rng);
+			if (!field.IsReachable(cell)) {
+				continue;
+			}
+			Vector3 position	= grid.GetNodePosition(cell) + Vector3(offset(rng), 0.0f, offset(rng));
+			int		maxSteps	= 16 + (int)(field.GetCost(cell) * grid.GetNodeSize() * 2 / stepSize);
+			int		steps		= 0;
+			while (grid.GetNodeAt(position) != goal && steps < maxSteps) {
+				position = position + (field.Sample(position) * stepSize);
+				int now = grid.GetNodeAt(position);
+				if (now < 0 || cells[now] == 'x') {
+					walls++;
+					break;
+				}
+				steps++;
+			}
+			walked++;
+			if (grid.GetNodeAt(position) != goal) {
+				stuck++;
+			}
+		}
+		Check(walked > 0, "flow field: no agents could reach the goal");
+		Check(walls == 0, "flow field: " + std::to_string(walls) + " agents walked into a wall");
+		Check(stuck == 0, "flow field: " + std::to_string(stuck) + " of " + std::to_string(walked) + " agents never got to the goal");
+	}
+
+	/*
+	D* Lite's path has to cost the same as a fresh A* search's, both when
+	it's first planned, and after every replan as cells change around it.
+	*/
+	void CheckDStarLiteCosts(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(48, 48, 0.2f, rng);
+		std::istringstream file(BinaryGridFile(cells, 48, 48, 2, Vector3(0.0f, 0.0f, -40.0f)));
+		NavigationGrid grid(file);
+		grid.SetDiagonalMoves(true);
+
+		std::uniform_int_distribution<int> anyCell(0, (48 * 48) - 1);
+		int compared	= 0;
+		int missed		= 0;
+		int costly		= 0;
+		for (int plan = 0; plan < 8; ++plan) {
+			int from	= RandomWalkableCell(grid, rng);
+			int to		= RandomWalkableCell(grid, rng);
+			DStarLite planner(grid);
+			bool found = planner.Plan(from, to);
+			for (int replan = 0; replan < 10; ++replan) {
+				NavigationPath	path;
+				float			cost		= 0.0f;
+				bool			aStarFound	= grid.FindPath(grid.GetNodePosition(from), grid.GetNodePosition(to), path)
+					&& FollowPath(grid, path, from, to, cost);
+				compared++;
+				if (found != aStarFound) {
+					missed++;
+				}
+				else if (found && !SameCost(planner.GetPathCost(), cost)) {
+					costly++;
+				}
+				for (int change = 0; change < 6; ++change) {
+					int cell = anyCell(rng);
+					if (cell != from && cell != to) {
+						grid.SetWalkable(cell % 48, cell / 48, !grid.IsWalkable(cell % 48, cell / 48));
+					}
+				}
+				found = planner.Replan(grid.GetNodePosition(from));
+			}
+		}
+		Check(missed == 0, "D* Lite: " + std::to_string(missed) + " of " + std::to_string(compared) + " plans disagreed with A* about whether there was a path");
+		Check(costly == 0, "D* Lite: " + std::to_string(costly) + " of " + std::to_string(compared) + " plans didn't cost the same as A*'s");
+	}
+
+	/*
+	An agent follows D* Lite's path waypoint by waypoint, replanning from
+	each one, while cells are walled up and knocked down around it. Every
+	path it's given has to lead on from wherever it's got to.
+	*/
+	void CheckDStarLiteWalk(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(40, 40, 0.2f, rng);
+		std::istringstream file(BinaryGridFile(cells, 40, 40, 3, Vector3(-7.0f, 0.0f, 55.0f)));
+		NavigationGrid grid(file);
+		grid.SetDiagonalMoves(true);
+
+		std::uniform_int_distribution<int> anyCell(0, (40 * 40) - 1);
+		int arrived = 0;
+		int lost	= 0;
+		for (int walk = 0; walk < 10; ++walk) {
+			int from	= anyCell(rng);
+			int to		= anyCell(rng);
+			DStarLite planner(grid);
+			if (!planner.Plan(grid.GetNodePosition(from), grid.GetNodePosition(to))) {
+				continue;
+			}
+			Vector3 position = grid.GetNodePosition(from);
+			for (int step = 0; step < 40 * 40 && grid.GetNodeAt(position) != to; ++step) {
+				for (int change = 0; change < 3; ++change) {
+					int cell = anyCell(rng);
+					if (cell != to && cell != grid.GetNodeAt(position)) {
+						grid.SetWalkable(cell % 40, cell / 40, !grid.IsWalkable(cell % 40, cell / 40));
+					}
+				}
+				if (!planner.Replan(position)) {
+					break;	//walled in
+				}
+				NavigationPath path;
+				planner.GetPath(path);
+				Vector3 next;
+				path.PopWaypoint(next);	//where it is now
+				if (!path.PopWaypoint(next) || grid.GetNodeAt(next) != planner.GetNextCell(grid.GetNodeAt(position))) {
+					lost++;
+					break;
+				}
+				position = next;
+			}
+			if (grid.GetNodeAt(position) == to) {
+				arrived++;
+			}
+		}
+		Check(lost == 0, "D* Lite: " + std::to_string(lost) + " paths didn't lead on from where the agent was");
+		Check(arrived > 0, "D* Lite: no agents got to their goal");
+	}
+
+	/*
+	Doors open and shut while agents keep asking the PathRequestQueue for
+	paths. The queue is flushed before every change, so each path it hands
+	back has to be a real path over the grid as it was when it was searched,
+	which is still how it is when it's handed back. Only the start can be in
+	a wall - the agent's already there.
+	*/
+	void CheckQueueChanges(std::mt19937& rng) {
+		std::vector<char> cells = RandomCells(64, 64, 0.2f, rng);
+		std::istringstream file(BinaryGridFile(cells, 64, 64, 1, Vector3(0.0f, 0.0f, 0.0f)));
+		NavigationGrid grid(file);
+		JobSystem jobs(3);
+		PathRequestQueue queue(grid, jobs);
+
+		std::uniform_int_distribution<int> anyCell(0, (64 * 64) - 1);
+		int delivered	= 0;
+		int broken		= 0;
+		auto checkPath = [&](PathRequestQueue::RequestID, PathRequestStatus status, NavigationPath& path) {
+			if (status != PathRequestStatus::Found) {
+				return;
+			}
+			delivered++;
+			Vector3 waypoint;
+			int		previous = -1;
+			while (path.PopWaypoint(waypoint)) {
+				int cell = grid.GetNodeAt(waypoint);
+				bool next = previous < 0 || std::abs((cell % 64) - (previous % 64)) + std::abs((cell / 64) - (previous / 64)) == 1;
+				if (cell < 0 || (previous >= 0 && !grid.IsWalkable(cell % 64, cell / 64)) || !next) {
+					broken++;
+					return;
+				}
+				previous = cell;
+			}
+		};
+		for (int frame = 0; frame < 60; ++frame) {
+			for (int i = 0; i < 20; ++i) {
+				queue.Request(grid.GetNodePosition(anyCell(rng)), grid.GetNodePosition(anyCell(rng)), 0, 0.0f, checkPath);
+			}
+			queue.Update(0.5f);
+			queue.Flush();
+			for (int i = 0; i < 10; ++i) {
+				int cell = anyCell(rng);
+				grid.SetWalkable(cell % 64, cell / 64, !grid.IsWalkable(cell % 64, cell / 64));
+			}
+		}
+		while (queue.GetPendingCount() > 0) {
+			queue.Update(5.0f);
+			queue.Flush();
+		}
+		queue.Update(0.0f);	//for the last callbacks
+		Check(delivered > 0, "queue: no paths were found");
+		Check(broken == 0, "queue: " + std::to_string(broken) + " of " + std::to_string(delivered) + " paths went through walls");
+	}
+
+	int CountWalkable(const NavigationBaker& baker) {
+		int count = 0;
+		for (int z = 0; z < baker.GetDepth(); ++z) {
+			for (int x = 0; x < baker.GetWidth(); ++x) {
+				count += baker.IsWalkable(x, z) ? 1 : 0;
+			}
+		}
+		return count;
+	}
+
+	/*
+	A mesh baked from a floor with walls on it. The funnel's paths have to
+	start and end where they were asked to, never leave the mesh - checked
+	at points all the way along them - and be no shorter than a straight
+	line, which they can only be by cutting through something.
+	*/
+	void CheckMeshFunnel(std::mt19937& rng) {
+		NavigationBaker baker;
+		baker.AddBox(Vector3(0, -1, 0), Vector3(60, 1, 60));
+		std::uniform_real_distribution<float> place(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> side(1.0f, 12.0f);
+		for (int i = 0; i < 12; ++i) {
+			baker.AddBox(Vector3(place(rng), 3, place(rng)), Vector3(side(rng), 3, side(rng)));
+		}
+		if (!Check(baker.Bake(), "funnel: nothing was walkable in the baked scene")) {
+			return;
+		}
+		std::vector<Vector3>			vertices;
+		std::vector<std::vector<int>>	polygons;
+		baker.BuildMesh(vertices, polygons);
+		NavigationMesh mesh(vertices, polygons);
+
+		auto offMesh = [&](const Vector3& p) {
+			Vector3 onMesh;
+			if (mesh.GetPolygonAt(p, &onMesh) < 0) {
+				return true;
+			}
+			Vector3 gap = onMesh - p;
+			gap.y = 0.0f;
+			return gap.Length() > 0.01f;
+		};
+		std::uniform_real_distribution<float> anywhere(-58.0f, 58.0f);
+		int found	= 0;
+		int ends	= 0;
+		int off		= 0;
+		int tooShort	= 0;
+		for (int i = 0; i < 200; ++i) {
+			Vector3 from(anywhere(rng), 0.0f, anywhere(rng));
+			Vector3 to(anywhere(rng), 0.0f, anywhere(rng));
+			if (offMesh(from) || offMesh(to)) {
+				continue;
+			}
+			NavigationPath path;
+			if (!mesh.FindPath(from, to, path)) {
+				continue;
+			}
+			found++;
+			Vector3 previous;
+			Vector3 waypoint;
+			path.PopWaypoint(previous);
+			Vector3	first	= previous;
+			float	length	= 0.0f;
+			bool	left	= false;
+			while (path.PopWaypoint(waypoint)) {
+				Vector3 leg = waypoint - previous;
+				leg.y = 0.0f;
+				int samples = 1 + (int)leg.Length();
+				for (int s = 0; s <= samples && !left; ++s) {
+					left = offMesh(previous + (leg * ((float)s / samples)));
+				}
+				length		+= leg.Length();
+				previous	= waypoint;
+			}
+			Vector3 straight = to - from;
+			straight.y = 0.0f;
+			Vector3 startGap	= first - from;
+			Vector3 endGap		= previous - to;
+			startGap.y	= 0.0f;
+			endGap.y	= 0.0f;
+			if (startGap.Length() > 0.01f || endGap.Length() > 0.01f) {
+				ends++;
+			}
+			if (left) {
+				off++;
+			}
+			if (length < straight.Length() - 0.01f) {
+				tooShort++;
+			}
+		}
+		Check(found > 0, "funnel: no paths were found");
+		Check(ends == 0, "funnel: " + std::to_string(ends) + " of " + std::to_string(found) + " paths didn't start and end where they were asked to");
+		Check(off == 0, "funnel: " + std::to_string(off) + " of " + std::to_string(found) + " paths left the mesh");
+		Check(tooShort == 0, "funnel: " + std::to_string(tooShort) + " of " + std::to_string(found) + " paths were shorter than a straight line");
+	}
+
+	/*
+	A baked mesh has to come back the same from its own file, and cutting
+	that file short anywhere, or claiming more vertices than it holds, has
+	to leave an empty mesh rather than crashing or allocating gigabytes.
+	Polygons with too many sides for the file have to be refused by
+	WriteMesh - and BuildMesh mustn't make any, however big maxSide is.
+	*/
+	void CheckMeshFile(std::mt19937& rng) {
+		NavigationBaker baker;
+		//A row of posts across the floor, so that the long rectangles either
+		//side of it get a vertex on their edge from every gap between them
+		baker.AddBox(Vector3(0, -1, 0), Vector3(200, 1, 200));
+		for (float x = -190.0f; x <= 190.0f; x += 3.0f) {
+			baker.AddBox(Vector3(x, 3, 0), Vector3(0.5f, 3, 0.5f));
+		}
+		if (!Check(baker.Bake(Vector3(0, 1, 100)), "mesh file: nothing was walkable in the baked scene")) {
+			return;
+		}
+		std::vector<Vector3>			vertices;
+		std::vector<std::vector<int>>	polygons;
+		baker.BuildMesh(vertices, polygons, 1000);
+
+		int tooManySides = 0;
+		for (const std::vector<int>& p : polygons) {
+			tooManySides += (int)p.size() > NavigationMesh::MAX_SIDES ? 1 : 0;
+		}
+		Check(tooManySides == 0, "mesh file: BuildMesh made " + std::to_string(tooManySides) + " polygons with more than " + std::to_string(NavigationMesh::MAX_SIDES) + " sides");
+
+		NavigationMesh		mesh(vertices, polygons);
+		std::ostringstream	written;
+		if (!Check(mesh.WriteMesh(written), "mesh file: a baked mesh couldn't be written")) {
+			return;
+		}
+		const std::string file = written.str();
+		std::istringstream	input(file);
+		NavigationMesh		loaded(input);
+		Check(loaded.GetPolygonCount() == mesh.GetPolygonCount() && loaded.GetVertexCount() == mesh.GetVertexCount(),
+			"mesh file: a mesh read back from its file had " + std::to_string(loaded.GetPolygonCount()) + " polygons, not " + std::to_string(mesh.GetPolygonCount()));
+
+		std::uniform_int_distribution<size_t> cut(0, file.size() - 1);
+		int truncatedLoaded = 0;
+		for (int i = 0; i < 4; ++i) {
+			std::istringstream truncated(file.substr(0, cut(rng)));
+			truncatedLoaded += NavigationMesh(truncated).IsLoaded() ? 1 : 0;
+		}
+		Check(truncatedLoaded == 0, "mesh file: " + std::to_string(truncatedLoaded) + " of 4 files cut short were loaded anyway");
+
+		std::string	bigCount	= file;
+		uint32_t	claimed		= 0xFFFFFFF0;
+		std::memcpy(&bigCount[8], &claimed, sizeof(claimed));	//after the magic and version
+		std::istringstream bigInput(bigCount);
+		Check(!NavigationMesh(bigInput).IsLoaded(), "mesh file: a file claiming billions of vertices was loaded");
+
+		std::vector<Vector3>	circle;
+		std::vector<int>		sides;
+		for (int i = 0; i < NavigationMesh::MAX_SIDES + 1; ++i) {
+			float angle = (6.2831853f * i) / (NavigationMesh::MAX_SIDES + 1);
+			circle.push_back(Vector3(std::cos(angle) * 50.0f, 0.0f, std::sin(angle) * 50.0f));
+			sides.push_back(i);
+		}
+		NavigationMesh		tooBig(circle, { sides });
+		std::ostringstream	tooBigFile;
+		Check(!tooBig.WriteMesh(tooBigFile) && tooBigFile.str().empty(), "mesh file: a polygon with more sides than the file can hold was written");
+	}
+
+	/*
+	A wall across a floor has to block it off the same whether it's stood on
+	the floor or sunk into it - the part of it below the top of the floor
+	mustn't stop the rest of it being solid.
+	*/
+	void CheckBaker() {
+		NavigationBaker floorOnly;
+		floorOnly.AddBox(Vector3(0, -1, 0), Vector3(50, 1, 50));
+		floorOnly.Bake();
+
+		NavigationBaker resting;
+		resting.AddBox(Vector3(0, -1, 0), Vector3(50, 1, 50));
+		resting.AddBox(Vector3(0, 3, -10), Vector3(40, 3, 1));
+		resting.Bake();
+
+		NavigationBaker sunk;
+		sunk.AddBox(Vector3(0, -1, 0), Vector3(50, 1, 50));
+		sunk.AddBox(Vector3(0, 2, -10), Vector3(40, 3, 1));
+		sunk.Bake();
+
+		int floorCount		= CountWalkable(floorOnly);
+		int restingCount	= CountWalkable(resting);
+		int sunkCount		= CountWalkable(sunk);
+		Check(restingCount < floorCount, "baker: a wall on the floor didn't block anything");
+		Check(sunkCount == restingCount, "baker: a wall sunk into the floor left " + std::to_string(sunkCount)
+			+ " columns walkable, but " + std::to_string(restingCount) + " when stood on it");
+		Check(!sunk.IsWalkable(50, 40) && !sunk.IsWalkable(50, 39), "baker: the columns under a sunk wall were walkable");
+
+		//Grids written out from a bake have to cover the whole of it, and
+		//put its floors in the same places, wherever it is
+		NavigationBaker farAway;
+		farAway.AddBox(Vector3(-300, -1, 0), Vector3(50, 1, 50));
+		farAway.Bake();
+		std::stringstream file;
+		if (Check(farAway.WriteGrid(file, 2), "baker: writing a grid from a floor at x = -300 failed")) {
+			NavigationGrid grid(file);
+			int walkable = 0;
+			for (int z = 0; z < grid.GetHeight(); ++z) {
+				for (int x = 0; x < grid.GetWidth(); ++x) {
+					walkable += grid.IsWalkable(x, z) ? 1 : 0;
+				}
+			}
+			int centre = grid.GetNodeAt(Vector3(-300, 0, 0));
+			Check(centre >= 0 && grid.IsWalkable(centre % grid.GetWidth(), centre / grid.GetWidth()),
+				"baker: the middle of a floor at x = -300 wasn't walkable in its grid");
+			Check(walkable >= (CountWalkable(farAway) / 4) - 100, "baker: a grid of a floor at x = -300 only had "
+				+ std::to_string(walkable) + " walkable nodes");
+		}
+		//The binary grid has to be the same grid
+		std::stringstream textFile;
+		std::stringstream binaryFile;
+		farAway.WriteGrid(textFile, 2);
+		if (Check(farAway.WriteBinaryGrid(binaryFile, 2), "baker: writing a binary grid from a floor at x = -300 failed")) {
+			NavigationGrid text(textFile);
+			NavigationGrid binary(binaryFile);
+			bool same = text.GetWidth() == binary.GetWidth() && text.GetHeight() == binary.GetHeight()
+				&& (text.GetOrigin() - binary.GetOrigin()).Length() < 0.01f;
+			for (int cell = 0; same && cell < text.GetWidth() * text.GetHeight(); ++cell) {
+				int x = cell % text.GetWidth();
+				int z = cell / text.GetWidth();
+				same = text.IsWalkable(x, z) == binary.IsWalkable(x, z);
+			}
+			Check(same, "baker: the binary grid wasn't the same as the text one");
+		}
+		std::stringstream nothing;
+		Check(!farAway.WriteGrid(nothing, 1000) && nothing.str().empty(), "baker: a grid with nothing walkable was written");
+	}
+	/*
+	The rectangles BuildMesh covers a bake with have to cover every walkable
+	column, and nothing else, without overlapping - their areas add up to
+	the walkable columns' - and be no more than maxSide columns across. The
+	grid written from the same bake says which columns are walkable, and
+	where they are.
+	*/
+	void CheckBakedMesh(std::mt19937& rng) {
+		NavigationBaker baker;
+		baker.AddBox(Vector3(0, -1, 0), Vector3(40, 1, 40));
+		std::uniform_real_distribution<float> place(-35.0f, 35.0f);
+		std::uniform_real_distribution<float> side(0.5f, 8.0f);
+		for (int i = 0; i < 10; ++i) {
+			baker.AddBox(Vector3(place(rng), 3, place(rng)), Vector3(side(rng), 3, side(rng)));
+		}
+		std::stringstream gridFile;
+		if (!Check(baker.Bake() && baker.WriteGrid(gridFile, 1), "baked mesh: nothing was walkable in the baked scene")) {
+			return;
+		}
+		NavigationGrid grid(gridFile);
+
+		const int maxSide = 8;
+		std::vector<Vector3>			vertices;
+		std::vector<std::vector<int>>	polygons;
+		baker.BuildMesh(vertices, polygons, maxSide);
+		NavigationMesh mesh(vertices, polygons);
+
+		float	area	= 0.0f;
+		int		tooBig	= 0;
+		for (const std::vector<int>& polygon : polygons) {
+			float minX = vertices[polygon[0]].x;
+			float maxX = minX;
+			float minZ = vertices[polygon[0]].z;
+			float maxZ = minZ;
+			for (size_t i = 0; i < polygon.size(); ++i) {
+				const Vector3& a = vertices[polygon[i]];
+				const Vector3& b = vertices[polygon[(i + 1) % polygon.size()]];
+				area += (a.x * b.z) - (b.x * a.z);
+				minX = std::min(minX, a.x);
+				maxX = std::max(maxX, a.x);
+				minZ = std::min(minZ, a.z);
+				maxZ = std::max(maxZ, a.z);
+			}
+			if (maxX - minX > maxSide + 0.01f || maxZ - minZ > maxSide + 0.01f) {
+				tooBig++;
+			}
+		}
+		area = std::fabs(area) * 0.5f;
+
+		int walkable	= 0;
+		int missed		= 0;
+		int extra		= 0;
+		for (int cell = 0; cell < grid.GetWidth() * grid.GetHeight(); ++cell) {
+			bool	isWalkable	= grid.IsWalkable(cell % grid.GetWidth(), cell / grid.GetWidth());
+			Vector3 centre		= grid.GetNodePosition(cell);
+			Vector3 onMesh;
+			bool	inMesh		= mesh.GetPolygonAt(centre, &onMesh) >= 0
+				&& std::fabs(onMesh.x - centre.x) < 0.01f && std::fabs(onMesh.z - centre.z) < 0.01f;
+			walkable += isWalkable ? 1 : 0;
+			if (isWalkable && !inMesh) {
+				missed++;
+			}
+			else if (!isWalkable && inMesh) {
+				extra++;
+			}
+		}
+		Check(missed == 0, "baked mesh: " + std::to_string(missed) + " walkable columns weren't covered by the mesh");
+		Check(extra == 0, "baked mesh: " + std::to_string(extra) + " blocked columns were covered by the mesh");
+		Check(std::fabs(area - walkable) < 0.5f, "baked mesh: its polygons cover an area of " + std::to_string(area)
+			+ ", for " + std::to_string(walkable) + " walkable columns");
+		Check(tooBig == 0, "baked mesh: " + std::to_string(tooBig) + " polygons were more than " + std::to_string(maxSide) + " columns across");
+	}
+}
+
+int main(int argc, char** argv) {
+	unsigned int seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--seed" && i + 1 < argc) {
+			seed = (unsigned int)std::stoul(argv[++i]);
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << "\n";
+			return 1;
+		}
+	}
+	std::mt19937 rng(seed);
+
+	CheckPositions(rng);
+	CheckGridSearches(rng);
+	CheckHierarchical(rng);
+	CheckFlowFieldCosts(rng);
+	CheckFlowFieldWalk(rng);
+	CheckDStarLiteCosts(rng);
+	CheckDStarLiteWalk(rng);
+	CheckQueueChanges(rng);
+	CheckMeshFunnel(rng);
+	CheckMeshFile(rng);
+	CheckBaker();
+	CheckBakedMesh(rng);
+
+	std::cout << checks - failures << " of " << checks << " checks passed (seed " << seed << ")\n";
+	return failures == 0 ? 0 : 1;
+}
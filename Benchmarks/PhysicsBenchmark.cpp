@@ -0,0 +1,388 @@
+/*
+Builds synthetic physics scenes of increasing size, steps them a fixed number
+of times with no window or renderer, and reports where the time went - the
+broadphase, narrowphase, solver and integration, and the world's transform
+update - along with how many pairs
+went through each stage. The results go out as CSV (the default) or JSON, so
+that runs can be compared against each other, and regressions spotted.
+
+Usage:
+	PhysicsBenchmark [--scenes rain,stacks,bridges,pile] [--sizes 100,1000,10000,50000]
+		[--steps 60] [--modes all,quadtree] [--max-all-pairs 2000]
+		[--threads 0] [--format csv|json] [--out file]
+
+The all-pairs mode tests every object against every other object, so it is
+skipped for scenes bigger than --max-all-pairs objects - at 50,000 objects
+it would take hours!
+
+--threads gives the world and the physics a JobSystem with that many
+workers, for the parts of the update that are spread over them. 0 runs
+everything on the one thread.
+
+Run it in Release, or the timings are meaningless!
+*/
+#include "../CSC8503/CSC8503Common/GameWorld.h"
+#include "../CSC8503/CSC8503Common/GameObject.h"
+#include "../CSC8503/CSC8503Common/PhysicsSystem.h"
+#include "../CSC8503/CSC8503Common/PhysicsObject.h"
+#include "../CSC8503/CSC8503Common/PositionConstraint.h"
+#include "../CSC8503/CSC8503Common/WorldBuilder.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	const float STEP_DT = 1.0f / 60.0f;
+
+	//The QuadTree covers -1024 to 1024 on x and z, so the scenes are kept
+	//inside of that
+	const float WORLD_EXTENT = 1000.0f;
+
+	struct Settings {
+		std::vector<std::string>	scenes	= { "rain", "stacks", "bridges", "pile" };
+		std::vector<int>			sizes	= { 100, 1000, 10000, 50000 };
+		std::vector<std::string>	modes	= { "all", "quadtree" };
+		int			steps			= 60;
+		int			maxAllPairs		= 2000;
+		int			threads			= 0;
+		std::string	format			= "csv";
+		std::string	outFile;
+	};
+
+	struct Result {
+		std::string scene;
+		std::string mode;
+		int		objects;
+		int		constraints;
+		int		steps;
+		double	totalTime;	//all of these are milliseconds per step
+		double	broadphaseTime;
+		double	narrowphaseTime;
+		double	solveTime;
+		double	integrateTime;
+		double	transformTime;	//the world's transform update
+		double	broadphasePairs;	//and these are per step
+		double	narrowphaseTests;
+		double	contacts;
+	};
+
+	void AddFloor(GameWorld& world) {
+		WorldBuilder::AddCube(world, Vector3(0, -2, 0), Vector3(WORLD_EXTENT, 2, WORLD_EXTENT), 0.0f);
+	}
+
+	//How many to a side of a square grid of count things, and how far apart
+	//they can be to fit in the world
+	int GridSide(int count) {
+		return (int)std::ceil(std::sqrt((float)count));
+	}
+
+	//Spheres dropping onto a floor from a grid of heights
+	void BuildSphereRain(GameWorld& world, int count, std::mt19937& rng) {
+		AddFloor(world);
+		std::uniform_real_distribution<float> jitter(-0.25f, 0.25f);
+
+		int		layerSide	= std::min(GridSide(count), 200);
+		float	spacing		= std::min(4.0f, (2.0f * WORLD_EXTENT * 0.9f) / layerSide);
+		float	start		= -0.5f * spacing * (layerSide - 1);
+
+		for (int i = 1; i < count; ++i) {
+			int x		= i % layerSide;
+			int z		= (i / layerSide) % layerSide;
+			int layer	= i / (layerSide * layerSide);
+			Vector3 pos(start + x * spacing + jitter(rng), 10.0f + layer * 4.0f + jitter(rng), start + z * spacing + jitter(rng));
+			WorldBuilder::AddSphere(world, pos, 1.0f, 1.0f);
+		}
+	}
+
+	//Columns of 10 cubes, resting on top of each other on a floor
+	void BuildBoxStacks(GameWorld& world, int count, std::mt19937& rng) {
+		AddFloor(world);
+		const int stackHeight = 10;
+
+		int		stacks	= std::max(1, (count - 1) / stackHeight);
+		int		side	= GridSide(stacks);
+		float	spacing = std::min(5.0f, (2.0f * WORLD_EXTENT * 0.9f) / side);
+		float	start	= -0.5f * spacing * (side - 1);
+
+		for (int i = 1; i < count; ++i) {
+			int stack = (i - 1) / stackHeight;
+			int level = (i - 1) % stackHeight;
+			Vector3 pos(start + (stack % side) * spacing, 1.0f + level * 2.0f, start + (stack / side) * spacing);
+			WorldBuilder::AddCube(world, pos, Vector3(1, 1, 1), 1.0f);
+		}
+	}
+
+	//Chains of spheres held together by PositionConstraints, pinned in place
+	//at both ends, sagging under gravity
+	void BuildRopeBridges(GameWorld& world, int count, std::mt19937& rng) {
+		const int	linksPerBridge	= 20;
+		const float linkDistance	= 3.0f;
+
+		int		bridges = std::max(1, count / linksPerBridge);
+		int		side	= GridSide(bridges);
+		float	spacing = std::min(linksPerBridge * linkDistance + 5.0f, (2.0f * WORLD_EXTENT * 0.9f) / side);
+		float	start	= -0.5f * spacing * (side - 1);
+
+		for (int b = 0; b < bridges; ++b) {
+			Vector3 origin(start + (b % side) * spacing, 20.0f, start + (b / side) * spacing);
+			GameObject* previous = nullptr;
+			for (int i = 0; i < linksPerBridge; ++i) {
+				bool	pinned	= (i == 0 || i == linksPerBridge - 1);
+				Vector3 pos		= origin + Vector3(i * linkDistance * 0.5f, 0, 0);
+				GameObject* link = WorldBuilder::AddSphere(world, pos, 0.5f, pinned ? 0.0f : 1.0f);
+				if (previous) {
+					world.AddConstraint(new PositionConstraint(previous, link, linkDistance * 0.5f));
+				}
+				previous = link;
+			}
+		}
+	}
+
+	//A dense, overlapping heap of spheres and cubes with no gravity - every
+	//object starts out touching several others, so it's the worst case for
+	//the narrowphase and solver
+	void BuildPile(GameWorld& world, int count, std::mt19937& rng) {
+		float radius = std::min(WORLD_EXTENT * 0.9f, 1.2f * std::cbrt((float)count));
+		std::uniform_real_distribution<float> spread(-radius, radius);
+		std::uniform_real_distribution<float> sizes(0.5f, 1.5f);
+
+		for (int i = 0; i < count; ++i) {
+			Vector3 pos(spread(rng), spread(rng) + radius, spread(rng));
+			if (i & 1) {
+				WorldBuilder::AddSphere(world, pos, sizes(rng), 1.0f);
+			}
+			else {
+				float s = sizes(rng);
+				WorldBuilder::AddCube(world, pos, Vector3(s, s, s), 1.0f);
+			}
+		}
+	}
+
+	typedef void(*SceneBuilder)(GameWorld&, int, std::mt19937&);
+
+	SceneBuilder GetSceneBuilder(const std::string& name) {
+		if (name == "rain")		return BuildSphereRain;
+		if (name == "stacks")	return BuildBoxStacks;
+		if (name == "bridges")	return BuildRopeBridges;
+		if (name == "pile")		return BuildPile;
+		return nullptr;
+	}
+
+	Result RunScene(const std::string& scene, const std::string& mode, int size, int steps, JobSystem* jobs) {
+		GameWorld		world;
+		PhysicsSystem	physics(world);
+		std::mt19937	rng(12345);	//same scene every run
+
+		world.SetJobSystem(jobs);
+		physics.SetJobSystem(jobs);
+
+		physics.UseGravity(scene != "pile");
+		physics.UseBroadPhase(mode == "quadtree");
+
+		GetSceneBuilder(scene)(world, size, rng);
+		world.UpdateWorld(0.0f);
+
+		Result r;
+		r.scene			= scene;
+		r.mode			= mode;
+		r.objects		= 0;
+		r.constraints	= 0;
+		r.steps			= steps;
+		r.totalTime		= r.broadphaseTime = r.narrowphaseTime = r.solveTime = r.integrateTime = r.transformTime = 0.0;
+		r.broadphasePairs = r.narrowphaseTests = r.contacts = 0.0;
+
+		std::vector<GameObject*>::const_iterator first, last;
+		world.GetObjectIterators(first, last);
+		r.objects = (int)(last - first);
+		std::vector<Constraint*>::const_iterator firstC, lastC;
+		world.GetConstraintIterators(firstC, lastC);
+		r.constraints = (int)(lastC - firstC);
+
+		for (int i = 0; i < steps; ++i) {
+			auto start = std::chrono::high_resolution_clock::now();
+			world.UpdateWorld(STEP_DT);
+			auto transformsDone = std::chrono::high_resolution_clock::now();
+			physics.Update(STEP_DT);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			const PhysicsSystem::UpdateStats& s = physics.GetLastUpdateStats();
+			r.totalTime			+= std::chrono::duration<double, std::milli>(end - start).count();
+			r.broadphaseTime	+= s.broadphaseTime;
+			r.narrowphaseTime	+= s.narrowphaseTime;
+			r.solveTime			+= s.solveTime;
+			r.integrateTime		+= s.integrateTime;
+			r.transformTime		+= std::chrono::duration<double, std::milli>(transformsDone - start).count();
+			r.broadphasePairs	+= s.broadphasePairs;
+			r.narrowphaseTests	+= s.narrowphaseTests;
+			r.contacts			+= s.contacts;
+		}
+		double perStep = 1.0 / std::max(steps, 1);
+		r.totalTime			*= perStep;
+		r.broadphaseTime	*= perStep;
+		r.narrowphaseTime	*= perStep;
+		r.solveTime			*= perStep;
+		r.integrateTime		*= perStep;
+		r.transformTime		*= perStep;
+		r.broadphasePairs	*= perStep;
+		r.narrowphaseTests	*= perStep;
+		r.contacts			*= perStep;
+
+		physics.Clear();
+		world.ClearAndErase();
+		return r;
+	}
+
+	void WriteCSV(std::ostream& o, const std::vector<Result>& results) {
+		o << "scene,mode,objects,constraints,steps,total_ms,broadphase_ms,narrowphase_ms,solve_ms,integrate_ms,transform_ms,"
+			"broadphase_pairs,narrowphase_tests,contacts\n";
+		for (const Result& r : results) {
+			o << r.scene << "," << r.mode << "," << r.objects << "," << r.constraints << "," << r.steps << ","
+				<< r.totalTime << "," << r.broadphaseTime << "," << r.narrowphaseTime << ","
+				<< r.solveTime << "," << r.integrateTime << "," << r.transformTime << ","
+				<< r.broadphasePairs << "," << r.narrowphaseTests << "," << r.contacts << "\n";
+		}
+	}
+
+	void WriteJSON(std::ostream& o, const std::vector<Result>& results) {
+		o << "[\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& r = results[i];
+			o << "  {\"scene\": \"" << r.scene << "\", \"mode\": \"" << r.mode << "\""
+				<< ", \"objects\": " << r.objects << ", \"constraints\": " << r.constraints
+				<< ", \"steps\": " << r.steps
+				<< ", \"total_ms\": " << r.totalTime
+				<< ", \"broadphase_ms\": " << r.broadphaseTime
+				<< ", \"narrowphase_ms\": " << r.narrowphaseTime
+				<< ", \"solve_ms\": " << r.solveTime
+				<< ", \"integrate_ms\": " << r.integrateTime
+				<< ", \"transform_ms\": " << r.transformTime
+				<< ", \"broadphase_pairs\": " << r.broadphasePairs
+				<< ", \"narrowphase_tests\": " << r.narrowphaseTests
+				<< ", \"contacts\": " << r.contacts << "}"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		o << "]\n";
+	}
+
+	std::vector<std::string> SplitList(const std::string& list) {
+		std::vector<std::string> out;
+		std::stringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			if (!item.empty()) {
+				out.emplace_back(item);
+			}
+		}
+		return out;
+	}
+
+	bool ParseArguments(int argc, char** argv, Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg		= argv[i];
+			bool		hasNext = i + 1 < argc;
+			if (arg == "--scenes" && hasNext) {
+				settings.scenes = SplitList(argv[++i]);
+			}
+			else if (arg == "--sizes" && hasNext) {
+				settings.sizes.clear();
+				for (const std::string& s : SplitList(argv[++i])) {
+					settings.sizes.emplace_back(std::stoi(s));
+				}
+			}
+			else if (arg == "--modes" && hasNext) {
+				settings.modes = SplitList(argv[++i]);
+			}
+			else if (arg == "--steps" && hasNext) {
+				settings.steps = std::stoi(argv[++i]);
+			}
+			else if (arg == "--max-all-pairs" && hasNext) {
+				settings.maxAllPairs = std::stoi(argv[++i]);
+			}
+			else if (arg == "--threads" && hasNext) {
+				settings.threads = std::stoi(argv[++i]);
+			}
+			else if (arg == "--format" && hasNext) {
+				settings.format = argv[++i];
+			}
+			else if (arg == "--out" && hasNext) {
+				settings.outFile = argv[++i];
+			}
+			else {
+				std::cerr << "Unknown argument " << arg << "\n";
+				return false;
+			}
+		}
+		for (const std::string& s : settings.scenes) {
+			if (!GetSceneBuilder(s)) {
+				std::cerr << "Unknown scene " << s << " (expected rain, stacks, bridges or pile)\n";
+				return false;
+			}
+		}
+		for (const std::string& m : settings.modes) {
+			if (m != "all" && m != "quadtree") {
+				std::cerr << "Unknown mode " << m << " (expected all or quadtree)\n";
+				return false;
+			}
+		}
+		if (settings.format != "csv" && settings.format != "json") {
+			std::cerr << "Unknown format " << settings.format << " (expected csv or json)\n";
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	Settings settings;
+	if (!ParseArguments(argc, argv, settings)) {
+		return 1;
+	}
+
+	std::unique_ptr<JobSystem> jobs;
+	if (settings.threads > 0) {
+		jobs.reset(new JobSystem(settings.threads));
+	}
+
+	std::vector<Result> results;
+	for (const std::string& scene : settings.scenes) {
+		for (int size : settings.sizes) {
+			for (const std::string& mode : settings.modes) {
+				if (mode == "all" && size > settings.maxAllPairs) {
+					std::cerr << "Skipping " << scene << " / " << size << " / all pairs (over --max-all-pairs)\n";
+					continue;
+				}
+				std::cerr << "Running " << scene << " / " << size << " / " << mode << "...\n";
+				results.emplace_back(RunScene(scene, mode, size, settings.steps, jobs.get()));
+			}
+		}
+	}
+
+	std::ofstream	file;
+	std::ostream*	out = &std::cout;
+	if (!settings.outFile.empty()) {
+		file.open(settings.outFile);
+		if (!file) {
+			std::cerr << "Couldn't open " << settings.outFile << " for writing\n";
+			return 1;
+		}
+		out = &file;
+	}
+
+	if (settings.format == "json") {
+		WriteJSON(*out, results);
+	}
+	else {
+		WriteCSV(*out, results);
+	}
+	return 0;
+}
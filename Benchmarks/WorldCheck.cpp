@@ -0,0 +1,197 @@
+/*
+Checks the GameWorld's bookkeeping - that the components it keeps in its
+pools stay where they are while other objects come and go, so anything
+holding a pointer to one can keep using it, and that the level arena reuses
+what's freed, and can be reset again once a level's gone. Prints a line for
+each failure, and a summary, and returns non-zero if anything failed, so it
+can be run as a test.
+
+Usage:
+	WorldCheck [--seed 1]
+*/
+#include "../CSC8503/CSC8503Common/GameWorld.h"
+#include "../CSC8503/CSC8503Common/GameObject.h"
+#include "../Common/MemoryArena.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	int checks		= 0;
+	int failures	= 0;
+
+	bool Check(bool passed, const std::string& what) {
+		checks++;
+		if (!passed) {
+			failures++;
+			std::cout << "FAILED: " << what << "\n";
+		}
+		return passed;
+	}
+
+	GameObject* AddObject(GameWorld& world, bool render) {
+		GameObject* o = new GameObject("Object");
+		world.AddGameObject(o);
+		o->SetPhysicsObject(PhysicsObject(&o->GetTransform(), nullptr));
+		if (render) {
+			o->SetRenderObject(RenderObject(&o->GetTransform(), nullptr, nullptr, nullptr));
+		}
+		return o;
+	}
+
+	/*
+	A handful of objects have their components' addresses kept, and marked
+	with a velocity and colour of their own, then thousands of others - more
+	than fit in a pool chunk - are added and removed at random around them.
+	Every kept pointer has to still be the object's component, with its own
+	mark on it.
+	*/
+	void CheckStablePointers(std::mt19937& rng) {
+		GameWorld world;
+
+		struct Kept {
+			GameObject*		object;
+			PhysicsObject*	physics;
+			RenderObject*	render;
+		};
+		std::vector<Kept>			kept;
+		std::vector<GameObject*>	others;
+		std::uniform_int_distribution<int> coin(0, 1);
+
+		for (int round = 0; round < 8; ++round) {
+			GameObject* o = AddObject(world, true);
+			Kept k = { o, o->GetPhysicsObject(), o->GetRenderObject() };
+			k.physics->SetLinearVelocity(Vector3((float)round, 1.0f, 2.0f));
+			k.render->SetColour(Vector4((float)round, 0.0f, 0.0f, 1.0f));
+			kept.emplace_back(k);
+
+			for (int i = 0; i < 700; ++i) {
+				others.emplace_back(AddObject(world, coin(rng) == 1));
+			}
+			std::shuffle(others.begin(), others.end(), rng);
+			for (int i = 0; i < 300; ++i) {
+				world.RemoveGameObject(others.back());
+				delete others.back();
+				others.pop_back();
+			}
+		}
+		int moved	= 0;
+		int changed	= 0;
+		for (size_t i = 0; i < kept.size(); ++i) {
+			const Kept& k = kept[i];
+			if (k.object->GetPhysicsObject() != k.physics || k.object->GetRenderObject() != k.render
+				|| world.GetPhysicsComponents().Get(k.object->GetWorldID()) != k.physics
+				|| world.GetRenderComponents().Get(k.object->GetWorldID()) != k.render) {
+				moved++;
+			}
+			else if (k.physics->GetLinearVelocity() != Vector3((float)i, 1.0f, 2.0f)
+				|| k.render->GetColour().x != (float)i) {
+				changed++;
+			}
+		}
+		Check(moved == 0, "pools: " + std::to_string(moved) + " of " + std::to_string(kept.size()) + " components moved while other objects came and went");
+		Check(changed == 0, "pools: " + std::to_string(changed) + " of " + std::to_string(kept.size()) + " components were overwritten by other objects'");
+
+		size_t physicsCount = 0;
+		for (size_t i = 0; i < world.GetPhysicsComponents().GetSlotCount(); ++i) {
+			physicsCount += world.GetPhysicsComponents().GetOwner(i) ? 1 : 0;
+		}
+		Check(physicsCount == kept.size() + others.size() && world.GetPhysicsComponents().Size() == physicsCount,
+			"pools: " + std::to_string(physicsCount) + " physics slots had owners, for " + std::to_string(kept.size() + others.size()) + " objects");
+
+		//Replacing a component keeps it in the same place
+		GameObject*		o		= kept.front().object;
+		PhysicsObject*	before	= o->GetPhysicsObject();
+		Check(o->SetPhysicsObject(PhysicsObject(&o->GetTransform(), nullptr)) == before,
+			"pools: replacing a physics component moved it");
+
+		world.ClearAndErase();
+		Check(world.GetPhysicsComponents().Size() == 0 && world.GetRenderComponents().Size() == 0,
+			"pools: components were left behind by ClearAndErase");
+	}
+
+	/*
+	Components given to an object before it's in a world have to end up in
+	the pools when it's added, and leave with it when it's removed.
+	*/
+	void CheckAddAndRemove() {
+		GameWorld world;
+		GameObject* o = new GameObject("Early");
+		o->SetPhysicsObject(PhysicsObject(&o->GetTransform(), nullptr))->SetInverseMass(0.5f);
+		world.AddGameObject(o);
+
+		PhysicsObject* physics = o->GetPhysicsObject();
+		Check(physics && world.GetPhysicsComponents().Get(o->GetWorldID()) == physics,
+			"pools: a component given before the object was added isn't in the pool");
+		Check(physics && physics->GetInverseMass() == 0.5f,
+			"pools: a component given before the object was added lost its state");
+
+		world.RemoveGameObject(o);
+		Check(!o->GetPhysicsObject() && world.GetPhysicsComponents().Size() == 0,
+			"pools: a removed object's component stayed in the pool");
+		delete o;
+	}
+
+	/*
+	Strings in the level arena growing and being thrown away, over and over,
+	have to keep reusing the same memory, rather than take more each time.
+	An object that outlives its level has to stop the arena being reset, and
+	say so - and once it's gone, the next level has to reset it again.
+	*/
+	void CheckLevelArena() {
+		MemoryArena& arena = MemoryArena::GetLevelArena();
+		auto growStrings = [&]() {
+			for (int i = 0; i < 16; ++i) {
+				LevelString s;
+				for (int j = 0; j < 65536; ++j) {
+					s += 'x';
+				}
+			}
+		};
+		growStrings();
+		size_t blocks = arena.GetBlockCount();
+		for (int round = 0; round < 50; ++round) {
+			growStrings();
+		}
+		Check(arena.GetBlockCount() == blocks, "arena: strings growing over and over took the arena from "
+			+ std::to_string(blocks) + " blocks to " + std::to_string(arena.GetBlockCount()));
+
+		GameWorld	world;
+		GameObject* survivor = new GameObject("Survivor");
+		AddObject(world, true);
+		Check(!world.ClearAndErase(), "arena: a level was released with an object still alive");
+
+		delete survivor;
+		AddObject(world, true);
+		Check(world.ClearAndErase() && arena.GetLiveCount() == 0 && arena.GetBytesUsed() == 0,
+			"arena: the level after a leak couldn't be released");
+	}
+}
+
+int main(int argc, char** argv) {
+	unsigned int seed = 1;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--seed" && i + 1 < argc) {
+			seed = (unsigned int)std::stoul(argv[++i]);
+		}
+		else {
+			std::cerr << "Unknown argument " << arg << "\n";
+			return 1;
+		}
+	}
+	std::mt19937 rng(seed);
+
+	CheckStablePointers(rng);
+	CheckAddAndRemove();
+	CheckLevelArena();
+
+	std::cout << checks - failures << " of " << checks << " checks passed (seed " << seed << ")\n";
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+Class:IndexedMinHeap
+Implements:
+Description:A binary min-heap of item indices, each with a key to sort them by -
+the open list for A* and friends. Items are ints in [0, capacity), such as
+a node's index into a grid, and the heap keeps track of where each item is
+in it, so that it can tell whether an item is in the heap, and change the key
+of one that is (DecreaseKey, UpdateKey) or take it out (Remove), in O(1) and
+O(log n) rather than having to search for it first.
+
+Clear only resets the items that are still in the heap, so a heap can be
+reused for search after search without paying for its whole capacity each
+time.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+#include <cassert>
+
+namespace NCL {
+	namespace CSC8503 {
+		template<class Key>
+		class IndexedMinHeap {
+		public:
+			IndexedMinHeap(int capacity = 0) {
+				SetCapacity(capacity);
+			}
+
+			//Items must be < capacity. Empties the heap
+			void SetCapacity(int capacity) {
+				heap.clear();
+				positions.assign(capacity, NOT_IN_HEAP);
+			}
+
+			int GetCapacity() const {
+				return (int)positions.size();
+			}
+
+			void Clear() {
+				for (const Entry& e : heap) {
+					positions[e.item] = NOT_IN_HEAP;
+				}
+				heap.clear();
+			}
+
+			bool Empty() const {
+				return heap.empty();
+			}
+
+			int Size() const {
+				return (int)heap.size();
+			}
+
+			bool Contains(int item) const {
+				return positions[item] != NOT_IN_HEAP;
+			}
+
+			const Key& GetKey(int item) const {
+				assert(Contains(item));
+				return heap[positions[item]].key;
+			}
+
+			void Push(int item, const Key& key) {
+				assert(!Contains(item));
+				heap.push_back(Entry{ key, item });
+				positions[item] = (int)heap.size() - 1;
+				SiftUp((int)heap.size() - 1);
+			}
+
+			//key must be no larger than the item's current key
+			void DecreaseKey(int item, const Key& key) {
+				assert(Contains(item) && !(heap[positions[item]].key < key));
+				int i = positions[item];
+				heap[i].key = key;
+				SiftUp(i);
+			}
+
+			//key can be larger or smaller than the item's current key
+			void UpdateKey(int item, const Key& key) {
+				assert(Contains(item));
+				int i = positions[item];
+				bool smaller = key < heap[i].key;
+				heap[i].key = key;
+				if (smaller) {
+					SiftUp(i);
+				}
+				else {
+					SiftDown(i);
+				}
+			}
+
+			//Takes the item out of the heap, from wherever it is in it
+			void Remove(int item) {
+				assert(Contains(item));
+				int i = positions[item];
+				positions[item] = NOT_IN_HEAP;
+
+				Entry last = heap.back();
+				heap.pop_back();
+				if (i < (int)heap.size()) {
+					Place(i, last);
+					if (i > 0 && last.key < heap[(i - 1) / 2].key) {
+						SiftUp(i);
+					}
+					else {
+						SiftDown(i);
+					}
+				}
+			}
+
+			int Top() const {
+				return heap.front().item;
+			}
+
+			const Key& TopKey() const {
+				return heap.front().key;
+			}
+
+			//Removes and returns the item with the smallest key
+			int Pop() {
+				int top = heap.front().item;
+				positions[top] = NOT_IN_HEAP;
+
+				Entry last = heap.back();
+				heap.pop_back();
+				if (!heap.empty()) {
+					heap[0] = last;
+					positions[last.item] = 0;
+					SiftDown(0);
+				}
+				return top;
+			}
+
+		protected:
+			enum { NOT_IN_HEAP = -1 };
+
+			struct Entry {
+				Key key;
+				int item;
+			};
+
+			//The children of i are at 2i + 1 and 2i + 2. Entries are moved
+			//into the hole rather than swapped, to save on writes
+			void SiftUp(int i) {
+				Entry e = heap[i];
+				while (i > 0) {
+					int parent = (i - 1) / 2;
+					if (!(e.key < heap[parent].key)) {
+						break;
+					}
+					Place(i, heap[parent]);
+					i = parent;
+				}
+				Place(i, e);
+			}
+
+			void SiftDown(int i) {
+				Entry e		= heap[i];
+				int count	= (int)heap.size();
+				while (true) {
+					int child = 2 * i + 1;
+					if (child >= count) {
+						break;
+					}
+					if (child + 1 < count && heap[child + 1].key < heap[child].key) {
+						child++;
+					}
+					if (!(heap[child].key < e.key)) {
+						break;
+					}
+					Place(i, heap[child]);
+					i = child;
+				}
+				Place(i, e);
+			}
+
+			void Place(int i, const Entry& e) {
+				heap[i] = e;
+				positions[e.item] = i;
+			}
+
+			std::vector<Entry>	heap;
+			std::vector<int>	positions;	//where each item is in heap, or NOT_IN_HEAP
+		};
+	}
+}
@@ -1,4 +1,5 @@
 #include "CollisionDetection.h"
+#include "CollisionKernels.h"
 #include "CollisionVolume.h"
 #include "AABBVolume.h"
 #include "OBBVolume.h"
@@ -370,140 +371,78 @@ bool CollisionDetection::AABBTest(const Vector3& posA, const Vector3& posB, cons
 	return false;
 }
 
+/*
+The volume / volume tests below just pull the shape data out of the volumes
+and transforms - reading each world position once - and hand it over to the
+kernels in CollisionKernels.h, which do the actual work.
+*/
+namespace {
+	using namespace NCL::CollisionKernels;
+
+	AABBShape<float> MakeAABBShape(const Vector3& halfSize, const Transform& transform) {
+		AABBShape<float> shape;
+		shape.centre	= transform.GetWorldPosition();
+		shape.halfSize	= halfSize;
+		return shape;
+	}
+
+	SphereShape<float> MakeSphereShape(const SphereVolume& volume, const Transform& transform) {
+		SphereShape<float> shape;
+		shape.centre	= transform.GetWorldPosition();
+		shape.radius	= volume.GetRadius();
+		return shape;
+	}
+
+	OBBShape<float> MakeOBBShape(const Vector3& halfSize, const Transform& transform) {
+		OBBShape<float> shape;
+		shape.centre	= transform.GetWorldPosition();
+		shape.halfSize	= halfSize;
+		shape.rotation	= transform.GetWorldOrientation().ToMatrix3();
+		return shape;
+	}
+
+	bool AddContact(bool hit, const Contact<float>& contact, CollisionDetection::CollisionInfo& collisionInfo) {
+		if (hit) {
+			collisionInfo.AddContactPoint(contact.position, contact.normal, contact.penetration);
+		}
+		return hit;
+	}
+}
+
 //AABB/AABB Collisions
 bool CollisionDetection::AABBIntersection(const AABBVolume& volumeA, const Transform& worldTransformA,
 	const AABBVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo) {
-	
-	Vector3 boxAPos = worldTransformA.GetWorldPosition();
-	Vector3 boxBPos = worldTransformB.GetWorldPosition();
-	
-	Vector3 boxASize = volumeA.GetHalfDimensions();
-	Vector3 boxBSize = volumeB.GetHalfDimensions();
-	
-	bool overlap = AABBTest(boxAPos, boxBPos, boxASize, boxBSize);
-	if (overlap) {
-		static const Vector3 faces[6] = 
-		{	
-			Vector3(-1, 0, 0), Vector3(1, 0, 0),							
-			Vector3(0, -1, 0), Vector3(0, 1, 0),							
-			Vector3(0, 0, -1), Vector3(0, 0, 1), 
-		};
-
-		Vector3 maxA = boxAPos + boxASize;
-		Vector3 minA = boxAPos - boxASize;
-		
-		Vector3 maxB = boxBPos + boxBSize;
-		Vector3 minB = boxBPos - boxBSize;
-		
-		float distances[6] =
-		{
-			(maxB.x - minA.x),// distance of box b to left  of a .
-			(maxA.x - minB.x),// distance of box b to right  of a .
-			(maxB.y - minA.y),// distance of box b to bottom  of a .
-			(maxA.y - minB.y),// distance of box b to top  of a .
-			(maxB.z - minA.z),// distance of box b to far  of a .
-			(maxA.z - minB.z) // distance of box b to near  of a .
-		};
-		
-		float penetration = FLT_MAX;
-		Vector3 axis;
-		
-		for (int i = 0; i < 6; i++)
-			{
-			if (distances[i] < penetration) {
-				penetration = distances[i];
-				axis = faces[i];
-			}
-		}
-		
-		Vector3 closestPointOnBoxA = Maths::Clamp(boxBPos, minA, maxA);
-		Vector3 closestPointOnBoxB = Maths::Clamp(boxAPos, minB, maxB);
-		
-		Vector3 aDir = (boxAPos - closestPointOnBoxB).Normalised();
-		Vector3 bDir = (boxBPos - closestPointOnBoxA).Normalised();
-		
-		float aDot = Vector3::Dot(aDir, axis);
-		float bDot = Vector3::Dot(bDir, axis);
-		
-		if (abs(aDot) > abs(bDot)) {
-			collisionInfo.AddContactPoint(closestPointOnBoxB, axis, penetration);
-		}
-		else {
-			collisionInfo.AddContactPoint(closestPointOnBoxA, axis, penetration);
-		}
-		return true;
-		}
-
-	return false;
+	Contact<float> contact;
+	bool hit = CollisionKernels::AABBIntersection(MakeAABBShape(volumeA.GetHalfDimensions(), worldTransformA),
+		MakeAABBShape(volumeB.GetHalfDimensions(), worldTransformB), contact);
+	return AddContact(hit, contact, collisionInfo);
 }
 
 //Sphere / Sphere Collision
 bool CollisionDetection::SphereIntersection(const SphereVolume& volumeA, const Transform& worldTransformA,
 	const SphereVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo) {
-		
-	float radii = volumeA.GetRadius() + volumeB.GetRadius();
-	Vector3 delta = worldTransformB.GetWorldPosition() - worldTransformA.GetWorldPosition();
-	
-	float deltaLength = delta.Length();
-	
-	if (deltaLength < radii) {
-		float penetration = (radii - deltaLength);
-		Vector3 normal = delta.Normalised();
-		Vector3 collisionPoint = collisionPoint = worldTransformA.GetWorldPosition() + (normal * (volumeA.GetRadius() - (penetration * 0.5f)));
-		
-		collisionInfo.AddContactPoint(collisionPoint, normal, penetration);
-		return true;// we re colliding !
-	}
-
-	return false;
+	Contact<float> contact;
+	bool hit = CollisionKernels::SphereIntersection(MakeSphereShape(volumeA, worldTransformA),
+		MakeSphereShape(volumeB, worldTransformB), contact);
+	return AddContact(hit, contact, collisionInfo);
 }
 
 //AABB - Sphere Collision
 bool CollisionDetection::AABBSphereIntersection(const AABBVolume& volumeA, const Transform& worldTransformA,
 	const SphereVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo) {
-	
-	Vector3 boxSize = volumeA.GetHalfDimensions();
-	
-	Vector3 delta = worldTransformB.GetWorldPosition() - worldTransformA.GetWorldPosition();
-	
-	Vector3 closestPointOnBox = Maths::Clamp(delta, -boxSize, boxSize);
-
-	Vector3 localPoint = delta - closestPointOnBox;
-	float distance = (localPoint).Length();
-	
-	if (distance < volumeB.GetRadius()) {// yes , we re colliding !
-		collisionInfo.AddContactPoint(closestPointOnBox + worldTransformA.GetWorldPosition(), 
-		distance == 0.0f ? delta.Normalised() : localPoint.Normalised(), 
-		(volumeB.GetRadius() - distance));
-		return true;
-	}
-	
-	return false;
+	Contact<float> contact;
+	bool hit = CollisionKernels::AABBSphereIntersection(MakeAABBShape(volumeA.GetHalfDimensions(), worldTransformA),
+		MakeSphereShape(volumeB, worldTransformB), contact);
+	return AddContact(hit, contact, collisionInfo);
 }
 
 //OBB - Sphere Collision
 bool CollisionDetection::OBBSphereIntersection(const AABBVolume& volumeA, const Transform& worldTransformA,
 	const SphereVolume& volumeB, const Transform& worldTransformB, CollisionInfo& collisionInfo) {
-
-	Matrix3 invTransform = worldTransformA.GetInverseWorldOrientationMat();
-
-	Vector3 boxSize = volumeA.GetHalfDimensions();
-
-	Vector3 delta = worldTransformB.GetWorldPosition() - worldTransformA.GetWorldPosition();
-
-	Vector3 closestPointOnBox = Maths::Clamp(delta, -boxSize, boxSize);
-
-	Vector3 localPoint = delta - closestPointOnBox;
-	float distance = (localPoint).Length();
-
-	if (distance < volumeB.GetRadius()) {// yes , we re colliding !
-		collisionInfo.AddContactPoint(closestPointOnBox + worldTransformA.GetWorldPosition(),
-			distance == 0.0f ? delta.Normalised() : localPoint.Normalised(),
-			(volumeB.GetRadius() - distance));
-		return true;
-	}
-
-	return false;
+	Contact<float> contact;
+	bool hit = CollisionKernels::OBBSphereIntersection(MakeOBBShape(volumeA.GetHalfDimensions(), worldTransformA),
+		MakeSphereShape(volumeB, worldTransformB), contact);
+	return AddContact(hit, contact, collisionInfo);
 }
 
 bool CollisionDetection::OBBIntersection(
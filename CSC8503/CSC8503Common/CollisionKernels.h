@@ -0,0 +1,266 @@
+/******************************************************************************
+Namespace:CollisionKernels
+Implements:
+Description:The maths behind the CollisionDetection intersection tests, pulled
+out so that it works on plain shape data (a centre, half sizes, a radius, a
+rotation) rather than on volumes and Transforms. Anything that has already
+pulled its shapes out of the world - like a broadphase that keeps its own
+arrays of them - can call these directly, without going back through the
+Transform for a world position every time.
+
+Every kernel is a template on its 'lane' type. With a float, it works on one
+pair of shapes, using the normal Vector3 and Matrix3. With a Floatx4 or
+Floatx8, it works on 4 or 8 pairs at once, using the wide types from
+WideMaths.h. So that the same code works either way, there's no branching on
+the result - every kernel fills in its contact, and returns a mask saying
+which lanes actually hit (a plain bool for floats).
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../../Common/Vector3.h"
+#include "../../Common/Matrix3.h"
+#include "../../Common/WideMaths.h"
+#include <cfloat>
+#include <cmath>
+
+namespace NCL {
+	namespace CollisionKernels {
+		using namespace NCL::Maths;
+
+		/*
+		Maps a lane type onto the vector / matrix / mask types to use with it,
+		along with the handful of operations that don't look the same for a
+		float as they do for a wide type.
+		*/
+		template<class F>
+		struct LaneTraits {
+			typedef Vector3Wide<F>	Vec;
+			typedef Matrix3Wide<F>	Mat;
+			typedef F				Mask;
+
+			static F	Abs(const F& a)								{ return F::Abs(a); }
+			static F	Min(const F& a, const F& b)					{ return F::Min(a, b); }
+			static F	Max(const F& a, const F& b)					{ return F::Max(a, b); }
+			static F	Select(const Mask& m, const F& a, const F& b)	{ return F::Select(m, a, b); }
+			static Vec	Select(const Mask& m, const Vec& a, const Vec& b) { return Vec::Select(m, a, b); }
+			static Mask	And(const Mask& a, const Mask& b)			{ return a & b; }
+		};
+
+		template<>
+		struct LaneTraits<float> {
+			typedef Vector3	Vec;
+			typedef Matrix3	Mat;
+			typedef bool	Mask;
+
+			static float	Abs(float a)							{ return fabs(a); }
+			static float	Min(float a, float b)					{ return a < b ? a : b; }
+			static float	Max(float a, float b)					{ return a > b ? a : b; }
+			static float	Select(Mask m, float a, float b)		{ return m ? a : b; }
+			static Vec		Select(Mask m, const Vec& a, const Vec& b) { return m ? a : b; }
+			static Mask		And(Mask a, Mask b)						{ return a && b; }
+		};
+
+		template<class F>
+		struct SphereShape {
+			typename LaneTraits<F>::Vec centre;
+			F							radius;
+		};
+
+		template<class F>
+		struct AABBShape {
+			typename LaneTraits<F>::Vec centre;
+			typename LaneTraits<F>::Vec halfSize;
+		};
+
+		template<class F>
+		struct OBBShape {
+			typename LaneTraits<F>::Vec centre;
+			typename LaneTraits<F>::Vec halfSize;
+			typename LaneTraits<F>::Mat rotation;	//local to world
+		};
+
+		template<class F>
+		struct Contact {
+			typename LaneTraits<F>::Vec position;
+			typename LaneTraits<F>::Vec normal;
+			F							penetration;
+		};
+
+		//Component-wise clamp of v into [mins, maxs]
+		template<class F>
+		inline typename LaneTraits<F>::Vec Clamp(const typename LaneTraits<F>::Vec& v,
+			const typename LaneTraits<F>::Vec& mins, const typename LaneTraits<F>::Vec& maxs) {
+			typedef LaneTraits<F> T;
+			return typename T::Vec(
+				T::Min(T::Max(v.x, mins.x), maxs.x),
+				T::Min(T::Max(v.y, mins.y), maxs.y),
+				T::Min(T::Max(v.z, mins.z), maxs.z));
+		}
+
+		//m * v and transpose(m) * v - Matrix3 and Matrix3Wide share the same
+		//column major layout, so one version does both. The transpose of a
+		//rotation is its inverse, so OBBs only need to store the one matrix
+		template<class F>
+		inline typename LaneTraits<F>::Vec Rotate(const typename LaneTraits<F>::Mat& m, const typename LaneTraits<F>::Vec& v) {
+			const auto* e = m.values;
+			return typename LaneTraits<F>::Vec(
+				v.x * e[0] + v.y * e[3] + v.z * e[6],
+				v.x * e[1] + v.y * e[4] + v.z * e[7],
+				v.x * e[2] + v.y * e[5] + v.z * e[8]);
+		}
+
+		template<class F>
+		inline typename LaneTraits<F>::Vec InverseRotate(const typename LaneTraits<F>::Mat& m, const typename LaneTraits<F>::Vec& v) {
+			const auto* e = m.values;
+			return typename LaneTraits<F>::Vec(
+				v.x * e[0] + v.y * e[1] + v.z * e[2],
+				v.x * e[3] + v.y * e[4] + v.z * e[5],
+				v.x * e[6] + v.y * e[7] + v.z * e[8]);
+		}
+
+		/*
+		Yes / no overlap tests, with no contact generation - cheap enough for
+		a broadphase to run against every candidate, leaving only the hits to
+		go on to the full tests below.
+		*/
+		template<class F>
+		inline typename LaneTraits<F>::Mask AABBOverlap(const typename LaneTraits<F>::Vec& centreA, const typename LaneTraits<F>::Vec& halfSizeA,
+			const typename LaneTraits<F>::Vec& centreB, const typename LaneTraits<F>::Vec& halfSizeB) {
+			typedef LaneTraits<F> T;
+
+			typename T::Vec delta		= centreB - centreA;
+			typename T::Vec totalSize	= halfSizeA + halfSizeB;
+
+			return T::And(T::And(
+				T::Abs(delta.x) < totalSize.x,
+				T::Abs(delta.y) < totalSize.y),
+				T::Abs(delta.z) < totalSize.z);
+		}
+
+		template<class F>
+		inline typename LaneTraits<F>::Mask SphereOverlap(const typename LaneTraits<F>::Vec& centreA, const F& radiusA,
+			const typename LaneTraits<F>::Vec& centreB, const F& radiusB) {
+			typename LaneTraits<F>::Vec delta = centreB - centreA;
+			F radii = radiusA + radiusB;
+			return LaneTraits<F>::Vec::Dot(delta, delta) < radii * radii;
+		}
+
+		/*
+		AABB / AABB. The collision normal is whichever of the 6 face normals
+		of A has the least penetration along it, and the contact point is the
+		closest point on whichever box is facing the other more directly.
+		*/
+		template<class F>
+		inline typename LaneTraits<F>::Mask AABBIntersection(const AABBShape<F>& a, const AABBShape<F>& b, Contact<F>& contact) {
+			typedef LaneTraits<F>		T;
+			typedef typename T::Vec		Vec;
+
+			typename T::Mask hit = AABBOverlap<F>(a.centre, a.halfSize, b.centre, b.halfSize);
+
+			Vec maxA = a.centre + a.halfSize;
+			Vec minA = a.centre - a.halfSize;
+			Vec maxB = b.centre + b.halfSize;
+			Vec minB = b.centre - b.halfSize;
+
+			const F distances[6] = {
+				maxB.x - minA.x, maxA.x - minB.x,	//left, right of a
+				maxB.y - minA.y, maxA.y - minB.y,	//bottom, top of a
+				maxB.z - minA.z, maxA.z - minB.z	//far, near of a
+			};
+			const F zero(0.0f);
+			const Vec faces[6] = {
+				Vec(F(-1.0f), zero, zero), Vec(F(1.0f), zero, zero),
+				Vec(zero, F(-1.0f), zero), Vec(zero, F(1.0f), zero),
+				Vec(zero, zero, F(-1.0f)), Vec(zero, zero, F(1.0f))
+			};
+
+			F	penetration(FLT_MAX);
+			Vec axis(zero, zero, zero);
+			for (int i = 0; i < 6; ++i) {
+				typename T::Mask closer = distances[i] < penetration;
+				penetration	= T::Select(closer, distances[i], penetration);
+				axis		= T::Select(closer, faces[i], axis);
+			}
+
+			Vec closestOnA = Clamp<F>(b.centre, minA, maxA);
+			Vec closestOnB = Clamp<F>(a.centre, minB, maxB);
+
+			F aDot = Vec::Dot((a.centre - closestOnB).Normalised(), axis);
+			F bDot = Vec::Dot((b.centre - closestOnA).Normalised(), axis);
+
+			contact.position	= T::Select(T::Abs(aDot) > T::Abs(bDot), closestOnB, closestOnA);
+			contact.normal		= axis;
+			contact.penetration	= penetration;
+			return hit;
+		}
+
+		template<class F>
+		inline typename LaneTraits<F>::Mask SphereIntersection(const SphereShape<F>& a, const SphereShape<F>& b, Contact<F>& contact) {
+			typedef typename LaneTraits<F>::Vec Vec;
+
+			F	radii		= a.radius + b.radius;
+			Vec delta		= b.centre - a.centre;
+			F	deltaLength	= delta.Length();
+
+			F	penetration	= radii - deltaLength;
+			Vec normal		= delta.Normalised();
+
+			contact.position	= a.centre + (normal * (a.radius - (penetration * F(0.5f))));
+			contact.normal		= normal;
+			contact.penetration	= penetration;
+			return deltaLength < radii;
+		}
+
+		//Box against sphere, with the sphere's centre already in the box's
+		//local space. Shared by the AABB and OBB versions
+		template<class F>
+		inline typename LaneTraits<F>::Mask LocalBoxSphere(const typename LaneTraits<F>::Vec& delta,
+			const typename LaneTraits<F>::Vec& halfSize, const F& radius,
+			typename LaneTraits<F>::Vec& closestOnBox, typename LaneTraits<F>::Vec& normal, F& penetration) {
+			typedef LaneTraits<F>	T;
+			typedef typename T::Vec	Vec;
+
+			closestOnBox	= Clamp<F>(delta, -halfSize, halfSize);
+			Vec localPoint	= delta - closestOnBox;
+			F	distance	= localPoint.Length();
+
+			//If the centre is inside the box, push out along the centre offset
+			normal		= T::Select(distance == F(0.0f), delta.Normalised(), localPoint.Normalised());
+			penetration	= radius - distance;
+			return distance < radius;
+		}
+
+		template<class F>
+		inline typename LaneTraits<F>::Mask AABBSphereIntersection(const AABBShape<F>& box, const SphereShape<F>& sphere, Contact<F>& contact) {
+			typename LaneTraits<F>::Vec closest;
+
+			typename LaneTraits<F>::Mask hit = LocalBoxSphere<F>(sphere.centre - box.centre, box.halfSize, sphere.radius,
+				closest, contact.normal, contact.penetration);
+
+			contact.position = closest + box.centre;
+			return hit;
+		}
+
+		//As the AABB version, but the sphere is moved into the box's local
+		//space first, and the results are rotated back out again
+		template<class F>
+		inline typename LaneTraits<F>::Mask OBBSphereIntersection(const OBBShape<F>& box, const SphereShape<F>& sphere, Contact<F>& contact) {
+			typename LaneTraits<F>::Vec closest;
+			typename LaneTraits<F>::Vec localNormal;
+
+			typename LaneTraits<F>::Vec localDelta = InverseRotate<F>(box.rotation, sphere.centre - box.centre);
+
+			typename LaneTraits<F>::Mask hit = LocalBoxSphere<F>(localDelta, box.halfSize, sphere.radius,
+				closest, localNormal, contact.penetration);
+
+			contact.position	= Rotate<F>(box.rotation, closest) + box.centre;
+			contact.normal		= Rotate<F>(box.rotation, localNormal);
+			return hit;
+		}
+	}
+}
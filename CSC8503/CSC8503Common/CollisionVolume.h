@@ -1,4 +1,6 @@
 #pragma once
+#include "../../Common/MemoryPool.h"
+
 namespace NCL {
 	enum class VolumeType {
 		AABB		= 1,
@@ -10,13 +12,16 @@ namespace NCL {
 		Invalid		= 256
 	};
 
-	class CollisionVolume
+	//All of the volume types share one pool, as they're all tiny
+	const size_t MAX_POOLED_VOLUME_SIZE = 32;
+
+	class CollisionVolume : public PoolAllocated<CollisionVolume, MAX_POOLED_VOLUME_SIZE>
 	{
 	public:
 		CollisionVolume() {
 			type = VolumeType::Invalid;
 		}
-		~CollisionVolume() {}
+		virtual ~CollisionVolume() {}
 
 		VolumeType type;
 	};
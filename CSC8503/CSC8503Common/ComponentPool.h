@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		A ComponentPool is a sparse set of components, keyed by the world ID of
+		the GameObject that owns them. The 'sparse' array maps a world ID to a
+		slot, so lookups and removals are O(1), and the slots themselves hold
+		the components by value, so walking them is a straight run through
+		memory rather than a pointer chase per object.
+
+		Slots live in fixed size chunks, and a component is built straight into
+		its slot, and never moves from it - growing the pool just adds another
+		chunk. Removing a component leaves its slot empty, for the next one
+		added to fill, so a system walking the slots has to skip any without
+		an owner. That means a pointer to a component stays valid while other
+		objects come and go - it's only invalidated when that component is
+		removed or replaced, its owner leaves the world, or the pool is
+		cleared.
+		*/
+		template<class T, size_t ChunkSize = 256>
+		class ComponentPool {
+		public:
+			ComponentPool() {
+				liveCount = 0;
+			}
+
+			~ComponentPool() {
+				Clear();
+				for (auto& i : chunks) {
+					delete[] i;
+				}
+			}
+
+			ComponentPool(const ComponentPool&)				= delete;
+			ComponentPool& operator=(const ComponentPool&)	= delete;
+
+			//Builds a component from args in the pool, replacing any that the
+			//owner already had in here - in the same slot, so any pointers to
+			//the old one now point at the new one
+			template<class... Args>
+			T* Emplace(int id, GameObject* owner, Args&&... args) {
+				if (id < 0) {
+					return nullptr;
+				}
+				if (id >= (int)sparse.size()) {
+					sparse.resize(id + 1, -1);
+				}
+				int slot = sparse[id];
+				if (slot >= 0) {
+					T* component = GetSlot(slot);
+					component->~T();
+					owners[slot] = owner;
+					return ::new ((void*)component) T(std::forward<Args>(args)...);
+				}
+				if (!freeSlots.empty()) {
+					slot = freeSlots.back();
+					freeSlots.pop_back();
+				}
+				else {
+					if (owners.size() == chunks.size() * ChunkSize) {
+						chunks.emplace_back(new Storage[ChunkSize]);
+					}
+					slot = (int)owners.size();
+					owners.emplace_back(nullptr);
+				}
+				T* component = ::new ((void*)GetSlot(slot)) T(std::forward<Args>(args)...);
+				owners[slot]	= owner;
+				sparse[id]		= slot;
+				liveCount++;
+				return component;
+			}
+
+			T* Insert(int id, T&& component, GameObject* owner) {
+				return Emplace(id, owner, std::move(component));
+			}
+
+			void Remove(int id) {
+				if (!Contains(id)) {
+					return;
+				}
+				int slot = sparse[id];
+				GetSlot(slot)->~T();
+				owners[slot]	= nullptr;
+				sparse[id]		= -1;
+				freeSlots.emplace_back(slot);
+				liveCount--;
+			}
+
+			bool Contains(int id) const {
+				return id >= 0 && id < (int)sparse.size() && sparse[id] >= 0;
+			}
+
+			T* Get(int id) {
+				return Contains(id) ? GetSlot(sparse[id]) : nullptr;
+			}
+
+			const T* Get(int id) const {
+				return Contains(id) ? GetSlot(sparse[id]) : nullptr;
+			}
+
+			//Destroys every component, but keeps the chunks for next time
+			void Clear() {
+				for (size_t i = 0; i < owners.size(); ++i) {
+					if (owners[i]) {
+						GetSlot(i)->~T();
+					}
+				}
+				sparse.clear();
+				owners.clear();
+				freeSlots.clear();
+				liveCount = 0;
+			}
+
+			//How many components are in the pool
+			size_t Size() const {
+				return liveCount;
+			}
+
+			//Slot accessors - i is a slot in the pool, NOT a world ID! Slots
+			//run from 0 to GetSlotCount(), and empty ones have no owner
+			size_t GetSlotCount() const {
+				return owners.size();
+			}
+
+			T* GetComponent(size_t i) {
+				return owners[i] ? GetSlot(i) : nullptr;
+			}
+
+			const T* GetComponent(size_t i) const {
+				return owners[i] ? GetSlot(i) : nullptr;
+			}
+
+			GameObject* GetOwner(size_t i) const {
+				return owners[i];
+			}
+
+		protected:
+			typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+			T* GetSlot(size_t i) const {
+				return (T*)&chunks[i / ChunkSize][i % ChunkSize];
+			}
+
+			std::vector<Storage*>		chunks;
+			std::vector<int>			sparse;
+			std::vector<GameObject*>	owners;	//null for empty slots
+			std::vector<int>			freeSlots;
+			size_t						liveCount;
+		};
+	}
+}
@@ -0,0 +1,280 @@
+#include "DStarLite.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const float DStarLite::INFINITE_COST = std::numeric_limits<float>::max();
+
+namespace {
+	//How far a cell's rhs can be above a neighbour's g plus the move
+	//between them, and still count as having come from that neighbour
+	const float COST_EPSILON = 1e-4f;
+
+	//Keys add up the same costs in different orders, so two that should be
+	//equal can be out by a rounding error, and come off the list in the
+	//wrong order. Searches carry on through every key that's near enough
+	//equal to the start's, so nothing that should have come first gets left
+	//on the list
+	bool IsAfter(float a, float b) {
+		return a > b + (1e-5f * std::max(std::abs(b), 1.0f));
+	}
+
+	void RecordSearch(bool replan, bool found, int nodesExpanded) {
+		static MetricCounter&	plans		= Metrics::GetCounter("path.dstar.plans");
+		static MetricCounter&	replans		= Metrics::GetCounter("path.dstar.replans");
+		static MetricCounter&	failures	= Metrics::GetCounter("path.dstar.failures");
+		static MetricHistogram& expanded	= Metrics::GetHistogram("path.dstar.nodes_expanded", { 16, 64, 256, 1024, 4096, 16384 });
+
+		(replan ? replans : plans).Add();
+		if (!found) {
+			failures.Add();
+		}
+		expanded.Record(nodesExpanded);
+	}
+}
+
+DStarLite::DStarLite(const NavigationGrid& grid) : grid(grid) {
+	version			= grid.GetVersion();
+	start			= -1;
+	goal			= -1;
+	lastStart		= -1;
+	km				= 0.0f;
+	nodesExpanded	= 0;
+}
+
+DStarLite::~DStarLite() {
+}
+
+bool DStarLite::Plan(const Vector3& from, const Vector3& to) {
+	return Plan(grid.GetNodeAt(from), grid.GetNodeAt(to));
+}
+
+bool DStarLite::Plan(int startCell, int goalCell) {
+	NCL_PROFILE_ZONE("Path::DStarLitePlan");
+	int cellCount = grid.GetWidth() * grid.GetHeight();
+
+	version			= grid.GetVersion();
+	km				= 0.0f;
+	nodesExpanded	= 0;
+
+	g.assign(cellCount, INFINITE_COST);
+	rhs.assign(cellCount, INFINITE_COST);
+	if (openList.GetCapacity() != cellCount) {
+		openList.SetCapacity(cellCount);
+	}
+	else {
+		openList.Clear();
+	}
+	if (startCell < 0 || goalCell < 0 || startCell >= cellCount || goalCell >= cellCount) {
+		start = goal = lastStart = -1;
+		RecordSearch(false, false, 0);
+		return false;
+	}
+	start		= startCell;
+	goal		= goalCell;
+	lastStart	= startCell;
+
+	rhs[goal] = 0.0f;
+	openList.Push(goal, CalculateKey(goal));
+
+	bool found = ComputeShortestPath();
+	RecordSearch(false, found, nodesExpanded);
+	return found;
+}
+
+/*
+Every move that a changed cell could affect starts from a cell within one
+step of it - moves into and out of it, and diagonal moves that would cut
+its corner - so only those cells need their rhs looking at again.
+*/
+bool DStarLite::Replan(const Vector3& from) {
+	NCL_PROFILE_ZONE("Path::DStarLiteReplan");
+	if (goal < 0) {
+		return false;
+	}
+	std::vector<int> changes;
+	if (!grid.GetChangesSince(version, changes)) {
+		return Plan(grid.GetNodeAt(from), goal);
+	}
+	int newStart = grid.GetNodeAt(from);
+	if (newStart < 0) {
+		return false;
+	}
+	version			= grid.GetVersion();
+	nodesExpanded	= 0;
+
+	start		= newStart;
+	km			+= grid.GetCellDistance(lastStart, start);
+	lastStart	= start;
+
+	int width	= grid.GetWidth();
+	int height	= grid.GetHeight();
+	for (int cell : changes) {
+		int x = cell % width;
+		int z = cell / width;
+		for (int dz = -1; dz <= 1; ++dz) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				if (x + dx >= 0 && x + dx < width && z + dz >= 0 && z + dz < height) {
+					UpdateCell(cell + dx + (dz * width));
+				}
+			}
+		}
+	}
+	bool found = ComputeShortestPath();
+	RecordSearch(true, found, nodesExpanded);
+	return found;
+}
+
+void DStarLite::GetPath(NavigationPath& outPath) const {
+	outPath.Clear();
+	if (!HasPath()) {
+		return;
+	}
+	std::vector<int> cells = { start };
+	int maxSteps = grid.GetWidth() * grid.GetHeight();
+	while (cells.back() != goal && (int)cells.size() <= maxSteps) {
+		int next = GetNextCell(cells.back());
+		if (next < 0) {
+			return;
+		}
+		cells.push_back(next);
+	}
+	for (auto i = cells.rbegin(); i != cells.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNodePosition(*i));
+	}
+}
+
+int DStarLite::GetNextCell(int cell) const {
+	if (cell < 0 || cell == goal || cell >= (int)g.size()) {
+		return -1;
+	}
+	int		neighbours[8];
+	float	costs[8];
+	int		count	= GetMoves(cell, neighbours, costs);
+	int		best	= -1;
+	float	bestCost = INFINITE_COST;
+	for (int i = 0; i < count; ++i) {
+		int n = neighbours[i];
+		if (g[n] < INFINITE_COST && costs[i] + g[n] < bestCost) {
+			bestCost	= costs[i] + g[n];
+			best		= n;
+		}
+	}
+	return best;
+}
+
+DStarLite::Key DStarLite::CalculateKey(int cell) const {
+	float cost = std::min(g[cell], rhs[cell]);
+	if (cost == INFINITE_COST) {
+		return Key{ INFINITE_COST, INFINITE_COST };
+	}
+	return Key{ cost + grid.GetCellDistance(start, cell) + km, cost };
+}
+
+void DStarLite::UpdateCell(int cell) {
+	if (cell != goal) {
+		rhs[cell] = BestNeighbourCost(cell);
+	}
+	UpdateOpenList(cell);
+}
+
+//Cells are on the open list for as long as g and rhs disagree
+void DStarLite::UpdateOpenList(int cell) {
+	bool onList = openList.Contains(cell);
+	if (g[cell] != rhs[cell]) {
+		if (onList) {
+			openList.UpdateKey(cell, CalculateKey(cell));
+		}
+		else {
+			openList.Push(cell, CalculateKey(cell));
+		}
+	}
+	else if (onList) {
+		openList.Remove(cell);
+	}
+}
+
+float DStarLite::BestNeighbourCost(int cell) const {
+	int		neighbours[8];
+	float	costs[8];
+	int		count	= GetMoves(cell, neighbours, costs);
+	float	best	= INFINITE_COST;
+	for (int i = 0; i < count; ++i) {
+		if (g[neighbours[i]] < INFINITE_COST) {
+			best = std::min(best, costs[i] + g[neighbours[i]]);
+		}
+	}
+	return best;
+}
+
+//Moves cost the same both ways, so the cells that can be moved to from a
+//cell are the same as the ones that can move to it - but there's no moving
+//into or out of a wall
+int DStarLite::GetMoves(int cell, int* neighbours, float* costs) const {
+	int width = grid.GetWidth();
+	if (!grid.IsWalkable(cell % width, cell / width)) {
+		return 0;
+	}
+	return grid.GetNeighbours(cell, neighbours, costs);
+}
+
+/*
+Takes cells off the open list until nothing left on it could give the start
+a cheaper way to the goal. The start itself might not have been expanded by
+then, so its cost is its rhs, not its g.
+
+A cell whose rhs has dropped below its g just takes the new cost, and offers
+it to its neighbours. One whose rhs has gone up has lost the way it used to
+go, so its g is thrown away, and it and every neighbour that went through it
+have to find a new way.
+*/
+bool DStarLite::ComputeShortestPath() {
+	int		neighbours[8];
+	float	costs[8];
+
+	while (!openList.Empty()) {
+		Key oldKey		= openList.TopKey();
+		Key startKey	= CalculateKey(start);
+		if (IsAfter(oldKey.primary, startKey.primary) && rhs[start] <= g[start]) {
+			break;
+		}
+		int cell	= openList.Top();
+		Key newKey	= CalculateKey(cell);
+		if (oldKey < newKey) { //the start has moved since it was added
+			openList.UpdateKey(cell, newKey);
+			continue;
+		}
+		nodesExpanded++;
+		int count = GetMoves(cell, neighbours, costs);
+
+		if (g[cell] > rhs[cell]) {
+			g[cell] = rhs[cell];
+			openList.Remove(cell);
+			for (int i = 0; i < count; ++i) {
+				int n = neighbours[i];
+				if (n != goal && costs[i] + g[cell] < rhs[n]) {
+					rhs[n] = costs[i] + g[cell];
+					UpdateOpenList(n);
+				}
+			}
+		}
+		else {
+			float oldG = g[cell];
+			g[cell] = INFINITE_COST;
+			UpdateCell(cell);
+			for (int i = 0; i < count; ++i) {
+				int n = neighbours[i];
+				if (rhs[n] >= costs[i] + oldG - COST_EPSILON) {
+					UpdateCell(n);
+				}
+			}
+		}
+	}
+	return HasPath();
+}
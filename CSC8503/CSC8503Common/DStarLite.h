@@ -0,0 +1,120 @@
+/******************************************************************************
+Class:DStarLite
+Implements:
+Description:Incremental replanning over a NavigationGrid, for an agent whose
+route might be blocked (or opened up) while it's following it - doors,
+walls getting knocked down, barricades and so on.
+
+It's D* Lite, from Koenig and Likhachev. The search runs backwards, from the
+goal towards the agent, and every cell it touches keeps two costs: g, what
+it cost to get to the goal from there the last time the cell was expanded,
+and rhs, what it would cost going by its neighbours' current g. While they
+match, the cell is settled. When the grid changes, only the cells next to
+the change get their rhs worked out again, and only the ones where it now
+differs from g go back on the open list - so the search picks up where it
+left off, and only redoes the part of it that the change actually affects,
+rather than starting again from scratch. Changes nowhere near the route
+cost next to nothing.
+
+As the agent moves, the start moves with it. Rather than re-sorting the open
+list, its keys are all taken as being out by however far the agent has
+moved (km), and each is fixed up as it comes off the list.
+
+Each planner keeps g and rhs for every cell of the grid, so it costs about
+12 bytes per cell - one per agent for a handful of agents, not for crowds
+(see FlowField for those). Moves cost the same as in the grid's own
+searches. Plan and Replan aren't safe to call while the grid is changing.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "NavigationGrid.h"
+#include "NavigationPath.h"
+#include "BinaryHeap.h"
+#include <vector>
+
+namespace NCL {
+	namespace CSC8503 {
+		class DStarLite {
+		public:
+			DStarLite(const NavigationGrid& grid);
+			~DStarLite();
+
+			//Throws away any old plan, and plans from scratch. Returns false
+			//if there's no way to the goal
+			bool Plan(const Vector3& from, const Vector3& to);
+			bool Plan(int startCell, int goalCell);
+
+			//Moves the start to wherever the agent has got to, and repairs
+			//the plan around any cells of the grid that have changed since
+			//the last Plan or Replan. Returns false if there's no longer a
+			//way to the goal
+			bool Replan(const Vector3& from);
+
+			bool HasPath() const {
+				return start >= 0 && rhs[start] < INFINITE_COST;
+			}
+
+			//Replaces the contents of outPath with the waypoints from the
+			//start to the goal, as NavigationGrid::FindPath would
+			void GetPath(NavigationPath& outPath) const;
+
+			//The neighbour to step into next from a cell, or -1 at the goal,
+			//or if there's no way from there. Only reliable for cells on the
+			//current path
+			int GetNextCell(int cell) const;
+
+			float GetPathCost() const {
+				return start >= 0 ? rhs[start] : INFINITE_COST;
+			}
+
+			int GetStart() const {
+				return start;
+			}
+			int GetGoal() const {
+				return goal;
+			}
+
+			//How many cells the last Plan or Replan took off the open list
+			int GetNodesExpanded() const {
+				return nodesExpanded;
+			}
+
+			static const float INFINITE_COST;
+
+		protected:
+			struct Key {
+				float primary;
+				float secondary;
+
+				bool operator<(const Key& other) const {
+					return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+				}
+			};
+
+			Key		CalculateKey(int cell) const;
+			void	UpdateCell(int cell);
+			void	UpdateOpenList(int cell);
+			float	BestNeighbourCost(int cell) const;
+			int		GetMoves(int cell, int* neighbours, float* costs) const;
+			bool	ComputeShortestPath();
+
+			const NavigationGrid&	grid;
+			unsigned int			version;
+
+			int		start;
+			int		goal;
+			int		lastStart;	//where the start was when km was last updated
+			float	km;
+			int		nodesExpanded;
+
+			std::vector<float>		g;
+			std::vector<float>		rhs;
+			IndexedMinHeap<Key>		openList;
+		};
+	}
+}
@@ -2,11 +2,13 @@
 
 using namespace NCL;
 
-OGLRenderer* Debug::renderer = nullptr;
+RendererBase* Debug::renderer = nullptr;
 
 std::vector<Debug::DebugStringEntry>	Debug::stringEntries;
 std::vector<Debug::DebugLineEntry>		Debug::lineEntries;
 
+std::mutex Debug::entryLock;
+
 
 void Debug::Print(const std::string& text, const Vector2&pos, const Vector4& colour) {
 	DebugStringEntry newEntry;
@@ -15,6 +17,7 @@ void Debug::Print(const std::string& text, const Vector2&pos, const Vector4& col
 	newEntry.position	= pos;
 	newEntry.colour		= colour;
 
+	std::lock_guard<std::mutex> lock(entryLock);
 	stringEntries.emplace_back(newEntry);
 }
 
@@ -25,20 +28,23 @@ void Debug::DrawLine(const Vector3& startpoint, const Vector3& endpoint, const V
 	newEntry.end	= endpoint;
 	newEntry.colour = colour;
 
+	std::lock_guard<std::mutex> lock(entryLock);
 	lineEntries.emplace_back(newEntry);
 }
 
 void Debug::FlushRenderables() {
-	if (!renderer) {
-		return;
-	}
-	for (const auto& i : stringEntries) {
-		renderer->DrawString(i.data, i.position);
-	}
-
-	for (const auto& i : lineEntries) {
-		renderer->DrawLine(i.start, i.end, i.colour);
+	std::lock_guard<std::mutex> lock(entryLock);
+	if (renderer) {
+		for (const auto& i : stringEntries) {
+			renderer->DrawString(i.data, i.position);
+		}
+
+		for (const auto& i : lineEntries) {
+			renderer->DrawLine(i.start, i.end, i.colour);
+		}
 	}
+	//Cleared even with no renderer, or a headless game would just keep
+	//piling them up
 
 	stringEntries.clear();
 	lineEntries.clear();
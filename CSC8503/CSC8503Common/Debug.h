@@ -1,9 +1,15 @@
 #pragma once
-#include "../../Plugins/OpenGLRendering/OGLRenderer.h"
+#include "../../Common/RendererBase.h"
 #include <vector>
 #include <string>
+#include <mutex>
 
 namespace NCL {
+	/*
+	Strings and lines can be added from any thread - the job system's workers
+	included - as they're only queued up here. Nothing is handed to the
+	renderer until FlushRenderables, which must be called on the main thread.
+	*/
 	class Debug
 	{
 	public:
@@ -11,7 +17,7 @@ namespace NCL {
 		static void DrawLine(const Vector3& startpoint, const Vector3& endpoint, const Vector4& colour = Vector4(1, 1, 1, 1));
 		//static void DrawPoint();
 
-		static void SetRenderer(OGLRenderer* r) {
+		static void SetRenderer(RendererBase* r) {
 			renderer = r;
 		}
 
@@ -36,7 +42,9 @@ namespace NCL {
 		static std::vector<DebugStringEntry>	stringEntries;
 		static std::vector<DebugLineEntry>	lineEntries;
 
-		static OGLRenderer* renderer;
+		static std::mutex entryLock;
+
+		static RendererBase* renderer;
 	};
 }
 
@@ -0,0 +1,140 @@
+#include "FlowField.h"
+#include "BinaryHeap.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+const float FlowField::UNREACHABLE = std::numeric_limits<float>::max();
+
+/*
+Every move on the grid costs the same both ways, so searching outwards from
+the goal gives the cost of getting to it from every cell. Whenever a cell's
+cost goes down, it's because it has found a cheaper neighbour to go through,
+so once the search is over each cell's next cell is the first step of its
+cheapest way to the goal.
+*/
+FlowField::FlowField(const NavigationGrid& grid, int goalCell) : grid(grid), goal(goalCell) {
+	NCL_PROFILE_ZONE("Path::FlowFieldBuild");
+	version = grid.GetVersion();
+
+	int cellCount = grid.GetWidth() * grid.GetHeight();
+	costs.assign(cellCount, UNREACHABLE);
+	nextCells.assign(cellCount, -1);
+
+	if (goal < 0 || goal >= cellCount || !grid.IsWalkable(goal % grid.GetWidth(), goal / grid.GetWidth())) {
+		return;
+	}
+
+	IndexedMinHeap<float> openList(cellCount);
+	costs[goal] = 0.0f;
+	openList.Push(goal, 0.0f);
+
+	int		neighbours[8];
+	float	moveCosts[8];
+	while (!openList.Empty()) {
+		int		cell	= openList.Pop();
+		float	cost	= costs[cell];
+		int		count	= grid.GetNeighbours(cell, neighbours, moveCosts);
+
+		for (int i = 0; i < count; ++i) {
+			int		n		= neighbours[i];
+			float	newCost = cost + moveCosts[i];
+			if (newCost >= costs[n]) {
+				continue;
+			}
+			costs[n]		= newCost;
+			nextCells[n]	= cell;
+			if (openList.Contains(n)) {
+				openList.DecreaseKey(n, newCost);
+			}
+			else {
+				openList.Push(n, newCost);
+			}
+		}
+	}
+}
+
+FlowField::~FlowField() {
+}
+
+Vector3 FlowField::GetDirection(int cell) const {
+	if (cell < 0 || cell >= (int)nextCells.size() || nextCells[cell] < 0) {
+		return Vector3();
+	}
+	return (grid.GetNodePosition(nextCells[cell]) - grid.GetNodePosition(cell)).Normalised();
+}
+
+/*
+Heads for the middle of the next cell, rather than along the same line as
+GetDirection, so agents that aren't in the middle of their cell get pulled
+back onto the route instead of drifting along beside it. Diagonal moves
+are only allowed when the two cells beside them are both floor, so heading
+straight for the next cell from anywhere in this one never crosses a wall.
+*/
+Vector3 FlowField::Sample(const Vector3& position) const {
+	int cell = grid.GetNodeAt(position);
+	if (cell < 0 || cell >= (int)nextCells.size() || nextCells[cell] < 0) {
+		return Vector3();
+	}
+	Vector3 offset = grid.GetNodePosition(nextCells[cell]) - position;
+	offset.y = 0.0f;
+	return offset.Normalised();
+}
+
+FlowFieldCache::FlowFieldCache(const NavigationGrid& grid, size_t maxFields) : grid(grid), maxFields(std::max(maxFields, (size_t)1)) {
+	version = grid.GetVersion();
+}
+
+FlowFieldCache::~FlowFieldCache() {
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::GetField(const Vector3& goal) {
+	return GetFieldForCell(grid.GetNodeAt(goal));
+}
+
+/*
+The field's built while the cache is locked, so if lots of agents ask for
+a new goal on the same frame, it still only gets built the once.
+*/
+std::shared_ptr<const FlowField> FlowFieldCache::GetFieldForCell(int goalCell) {
+	static MetricCounter& builds	= Metrics::GetCounter("path.flowfield.builds");
+	static MetricCounter& hits		= Metrics::GetCounter("path.flowfield.hits");
+
+	if (goalCell < 0 || !grid.IsWalkable(goalCell % grid.GetWidth(), goalCell / grid.GetWidth())) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (version != grid.GetVersion()) {
+		fields.clear();
+		version = grid.GetVersion();
+	}
+	for (auto i = fields.begin(); i != fields.end(); ++i) {
+		if ((*i)->GetGoal() == goalCell) {
+			fields.splice(fields.begin(), fields, i);
+			hits.Add();
+			return fields.front();
+		}
+	}
+	if (fields.size() >= maxFields) {
+		fields.pop_back();
+	}
+	fields.emplace_front(new FlowField(grid, goalCell));
+	builds.Add();
+	return fields.front();
+}
+
+void FlowFieldCache::Invalidate() {
+	std::lock_guard<std::mutex> guard(lock);
+	fields.clear();
+}
+
+size_t FlowFieldCache::GetFieldCount() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return fields.size();
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+Class:FlowField
+Implements:
+Description:A flow field leads every cell of a NavigationGrid to a single goal.
+It's built by running Dijkstra outwards from the goal over the whole grid -
+the integration field, how much it costs to get from each cell to the goal -
+and each cell remembers which of its neighbours it was reached from, which
+is the next step on its cheapest way there. Moves cost the same as in the
+grid's own searches, so the steps are always along a shortest path.
+
+It costs about as much to build as a single long search, but after that any
+number of agents heading for the same goal can look up which way to go in
+constant time, wherever they are, without needing a NavigationPath each.
+
+FlowFieldCache keeps hold of the fields for the last few goals, and throws
+them all away once the grid changes. Fields never change once they're
+built, so an agent can hang on to one for as long as it likes.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "NavigationGrid.h"
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace NCL {
+	namespace CSC8503 {
+		class FlowField {
+		public:
+			FlowField(const NavigationGrid& grid, int goalCell);
+			~FlowField();
+
+			int GetGoal() const {
+				return goal;
+			}
+
+			//The version of the grid it was built from
+			unsigned int GetVersion() const {
+				return version;
+			}
+
+			bool IsReachable(int cell) const {
+				return cell >= 0 && cell < (int)costs.size() && costs[cell] < UNREACHABLE;
+			}
+
+			//How much it costs to get from the cell to the goal
+			float GetCost(int cell) const {
+				return costs[cell];
+			}
+
+			//The neighbour to step into next, or -1 at the goal itself, and
+			//anywhere the goal can't be reached from
+			int GetNextCell(int cell) const {
+				return nextCells[cell];
+			}
+
+			//Which way to go from the cell - zero at the goal, and anywhere
+			//the goal can't be reached from
+			Vector3 GetDirection(int cell) const;
+
+			//Which way to go from a position - towards the middle of the
+			//next cell from whichever cell it falls in. Zero in the goal's
+			//cell, and anywhere the goal can't be reached from
+			Vector3 Sample(const Vector3& position) const;
+
+			static const float UNREACHABLE;
+
+		protected:
+			const NavigationGrid&	grid;
+			int						goal;
+			unsigned int			version;
+
+			std::vector<float>		costs;
+			std::vector<int>		nextCells;
+		};
+
+		class FlowFieldCache {
+		public:
+			FlowFieldCache(const NavigationGrid& grid, size_t maxFields = 8);
+			~FlowFieldCache();
+
+			//The field for whichever cell the goal falls in, built if it isn't
+			//cached already. Null if the goal is off the grid, or in a wall.
+			//Safe to call from any number of threads at once, as long as
+			//none of them are changing the grid
+			std::shared_ptr<const FlowField> GetField(const Vector3& goal);
+			std::shared_ptr<const FlowField> GetFieldForCell(int goalCell);
+
+			//Throws away every field - only needed if the grid has changed
+			//some way GetVersion doesn't know about
+			void Invalidate();
+
+			size_t GetFieldCount() const;
+
+		protected:
+			const NavigationGrid&	grid;
+			size_t					maxFields;
+			unsigned int			version;
+
+			//Most recently used first
+			std::list<std::shared_ptr<const FlowField>> fields;
+			mutable std::mutex							lock;
+		};
+	}
+}
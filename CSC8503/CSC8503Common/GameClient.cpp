@@ -1,4 +1,5 @@
 #include "GameClient.h"
+#include "../../Common/Profiler.h"
 #include <iostream>
 #include <string>
 
@@ -29,6 +30,7 @@ void GameClient::UpdateClient() {
 	if (netHandle == nullptr) {
 		return;
 	}
+	NCL_PROFILE_ZONE("Net::ClientUpdate");
 	// Handle all incoming packets
 	ENetEvent event;
 	while (enet_host_service(netHandle, &event, 0) > 0) {
@@ -48,11 +50,13 @@ void GameClient::UpdateClient() {
 
 
 void GameClient::SendPacket(GamePacket&  payload) {
+	NCL_PROFILE_ZONE("Net::ClientSend");
 	ENetPacket * dataPacket = enet_packet_create(&payload, payload.GetTotalSize(), 0);
 	enet_peer_send(netPeer, 0, dataPacket);
 }
 
 void GameClient::ThreadedUpdate() {
+	Profiler::SetThreadName("Network Client");
 	while (threadAlive) {
 		UpdateClient();
 		std::this_thread::yield();
@@ -1,22 +1,70 @@
 #include "GameObject.h"
 #include "CollisionDetection.h"
+#include "GameWorld.h"
 
 using namespace NCL::CSC8503;
 
-GameObject::GameObject(string objectName)	{
-	name			= objectName;
+GameObject::GameObject(const string& objectName)	{
+	name			= objectName.c_str();
 	isActive		= true;
 	boundingVolume	= nullptr;
 	physicsObject	= nullptr;
 	renderObject	= nullptr;
 	networkObject	= nullptr;
+	world			= nullptr;
+	worldID			= -1;
 }
 
 GameObject::~GameObject()	{
 	delete boundingVolume;
+	delete networkObject;
+
+	//In a world, the world's pools own the components
+	if (!world) {
+		delete physicsObject;
+		delete renderObject;
+	}
+}
+
+/*
+The GameWorld keeps every physics and render component in its own pools, so
+once we're in a world, a new component gets built straight into them, in
+place of the old one. Until then, we own them ourselves.
+*/
+RenderObject* GameObject::SetRenderObject(RenderObject&& newObject) {
+	if (world) {
+		return world->SetRenderObject(this, std::move(newObject));
+	}
+	delete renderObject;
+	renderObject = new RenderObject(std::move(newObject));
+	return renderObject;
+}
+
+PhysicsObject* GameObject::SetPhysicsObject(PhysicsObject&& newObject) {
+	if (world) {
+		return world->SetPhysicsObject(this, std::move(newObject));
+	}
 	delete physicsObject;
+	physicsObject = new PhysicsObject(std::move(newObject));
+	return physicsObject;
+}
+
+void GameObject::RemoveRenderObject() {
+	if (world) {
+		world->RemoveRenderObject(this);
+		return;
+	}
 	delete renderObject;
-	delete networkObject;
+	renderObject = nullptr;
+}
+
+void GameObject::RemovePhysicsObject() {
+	if (world) {
+		world->RemovePhysicsObject(this);
+		return;
+	}
+	delete physicsObject;
+	physicsObject = nullptr;
 }
 
 bool GameObject::InsideAABB(const Vector3& boxPos, const Vector3& halfSize) {
@@ -5,6 +5,8 @@
 #include "PhysicsObject.h"
 #include "RenderObject.h"
 #include "NetworkObject.h"
+#include "../../Common/MemoryPool.h"
+#include "../../Common/MemoryArena.h"
 
 #include <vector>
 #include <bitset>
@@ -14,11 +16,14 @@ using std::vector;
 namespace NCL {
 	namespace CSC8503 {
 		class NetworkObject;
+		class GameWorld;
 
-		class GameObject	{
+		class GameObject : public PoolAllocated<GameObject>	{
 		public:
-			GameObject(string name = "");
-			~GameObject();
+			friend class GameWorld;
+
+			GameObject(const string& name = "");
+			virtual ~GameObject();
 
 			virtual void Update() {};
 
@@ -54,16 +59,36 @@ namespace NCL {
 				return networkObject;
 			}
 
-			void SetRenderObject(RenderObject* newObject) {
-				renderObject = newObject;
+			//Components are stored by value. In a world, they're built straight
+			//into its component pools - before that, they're kept on the heap,
+			//and moved into the pools when the object is added, so it's best
+			//to add the object first. Returns where the component ended up,
+			//which stays put until it's replaced or removed, or the object
+			//leaves the world
+			RenderObject* SetRenderObject(RenderObject&& newObject);
+
+			PhysicsObject* SetPhysicsObject(PhysicsObject&& newObject);
+
+			void RemoveRenderObject();
+
+			void RemovePhysicsObject();
+
+			int GetWorldID() const {
+				return worldID;
+			}
+
+			GameWorld* GetWorld() const {
+				return world;
 			}
 
-			void SetPhysicsObject(PhysicsObject* newObject) {
-				physicsObject = newObject;
+			//Set by the GameWorld when this object is added to / removed from it
+			void SetWorld(GameWorld* newWorld, int newID) {
+				world	= newWorld;
+				worldID = newID;
 			}
 
-			const string& GetName() const {
-				return name;
+			std::string GetName() const {
+				return std::string(name.c_str(), name.size());
 			}
 
 			virtual void OnCollisionBegin(GameObject* otherObject) {
@@ -89,8 +114,11 @@ namespace NCL {
 			RenderObject*		renderObject;
 			NetworkObject*		networkObject;
 
-			bool	isActive;
-			string	name;
+			bool		isActive;
+			LevelString	name;	//in the level arena, along with the object itself
+
+			GameWorld*	world;
+			int			worldID;
 
 			Vector3 broadphaseAABB;
 		};
@@ -1,5 +1,7 @@
 #include "GameServer.h"
 #include "GameWorld.h"
+#include "Metrics.h"
+#include "../../Common/Profiler.h"
 #include <iostream>
 
 using namespace NCL;
@@ -20,10 +22,16 @@ GameServer::~GameServer()	{
 }
 
 void GameServer::Shutdown() {
+	if (!netHandle) {
+		return;
+	}
 	SendGlobalPacket(BasicNetworkMessages::Shutdown);
+	enet_host_flush(netHandle);
 
 	threadAlive = false;
-	updateThread.join();
+	if (updateThread.joinable()) {
+		updateThread.join();
+	}
 
 	enet_host_destroy(netHandle);
 	netHandle = nullptr;
@@ -52,14 +60,29 @@ bool GameServer::SendGlobalPacket(int msgID) {
 }
 
 bool GameServer::SendGlobalPacket(GamePacket & packet) {
+	if (!netHandle) {
+		return false;
+	}
+	NCL_PROFILE_ZONE("Net::ServerSend");
+	static MetricCounter& packetsSent	= Metrics::GetCounter("net.server.packets_sent");
+	static MetricCounter& bytesSent		= Metrics::GetCounter("net.server.bytes_sent");
+
 	ENetPacket * dataPacket = enet_packet_create(&packet, packet.GetTotalSize(), 0);
 	enet_host_broadcast(netHandle, 0, dataPacket);
 
+	packetsSent.Add();
+	bytesSent.Add(packet.GetTotalSize());
+
 	return true;
 }
 
 void GameServer::UpdateServer() {
 	if (!netHandle) { return; }
+	NCL_PROFILE_ZONE("Net::ServerUpdate");
+	static MetricCounter&	packetsReceived = Metrics::GetCounter("net.server.packets_received");
+	static MetricCounter&	bytesReceived	= Metrics::GetCounter("net.server.bytes_received");
+	static MetricGauge&		clients			= Metrics::GetGauge("net.server.clients");
+
 	ENetEvent event;
 	while (enet_host_service(netHandle, &event, 0) > 0) {
 		int type = event.type;
@@ -76,10 +99,13 @@ void GameServer::UpdateServer() {
 		}
 		else if (type == ENetEventType::ENET_EVENT_TYPE_RECEIVE) {
 			GamePacket * packet = (GamePacket *)event.packet->data;
+			packetsReceived.Add();
+			bytesReceived.Add(event.packet->dataLength);
 			ProcessPacket(packet, peer);	
 		}
 		enet_packet_destroy(event.packet);
 	}
+	clients.Set(clientCount);
 }
 
 void GameServer::ThreadedUpdate() {
@@ -1,8 +1,14 @@
 #include "GameWorld.h"
 #include "GameObject.h"
 #include "CollisionDetection.h"
+#include "StateMachine.h"
+#include "Metrics.h"
 #include "../../Common/Camera.h"
+#include "../../Common/Profiler.h"
+#include "../../Common/MemoryArena.h"
 #include <algorithm>
+#include <iostream>
+#include <unordered_set>
 
 using namespace NCL;
 using namespace NCL::CSC8503;
@@ -11,35 +17,144 @@ GameWorld::GameWorld()	{
 	mainCamera = new Camera();
 
 	quadTree = nullptr;
+	jobs	 = nullptr;
 
 	shuffleConstraints	= false;
 	shuffleObjects		= false;
+	worldIDCounter		= 0;
+
+	transformOrderVersion	= -1;
+	transformOrderDirty		= true;
 }
 
 GameWorld::~GameWorld()	{
+	for (auto& i : gameObjects) {
+		DetachObject(i);
+	}
 }
 
 void GameWorld::Clear() {
+	for (auto& i : gameObjects) {
+		DetachObject(i);
+	}
 	gameObjects.clear();
 	constraints.clear(); // new line !
+	stateMachines.clear();
+
+	physicsComponents.Clear();
+	renderComponents.Clear();
+	worldIDCounter = 0;
+
+	transformOrder.clear();
+	transformSubtreeSizes.clear();
+	transformRoots.clear();
+	worldMatrices.clear();
+	transformOrderDirty = true;
 }
 
-void GameWorld::ClearAndErase() {
+bool GameWorld::ClearAndErase() {
 	for (auto& i : gameObjects) {
+		DetachObject(i);
 		delete i;
 	}
 	for (auto & i : constraints) {
 		delete i; // new for loop !
 	}
+	for (auto& i : stateMachines) {
+		delete i;
+	}
+	gameObjects.clear();
 	Clear();
+
+	return ReleaseLevelMemory();
+}
+
+/*
+Everything from this level has now gone back to the pools, so they can let
+go of their chunks, and the level arena can take the whole lot back in one
+go, rather than let it fragment the heap. Anything still alive - an object
+that outlived the level, or another world's - stops the arena from being
+reset. Freed memory still gets reused, so the arena doesn't keep growing,
+but it can't be handed back in one go, and that's almost always a leak, so
+it gets shouted about.
+*/
+bool GameWorld::ReleaseLevelMemory() {
+	static MetricCounter&	leaks		= Metrics::GetCounter("memory.level_leaks");
+	static MetricGauge&		levelBytes	= Metrics::GetGauge("memory.level_bytes");
+
+	MemoryArena& arena = MemoryArena::GetLevelArena();
+	levelBytes.Set((double)arena.GetBytesUsed());
+
+	size_t leakedObjects = MemoryPool::ReleaseUnusedPools();
+	if (arena.Reset()) {
+		return true;
+	}
+	leaks.Add(std::max(leakedObjects, (size_t)1));
+	std::cout << __FUNCTION__ << " can't reset the level arena - " << leakedObjects << " pooled objects and "
+		<< arena.GetLiveCount() << " allocations are still alive!" << std::endl;
+	return false;
 }
 
+/*
+Systems like the physics and the renderer only care about objects that have
+the relevant component, so rather than have them step through every object
+in the world and skip the ones that are missing it, we keep a pool of each
+component type, which owns every component of that type in the world.
+
+Components an object was given before it was added are moved into the
+pools, and the ones it had on the heap deleted - from then on, the object's
+pointers lead into the pools. Giving it components once it's in the world
+builds them straight into the pools instead.
+*/
 void GameWorld::AddGameObject(GameObject* o) {
 	gameObjects.emplace_back(o);
+	o->SetWorld(this, worldIDCounter++);
+
+	if (PhysicsObject* physics = o->physicsObject) {
+		o->physicsObject = physicsComponents.Insert(o->GetWorldID(), std::move(*physics), o);
+		delete physics;
+	}
+	if (RenderObject* render = o->renderObject) {
+		o->renderObject = renderComponents.Insert(o->GetWorldID(), std::move(*render), o);
+		delete render;
+	}
+	transformOrderDirty = true;
 }
 
 void GameWorld::RemoveGameObject(GameObject* o) {
-	std::remove(gameObjects.begin(), gameObjects.end(), o);
+	DetachObject(o);
+	transformOrderDirty = true;
+
+	gameObjects.erase(std::remove(gameObjects.begin(), gameObjects.end(), o), gameObjects.end());
+}
+
+PhysicsObject* GameWorld::SetPhysicsObject(GameObject* o, PhysicsObject&& p) {
+	o->physicsObject = physicsComponents.Insert(o->GetWorldID(), std::move(p), o);
+	return o->physicsObject;
+}
+
+RenderObject* GameWorld::SetRenderObject(GameObject* o, RenderObject&& r) {
+	o->renderObject = renderComponents.Insert(o->GetWorldID(), std::move(r), o);
+	return o->renderObject;
+}
+
+void GameWorld::RemovePhysicsObject(GameObject* o) {
+	physicsComponents.Remove(o->GetWorldID());
+	o->physicsObject = nullptr;
+}
+
+void GameWorld::RemoveRenderObject(GameObject* o) {
+	renderComponents.Remove(o->GetWorldID());
+	o->renderObject = nullptr;
+}
+
+//The pools own the components, so anything leaving the world leaves them
+//behind, rather than have them copied back out onto the heap
+void GameWorld::DetachObject(GameObject* o) {
+	RemovePhysicsObject(o);
+	RemoveRenderObject(o);
+	o->GetTransform().DetachWorldMatrix();
+	o->SetWorld(nullptr, -1);
 }
 
 void GameWorld::GetObjectIterators(
@@ -51,6 +166,7 @@ void GameWorld::GetObjectIterators(
 }
 
 void GameWorld::UpdateWorld(float dt) {
+	NCL_PROFILE_ZONE("World::Update");
 	UpdateTransforms();
 
 	if (shuffleObjects) {
@@ -63,13 +179,128 @@ void GameWorld::UpdateWorld(float dt) {
 }
 
 
+/*
+Transforms are updated parents first, so a child always sees its parent's
+new world matrix. Most of the world (all of the level geometry!) never
+moves, so anything that isn't dirty, and has nothing dirty below it, gets
+skipped over along with its whole subtree.
+
+Every world matrix lives in worldMatrices, in the same order as the
+transforms, and gets written straight into its slot - the renderer reads
+them from there, rather than copying them out of each object.
+*/
 void GameWorld::UpdateTransforms() {
+	NCL_PROFILE_ZONE("World::Transforms");
+	if (transformOrderDirty || transformOrderVersion != Transform::GetHierarchyVersion()) {
+		BuildTransformOrder();
+	}
+	//First, every local matrix that's out of date gets built in one batch.
+	//Without a parent, the local matrix is the world matrix, so it gets
+	//built straight into the world matrix's slot...
+	trsBatch.Clear();
+	batchedMatrices.clear();
+	size_t i = 0;
+	while (i < transformOrder.size()) {
+		Transform* t = transformOrder[i];
+		if (!t->IsDirty() && !t->HasDirtyChildren()) {
+			i += transformSubtreeSizes[i];
+			continue;
+		}
+		if (t->IsLocalDirty()) {
+			trsBatch.Add(t->localPosition, t->localOrientation, t->localScale);
+			batchedMatrices.emplace_back(t->parent ? &t->localMatrix : t->worldMatrix);
+			t->localDirty = false;
+		}
+		++i;
+	}
+	trsBatch.Compose(batchedMatrices.data());
+
+	//...then the ones with a parent get their world matrices, parents first.
+	//Nothing in one hierarchy touches another, so they can each go to a
+	//different worker
+	if (jobs) {
+		jobs->ParallelFor(transformRoots.size(), 64, [&](size_t start, size_t end) {
+			for (size_t r = start; r < end; ++r) {
+				UpdateSubtree(transformRoots[r]);
+			}
+		});
+	}
+	else {
+		for (size_t root : transformRoots) {
+			UpdateSubtree(root);
+		}
+	}
+}
+
+void GameWorld::UpdateSubtree(size_t root) {
+	size_t i	= root;
+	size_t end	= root + transformSubtreeSizes[root];
+	while (i < end) {
+		Transform* t = transformOrder[i];
+		if (!t->IsDirty() && !t->HasDirtyChildren()) {
+			i += transformSubtreeSizes[i];
+			continue;
+		}
+		if (t->worldDirty) {
+			if (t->parent) {
+				*t->worldMatrix		= t->parent->GetWorldMatrix() * t->localMatrix;
+				t->worldOrientation	= t->parent->GetWorldOrientation() * t->localOrientation;
+			}
+			else {
+				t->worldOrientation	= t->localOrientation;
+			}
+			t->worldDirty = false;
+		}
+		t->ClearDirtyChildren();
+		++i;
+	}
+}
+
+void GameWorld::BuildTransformOrder() {
+	transformOrder.clear();
+	transformSubtreeSizes.clear();
+	transformRoots.clear();
+
+	std::unordered_set<Transform*> inWorld;
+	for (auto& i : gameObjects) {
+		inWorld.insert(&i->GetTransform());
+	}
+	//Anything whose parent isn't in the world is treated as a root
 	for (auto& i : gameObjects) {
-		i->GetTransform().UpdateMatrices();
+		Transform* t = &i->GetTransform();
+		if (!t->GetParent() || inWorld.find(t->GetParent()) == inWorld.end()) {
+			transformRoots.emplace_back(transformOrder.size());
+			AddToTransformOrder(t);
+		}
+	}
+	//Children that aren't in the world themselves are updated along with
+	//their parents, but keep their own matrices - nothing here would know
+	//if they got deleted
+	std::vector<Matrix4> newMatrices(transformOrder.size());
+	for (size_t i = 0; i < transformOrder.size(); ++i) {
+		if (inWorld.find(transformOrder[i]) != inWorld.end()) {
+			transformOrder[i]->AttachWorldMatrix(&newMatrices[i]);
+		}
 	}
+	worldMatrices.swap(newMatrices);
+
+	transformOrderVersion	= Transform::GetHierarchyVersion();
+	transformOrderDirty		= false;
+}
+
+void GameWorld::AddToTransformOrder(Transform* t) {
+	size_t index = transformOrder.size();
+	transformOrder.emplace_back(t);
+	transformSubtreeSizes.emplace_back(1);
+
+	for (auto& i : t->GetChildren()) {
+		AddToTransformOrder(i);
+	}
+	transformSubtreeSizes[index] = (int)(transformOrder.size() - index);
 }
 
 void GameWorld::UpdateQuadTree() {
+	NCL_PROFILE_ZONE("World::QuadTree");
 	//delete quadTree;
 
 	//quadTree = new QuadTree<GameObject*>(Vector2(512, 512), 6);
@@ -147,4 +378,19 @@ void GameWorld::GetConstraintIterators(
 	std::vector<Constraint*>::const_iterator& last) const {
 	first	= constraints.begin();
 	last	= constraints.end();
+}
+
+void GameWorld::AddStateMachine(StateMachine* s) {
+	stateMachines.emplace_back(s);
+}
+
+void GameWorld::RemoveStateMachine(StateMachine* s) {
+	stateMachines.erase(std::remove(stateMachines.begin(), stateMachines.end(), s), stateMachines.end());
+}
+
+void GameWorld::GetStateMachineIterators(
+	std::vector<StateMachine*>::const_iterator& first,
+	std::vector<StateMachine*>::const_iterator& last) const {
+	first	= stateMachines.begin();
+	last	= stateMachines.end();
 }
\ No newline at end of file
@@ -3,12 +3,19 @@
 #include "Ray.h"
 #include "CollisionDetection.h"
 #include "QuadTree.h"
+#include "ComponentPool.h"
+#include "../../Common/TRSBatch.h"
+#include "../../Common/JobSystem.h"
 namespace NCL {
 		class Camera;
 		using Maths::Ray;
 	namespace CSC8503 {
 		class GameObject;
 		class Constraint;
+		class StateMachine;
+		class PhysicsObject;
+		class RenderObject;
+		class Transform;
 
 		class GameWorld	{
 		public:
@@ -16,14 +23,33 @@ namespace NCL {
 			~GameWorld();
 
 			void Clear();
-			void ClearAndErase();
+			//Deletes everything, and hands the level's memory back - returns
+			//false if some of it was still in use, so couldn't be
+			bool ClearAndErase();
 
 			void AddGameObject(GameObject* o);
+			//The object's physics and render components belong to the world,
+			//and are destroyed - the object itself is left to the caller
 			void RemoveGameObject(GameObject* o);
 
+			//Builds o's components straight into the world's pools - o must
+			//already be in this world. Use GameObject::SetPhysicsObject etc,
+			//which call these once the object's been added
+			PhysicsObject*	SetPhysicsObject(GameObject* o, PhysicsObject&& p);
+			RenderObject*	SetRenderObject(GameObject* o, RenderObject&& r);
+			void			RemovePhysicsObject(GameObject* o);
+			void			RemoveRenderObject(GameObject* o);
+
 			void AddConstraint(Constraint* c);
 			void RemoveConstraint(Constraint* c);
 
+			//State machines added here are updated as part of the AI phase -
+			//serially on the main thread, unless they've been marked as thread-
+			//safe, in which case they may be run in parallel, so should only
+			//touch their own object!
+			void AddStateMachine(StateMachine* s);
+			void RemoveStateMachine(StateMachine* s);
+
 			Camera* GetMainCamera() const {
 				return mainCamera;
 			}
@@ -41,6 +67,13 @@ namespace NCL {
 
 			virtual void UpdateWorld(float dt);
 
+			//Separate hierarchies have their transforms updated in parallel
+			//on the job system's workers. Without one, everything runs on
+			//the calling thread
+			void SetJobSystem(JobSystem* j) {
+				jobs = j;
+			}
+
 			void GetObjectIterators(
 				std::vector<GameObject*>::const_iterator& first,
 				std::vector<GameObject*>::const_iterator& last) const;
@@ -49,17 +82,66 @@ namespace NCL {
 				std::vector<Constraint*>::const_iterator& first,
 				std::vector<Constraint*>::const_iterator& last) const;
 
+			void GetStateMachineIterators(
+				std::vector<StateMachine*>::const_iterator& first,
+				std::vector<StateMachine*>::const_iterator& last) const;
+
+			ComponentPool<PhysicsObject>& GetPhysicsComponents() {
+				return physicsComponents;
+			}
+
+			const ComponentPool<PhysicsObject>& GetPhysicsComponents() const {
+				return physicsComponents;
+			}
+
+			const ComponentPool<RenderObject>& GetRenderComponents() const {
+				return renderComponents;
+			}
+
+			//The world matrix of every object in the world, in one block.
+			//Each object's Transform::GetWorldMatrix refers to its slot in
+			//here, until the object is removed from the world
+			const std::vector<Matrix4>& GetWorldMatrices() const {
+				return worldMatrices;
+			}
+
 		protected:
+			void DetachObject(GameObject* o);
+			bool ReleaseLevelMemory();
+
 			void UpdateTransforms();
+			void UpdateSubtree(size_t root);
+			void BuildTransformOrder();
+			void AddToTransformOrder(Transform* t);
 			void UpdateQuadTree();
 
 			std::vector<GameObject*> gameObjects;
 
 			std::vector<Constraint*> constraints;
 
+			std::vector<StateMachine*> stateMachines;
+
+			ComponentPool<PhysicsObject>	physicsComponents;
+			ComponentPool<RenderObject>		renderComponents;
+			int								worldIDCounter;
+
+			//Every transform in the world, parents first. Each entry's subtree
+			//is the next transformSubtreeSizes[i] entries, so it can be skipped
+			std::vector<Transform*>	transformOrder;
+			std::vector<int>		transformSubtreeSizes;
+			std::vector<size_t>		transformRoots;		//where each hierarchy starts in transformOrder
+			int						transformOrderVersion;
+			bool					transformOrderDirty;
+
+			std::vector<Matrix4>	worldMatrices;		//one per transformOrder entry
+
+			TRSBatch				trsBatch;
+			std::vector<Matrix4*>	batchedMatrices;	//where each matrix in the batch goes
+
 			QuadTree<GameObject*>* quadTree;
 
 			Camera* mainCamera;
+			JobSystem* jobs;
 
 			bool shuffleConstraints;
 			bool shuffleObjects;
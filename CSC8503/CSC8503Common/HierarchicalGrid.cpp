@@ -0,0 +1,447 @@
+#include "HierarchicalGrid.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//Entrances narrower than this get a single transition in the middle,
+	//wider ones get one at each end
+	const int SINGLE_TRANSITION_WIDTH = 6;
+}
+
+HierarchicalGrid::HierarchicalGrid(const NavigationGrid& grid, int clusterSize) : grid(grid), clusterSize(std::max(clusterSize, 2)) {
+	Build();
+}
+
+HierarchicalGrid::~HierarchicalGrid() {
+}
+
+void HierarchicalGrid::Build() {
+	NCL_PROFILE_ZONE("Path::HierarchicalBuild");
+	version		= grid.GetVersion();
+	clustersX	= (grid.GetWidth()	+ clusterSize - 1) / clusterSize;
+	clustersZ	= (grid.GetHeight() + clusterSize - 1) / clusterSize;
+
+	verticalBorders.assign(std::max(clustersX - 1, 0) * clustersZ, std::vector<Transition>());
+	horizontalBorders.assign(clustersX * std::max(clustersZ - 1, 0), std::vector<Transition>());
+	clusterNodes.assign(clustersX * clustersZ, std::vector<int>());
+	nodes.clear();
+	freeNodes.clear();
+	nodeAtCell.clear();
+
+	for (int cz = 0; cz < clustersZ; ++cz) {
+		for (int cx = 0; cx < clustersX; ++cx) {
+			if (cx < clustersX - 1) {
+				BuildBorder(verticalBorders[(cz * (clustersX - 1)) + cx], true, cx, cz);
+			}
+			if (cz < clustersZ - 1) {
+				BuildBorder(horizontalBorders[(cz * clustersX) + cx], false, cx, cz);
+			}
+		}
+	}
+	for (int c = 0; c < clustersX * clustersZ; ++c) {
+		UpdateNodes(c);
+	}
+	for (int c = 0; c < clustersX * clustersZ; ++c) {
+		ConnectNodes(c);
+	}
+}
+
+int HierarchicalGrid::ClusterOf(int cell) const {
+	int x = cell % grid.GetWidth();
+	int z = cell / grid.GetWidth();
+	return ((z / clusterSize) * clustersX) + (x / clusterSize);
+}
+
+//Calls func(border, clusterIsA) for each border the cluster has
+template<class Func>
+void HierarchicalGrid::ForEachBorder(int cluster, Func func) const {
+	int cx = cluster % clustersX;
+	int cz = cluster / clustersX;
+	if (cx > 0) {
+		func(verticalBorders[(cz * (clustersX - 1)) + cx - 1], false);
+	}
+	if (cx < clustersX - 1) {
+		func(verticalBorders[(cz * (clustersX - 1)) + cx], true);
+	}
+	if (cz > 0) {
+		func(horizontalBorders[((cz - 1) * clustersX) + cx], false);
+	}
+	if (cz < clustersZ - 1) {
+		func(horizontalBorders[(cz * clustersX) + cx], true);
+	}
+}
+
+//Finds each run of cells along the border that are open on both sides
+void HierarchicalGrid::BuildBorder(std::vector<Transition>& border, bool vertical, int cx, int cz) {
+	border.clear();
+
+	int width	= grid.GetWidth();
+	int length	= vertical ?
+		std::min(clusterSize, grid.GetHeight() - (cz * clusterSize)) :
+		std::min(clusterSize, grid.GetWidth() - (cx * clusterSize));
+
+	//The cells either side of the i'th place along the border
+	auto sideA = [&](int i) {
+		return vertical ?
+			(((cz * clusterSize) + i) * width) + ((cx + 1) * clusterSize) - 1 :
+			((((cz + 1) * clusterSize) - 1) * width) + (cx * clusterSize) + i;
+	};
+	auto sideB = [&](int i) {
+		return vertical ? sideA(i) + 1 : sideA(i) + width;
+	};
+	auto isOpen = [&](int i) {
+		int a = sideA(i);
+		int b = sideB(i);
+		return grid.IsWalkable(a % width, a / width) && grid.IsWalkable(b % width, b / width);
+	};
+
+	int i = 0;
+	while (i < length) {
+		if (!isOpen(i)) {
+			++i;
+			continue;
+		}
+		int start = i;
+		while (i < length && isOpen(i)) {
+			++i;
+		}
+		int end = i - 1;
+		if (end - start + 1 < SINGLE_TRANSITION_WIDTH) {
+			int middle = (start + end) / 2;
+			border.push_back({ sideA(middle), sideB(middle) });
+		}
+		else {
+			border.push_back({ sideA(start), sideB(start) });
+			border.push_back({ sideA(end), sideB(end) });
+		}
+	}
+}
+
+//Makes sure the cluster has a node for every transition cell on its
+//borders, and none for any that have gone. Nodes that are still needed keep
+//their index, as the clusters around might have edges to them
+void HierarchicalGrid::UpdateNodes(int cluster) {
+	std::vector<int> cells;
+	ForEachBorder(cluster, [&](const std::vector<Transition>& border, bool clusterIsA) {
+		for (const Transition& t : border) {
+			cells.push_back(clusterIsA ? t.a : t.b);
+		}
+	});
+	std::sort(cells.begin(), cells.end());
+	cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+	for (int n : clusterNodes[cluster]) {
+		if (!std::binary_search(cells.begin(), cells.end(), nodes[n].cell)) {
+			nodeAtCell.erase(nodes[n].cell);
+			nodes[n].cell = -1;
+			nodes[n].edges.clear();
+			freeNodes.push_back(n);
+		}
+	}
+	clusterNodes[cluster].clear();
+
+	for (int cell : cells) {
+		auto i = nodeAtCell.find(cell);
+		if (i != nodeAtCell.end()) {
+			clusterNodes[cluster].push_back(i->second);
+			continue;
+		}
+		int n;
+		if (!freeNodes.empty()) {
+			n = freeNodes.back();
+			freeNodes.pop_back();
+		}
+		else {
+			n = (int)nodes.size();
+			nodes.emplace_back();
+		}
+		nodes[n].cell		= cell;
+		nodeAtCell[cell]	= n;
+		clusterNodes[cluster].push_back(n);
+	}
+}
+
+//Edges across the borders are a single straight step; edges within the
+//cluster cost whatever a search of the cluster says they do
+void HierarchicalGrid::ConnectNodes(int cluster) {
+	PathSearchContext& context = PathSearchContext::ForThisThread();
+
+	for (int n : clusterNodes[cluster]) {
+		AbstractNode& node = nodes[n];
+		node.edges.clear();
+
+		ForEachBorder(cluster, [&](const std::vector<Transition>& border, bool clusterIsA) {
+			for (const Transition& t : border) {
+				if ((clusterIsA ? t.a : t.b) == node.cell) {
+					float cost = 0.5f * (grid.GetCellCost(t.a) + grid.GetCellCost(t.b));
+					node.edges.push_back({ nodeAtCell.at(clusterIsA ? t.b : t.a), cost });
+				}
+			}
+		});
+
+		SearchCluster(node.cell, -1, cluster, context);
+		for (int other : clusterNodes[cluster]) {
+			if (other != n && context.IsReached(nodes[other].cell)) {
+				node.edges.push_back({ other, context.GetCost(nodes[other].cell) });
+			}
+		}
+	}
+}
+
+void HierarchicalGrid::RebuildAround(int x, int z) {
+	NCL_PROFILE_ZONE("Path::HierarchicalRebuild");
+	int cx = x / clusterSize;
+	int cz = z / clusterSize;
+	if (x < 0 || z < 0 || cx >= clustersX || cz >= clustersZ) {
+		return;
+	}
+	int cluster = (cz * clustersX) + cx;
+
+	std::vector<int> affected = { cluster };
+	if (cx > 0) {
+		BuildBorder(verticalBorders[(cz * (clustersX - 1)) + cx - 1], true, cx - 1, cz);
+		affected.push_back(cluster - 1);
+	}
+	if (cx < clustersX - 1) {
+		BuildBorder(verticalBorders[(cz * (clustersX - 1)) + cx], true, cx, cz);
+		affected.push_back(cluster + 1);
+	}
+	if (cz > 0) {
+		BuildBorder(horizontalBorders[((cz - 1) * clustersX) + cx], false, cx, cz - 1);
+		affected.push_back(cluster - clustersX);
+	}
+	if (cz < clustersZ - 1) {
+		BuildBorder(horizontalBorders[(cz * clustersX) + cx], false, cx, cz);
+		affected.push_back(cluster + clustersX);
+	}
+	for (int c : affected) {
+		UpdateNodes(c);
+	}
+	for (int c : affected) {
+		ConnectNodes(c);
+	}
+}
+
+//Several changes in one cluster only need it rebuilt the once
+void HierarchicalGrid::Update() {
+	std::vector<int> changes;
+	if (!grid.GetChangesSince(version, changes)) {
+		Build();
+		return;
+	}
+	version = grid.GetVersion();
+
+	std::vector<int> clusters;
+	for (int cell : changes) {
+		clusters.push_back(ClusterOf(cell));
+	}
+	std::sort(clusters.begin(), clusters.end());
+	clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+
+	for (int c : clusters) {
+		RebuildAround((c % clustersX) * clusterSize, (c / clustersX) * clusterSize);
+	}
+}
+
+/*
+A search of the grid that never leaves the cluster. With a toCell it's an A*
+search that stops once it gets there, otherwise it's a Dijkstra search of
+the whole cluster, leaving the cost to every cell it can reach in the
+context.
+*/
+void HierarchicalGrid::SearchCluster(int fromCell, int toCell, int cluster, PathSearchContext& context) const {
+	int width	= grid.GetWidth();
+	int minX	= (cluster % clustersX) * clusterSize;
+	int minZ	= (cluster / clustersX) * clusterSize;
+	int maxX	= minX + clusterSize;
+	int maxZ	= minZ + clusterSize;
+
+	context.BeginSearch(width * grid.GetHeight());
+	context.Open(fromCell, PathSearchContext::NO_PARENT, 0.0f, toCell < 0 ? 0.0f : grid.GetCellDistance(fromCell, toCell));
+
+	int		neighbours[8];
+	float	costs[8];
+	while (context.HasOpenNodes()) {
+		int current = context.PopBestNode();
+		if (current == toCell) {
+			return;
+		}
+		float currentG	= context.GetCost(current);
+		int count		= grid.GetNeighbours(current, neighbours, costs);
+
+		for (int i = 0; i < count; ++i) {
+			int next	= neighbours[i];
+			int x		= next % width;
+			int z		= next / width;
+			if (x < minX || x >= maxX || z < minZ || z >= maxZ) {
+				continue;
+			}
+			float g = currentG + costs[i];
+			if (!context.IsReached(next) || (context.IsOpen(next) && g < context.GetCost(next))) {
+				context.Open(next, current, g, g + (toCell < 0 ? 0.0f : grid.GetCellDistance(next, toCell)));
+			}
+		}
+	}
+}
+
+/*
+The start and goal are linked into the graph with a search of their own
+clusters, but they're never added to it - they're just two extra node
+indices on the end, only known to this search, so that any number of
+searches can run at once.
+*/
+bool HierarchicalGrid::FindRoute(const Vector3& from, const Vector3& to, HierarchicalRoute& outRoute, PathSearchContext& context) const {
+	NCL_PROFILE_ZONE("Path::HierarchicalFindRoute");
+	outRoute.cells.clear();
+	outRoute.nextLeg = 1;
+
+	int width	= grid.GetWidth();
+	int start	= grid.GetNodeAt(from);
+	int goal	= grid.GetNodeAt(to);
+	if (start < 0 || goal < 0 || !grid.IsWalkable(start % width, start / width) || !grid.IsWalkable(goal % width, goal / width)) {
+		return false;
+	}
+	if (start == goal) {
+		outRoute.cells.push_back(start);
+		return true;
+	}
+	int startCluster	= ClusterOf(start);
+	int goalCluster		= ClusterOf(goal);
+
+	std::vector<Edge> startEdges;
+	SearchCluster(start, -1, startCluster, context);
+	for (int n : clusterNodes[startCluster]) {
+		if (context.IsReached(nodes[n].cell)) {
+			startEdges.push_back({ n, context.GetCost(nodes[n].cell) });
+		}
+	}
+	const int startNode = (int)nodes.size();
+	const int goalNode	= startNode + 1;
+
+	if (startCluster == goalCluster && context.IsReached(goal)) {
+		startEdges.push_back({ goalNode, context.GetCost(goal) });
+	}
+
+	std::vector<Edge> goalEdges; //from each node to the goal
+	SearchCluster(goal, -1, goalCluster, context);
+	for (int n : clusterNodes[goalCluster]) {
+		if (context.IsReached(nodes[n].cell)) {
+			goalEdges.push_back({ n, context.GetCost(nodes[n].cell) });
+		}
+	}
+
+	auto cellOf = [&](int n) {
+		return n == startNode ? start : n == goalNode ? goal : nodes[n].cell;
+	};
+
+	context.BeginSearch(goalNode + 1);
+	context.Open(startNode, PathSearchContext::NO_PARENT, 0.0f, grid.GetCellDistance(start, goal));
+
+	while (context.HasOpenNodes()) {
+		int current = context.PopBestNode();
+		if (current == goalNode) {
+			for (int n = goalNode; n != PathSearchContext::NO_PARENT; n = context.GetParent(n)) {
+				outRoute.cells.push_back(cellOf(n));
+			}
+			std::reverse(outRoute.cells.begin(), outRoute.cells.end());
+			return true;
+		}
+		float currentG = context.GetCost(current);
+
+		auto relax = [&](int next, float cost) {
+			float g = currentG + cost;
+			if (!context.IsReached(next) || (context.IsOpen(next) && g < context.GetCost(next))) {
+				context.Open(next, current, g, g + grid.GetCellDistance(cellOf(next), goal));
+			}
+		};
+		if (current == startNode) {
+			for (const Edge& e : startEdges) {
+				relax(e.to, e.cost);
+			}
+			continue;
+		}
+		for (const Edge& e : nodes[current].edges) {
+			relax(e.to, e.cost);
+		}
+		for (const Edge& e : goalEdges) {
+			if (e.to == current) {
+				relax(goalNode, e.cost);
+			}
+		}
+	}
+	return false;
+}
+
+//Appends the cells after fromCell, up to and including toCell. Each leg is
+//either a step over a border, or stays within a single cluster
+bool HierarchicalGrid::RefineLeg(int fromCell, int toCell, std::vector<int>& outCells, PathSearchContext& context) const {
+	int width	= grid.GetWidth();
+	int dx		= std::abs((toCell % width) - (fromCell % width));
+	int dz		= std::abs((toCell / width) - (fromCell / width));
+	if (dx + dz <= 1) {
+		if (dx + dz == 1) {
+			outCells.push_back(toCell);
+		}
+		return true;
+	}
+	SearchCluster(fromCell, toCell, ClusterOf(fromCell), context);
+	if (!context.IsReached(toCell)) {
+		return false;
+	}
+	size_t first = outCells.size();
+	for (int c = toCell; c != fromCell; c = context.GetParent(c)) {
+		outCells.push_back(c);
+	}
+	std::reverse(outCells.begin() + first, outCells.end());
+	return true;
+}
+
+bool HierarchicalGrid::RefineNextLeg(HierarchicalRoute& route, NavigationPath& outPath, PathSearchContext& context) const {
+	outPath.Clear();
+	if (route.IsFinished()) {
+		return false;
+	}
+	std::vector<int> cells;
+	if (!RefineLeg(route.cells[route.nextLeg - 1], route.cells[route.nextLeg], cells, context)) {
+		return false;
+	}
+	route.nextLeg++;
+	for (auto i = cells.rbegin(); i != cells.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNodePosition(*i));
+	}
+	return true;
+}
+
+bool HierarchicalGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	return FindPath(from, to, outPath, PathSearchContext::ForThisThread());
+}
+
+bool HierarchicalGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const {
+	NCL_PROFILE_ZONE("Path::HierarchicalFindPath");
+	static MetricCounter& queries	= Metrics::GetCounter("path.hpa.queries");
+	static MetricCounter& failures	= Metrics::GetCounter("path.hpa.failures");
+	queries.Add();
+
+	HierarchicalRoute route;
+	if (!FindRoute(from, to, route, context)) {
+		failures.Add();
+		return false;
+	}
+	std::vector<int> cells = { route.cells[0] };
+	for (size_t i = 1; i < route.cells.size(); ++i) {
+		if (!RefineLeg(route.cells[i - 1], route.cells[i], cells, context)) {
+			failures.Add();
+			return false;
+		}
+	}
+	for (auto i = cells.rbegin(); i != cells.rend(); ++i) {
+		outPath.PushWaypoint(grid.GetNodePosition(*i));
+	}
+	return true;
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+Class:HierarchicalGrid
+Implements:NavigationMap
+Description:Hierarchical pathfinding (HPA*) over a NavigationGrid. The grid is
+split into square clusters, and wherever two neighbouring clusters have open
+cells either side of the border between them, there's an entrance - a node
+each side, joined by a single step. Within each cluster, the cost between
+every pair of its entrance nodes is worked out up front, so the whole map
+boils down to a small graph of entrances that's quick to search.
+
+A search links the start and goal into that graph, by searching their own
+clusters, finds a route through it, and then fills in the cells between each
+pair of entrances - one cluster at a time, so a long route can be handed out
+a leg at a time as an agent needs it, rather than all at once (FindRoute and
+RefineNextLeg). FindPath does the lot in one go.
+
+The paths aren't always quite the shortest, as they have to go through the
+entrances, but long searches are far cheaper. Moves cost the same as in the
+grid's own searches.
+
+If a cell of the grid changes, RebuildAround fixes up just the cluster it's
+in, and its neighbours' entrances - or Update does that for every cell that
+has changed since it was last called. Neither is safe to call while searches
+are running.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "NavigationGrid.h"
+#include <vector>
+#include <unordered_map>
+
+namespace NCL {
+	namespace CSC8503 {
+		//A route through the entrances - the start cell, every entrance
+		//cell passed through, and the goal cell
+		struct HierarchicalRoute {
+			std::vector<int>	cells;
+			size_t				nextLeg;
+
+			HierarchicalRoute() : nextLeg(1) {}
+
+			bool IsFinished() const {
+				return nextLeg >= cells.size();
+			}
+		};
+
+		class HierarchicalGrid : public NavigationMap {
+		public:
+			HierarchicalGrid(const NavigationGrid& grid, int clusterSize = 16);
+			~HierarchicalGrid();
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const override;
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const;
+
+			int GetNodeAt(const Vector3& position) const override {
+				return grid.GetNodeAt(position);
+			}
+
+			bool FindRoute(const Vector3& from, const Vector3& to, HierarchicalRoute& outRoute, PathSearchContext& context) const;
+
+			//Replaces the contents of outPath with the waypoints of the next
+			//leg of the route. Returns false once the route is finished
+			bool RefineNextLeg(HierarchicalRoute& route, NavigationPath& outPath, PathSearchContext& context) const;
+
+			//Call after the cell at (x, z) has changed
+			void RebuildAround(int x, int z);
+
+			//Catches up with every change made to the grid since it was
+			//built, or last updated - rebuilding everything, if the grid
+			//can't say what changed
+			void Update();
+
+			int GetClusterSize() const {
+				return clusterSize;
+			}
+
+			int GetEntranceCount() const {
+				return (int)nodeAtCell.size();
+			}
+
+		protected:
+			struct Edge {
+				int		to;
+				float	cost;
+			};
+
+			struct AbstractNode {
+				int					cell;	//-1 if this slot is free
+				std::vector<Edge>	edges;
+			};
+
+			//A pair of cells either side of a border - a is the one in the
+			//cluster to the left or above
+			struct Transition {
+				int a;
+				int b;
+			};
+
+			void	Build();
+			int		ClusterOf(int cell) const;
+			void	BuildBorder(std::vector<Transition>& border, bool vertical, int cx, int cz);
+			void	UpdateNodes(int cluster);
+			void	ConnectNodes(int cluster);
+
+			template<class Func>
+			void	ForEachBorder(int cluster, Func func) const;
+
+			void	SearchCluster(int fromCell, int toCell, int cluster, PathSearchContext& context) const;
+			bool	RefineLeg(int fromCell, int toCell, std::vector<int>& outCells, PathSearchContext& context) const;
+
+			const NavigationGrid&	grid;
+			unsigned int			version;
+			int						clusterSize;
+			int						clustersX;
+			int						clustersZ;
+
+			//Between each cluster and the next one along (vertical) or down
+			//(horizontal)
+			std::vector<std::vector<Transition>>	verticalBorders;
+			std::vector<std::vector<Transition>>	horizontalBorders;
+
+			std::vector<AbstractNode>		nodes;
+			std::vector<int>				freeNodes;
+			std::vector<std::vector<int>>	clusterNodes;
+			std::unordered_map<int, int>	nodeAtCell;
+		};
+	}
+}
@@ -0,0 +1,233 @@
+#include "Metrics.h"
+#include "../../Common/GameTimer.h"
+#include <enet/enet.h>
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	std::mutex registryLock;
+	std::map<std::string, std::unique_ptr<MetricCounter>>	counters;
+	std::map<std::string, std::unique_ptr<MetricGauge>>		gauges;
+	std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+
+	std::ofstream	outputFile;
+	ENetSocket		outputSocket	= ENET_SOCKET_NULL;
+	ENetAddress		outputAddress;
+
+	float	outputInterval		= 0.0f;
+	float	timeSinceOutput		= 0.0f;
+	int		framesSinceOutput	= 0;
+	float	maxFrameTime		= 0.0f;	//milliseconds, since the last output
+	float	totalFrameTime		= 0.0f;
+
+	const int64_t startTime = GameTimer::GetNanoseconds();
+
+	bool HasOutput() {
+		return outputFile.is_open() || outputSocket != ENET_SOCKET_NULL;
+	}
+
+	template<class T>
+	T& FindOrAdd(std::map<std::string, std::unique_ptr<T>>& map, const std::string& name) {
+		std::lock_guard<std::mutex> guard(registryLock);
+		std::unique_ptr<T>& entry = map[name];
+		if (!entry) {
+			entry.reset(new T());
+		}
+		return *entry;
+	}
+
+	void WriteName(std::ostream& out, const std::string& name) {
+		out << '"';
+		for (char c : name) {
+			if (c == '"' || c == '\\') {
+				out << '\\';
+			}
+			out << c;
+		}
+		out << "\":";
+	}
+}
+
+MetricHistogram::MetricHistogram(const std::vector<double>& upperBounds) : bounds(upperBounds), count(0), sum(0.0) {
+	std::sort(bounds.begin(), bounds.end());
+	bins.reset(new std::atomic<int64_t>[bounds.size() + 1]);
+	for (size_t i = 0; i <= bounds.size(); ++i) {
+		bins[i] = 0;
+	}
+}
+
+void MetricHistogram::Record(double value) {
+	size_t bin = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+	bins[bin].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+
+	//No fetch_add for doubles until C++20...
+	double oldSum = sum.load(std::memory_order_relaxed);
+	while (!sum.compare_exchange_weak(oldSum, oldSum + value, std::memory_order_relaxed)) {
+	}
+}
+
+MetricCounter& Metrics::GetCounter(const std::string& name) {
+	return FindOrAdd(counters, name);
+}
+
+MetricGauge& Metrics::GetGauge(const std::string& name) {
+	return FindOrAdd(gauges, name);
+}
+
+MetricHistogram& Metrics::GetHistogram(const std::string& name, const std::vector<double>& upperBounds) {
+	std::lock_guard<std::mutex> guard(registryLock);
+	std::unique_ptr<MetricHistogram>& entry = histograms[name];
+	if (!entry) {
+		entry.reset(new MetricHistogram(upperBounds));
+	}
+	return *entry;
+}
+
+void Metrics::EndFrame(float dt) {
+	static MetricHistogram& frameTimes = GetHistogram("frame.ms", { 8.33, 16.67, 33.33, 50.0, 100.0 });
+
+	float frameTime = dt * 1000.0f;
+	frameTimes.Record(frameTime);
+
+	{
+		std::lock_guard<std::mutex> guard(registryLock);
+		for (auto& i : counters) {
+			MetricCounter& c = *i.second;
+			int64_t total	= c.GetTotal();
+			c.frameValue	= total - c.lastFrameTotal;
+			c.lastFrameTotal = total;
+			c.intervalMax	= std::max(c.intervalMax, c.frameValue);
+		}
+	}
+	framesSinceOutput++;
+	timeSinceOutput	+= dt;
+	totalFrameTime	+= frameTime;
+	maxFrameTime	= std::max(maxFrameTime, frameTime);
+
+	if (HasOutput() && timeSinceOutput >= outputInterval) {
+		Output();
+	}
+}
+
+bool Metrics::OutputToFile(const std::string& filename, float interval) {
+	CloseOutput();
+	outputFile.open(filename, std::ios::app);
+	outputInterval = interval;
+	return outputFile.is_open();
+}
+
+bool Metrics::OutputToSocket(int port, float interval) {
+	CloseOutput();
+	if (enet_initialize() != 0) {
+		return false;
+	}
+	outputSocket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+	if (outputSocket == ENET_SOCKET_NULL) {
+		enet_deinitialize();
+		return false;
+	}
+	enet_address_set_host(&outputAddress, "127.0.0.1");
+	outputAddress.port	= (enet_uint16)port;
+	outputInterval		= interval;
+	return true;
+}
+
+void Metrics::CloseOutput() {
+	if (outputFile.is_open()) {
+		outputFile.close();
+	}
+	if (outputSocket != ENET_SOCKET_NULL) {
+		enet_socket_destroy(outputSocket);
+		outputSocket = ENET_SOCKET_NULL;
+		enet_deinitialize();
+	}
+}
+
+void Metrics::Output() {
+	std::string line = BuildOutputLine();
+
+	if (outputFile.is_open()) {
+		outputFile << line << "\n";
+		outputFile.flush();
+	}
+	if (outputSocket != ENET_SOCKET_NULL) {
+		ENetBuffer buffer;
+		buffer.data			= (void*)line.data();
+		buffer.dataLength	= line.size();
+		enet_socket_send(outputSocket, &outputAddress, &buffer, 1);
+	}
+	timeSinceOutput		= 0.0f;
+	framesSinceOutput	= 0;
+	totalFrameTime		= 0.0f;
+	maxFrameTime		= 0.0f;
+}
+
+/*
+One line looks like:
+{"time":12.5,"frames":60,"frame_ms":{"mean":16.6,"max":21.3},
+ "counters":{"physics.contacts":{"total":9000,"interval":1200,"last_frame":20,"max_frame":35},...},
+ "gauges":{"net.server.clients":2,...},
+ "histograms":{"path.nodes_expanded":{"bounds":[16,64],"bins":[3,1,0],"count":4,"sum":90},...}}
+*/
+std::string Metrics::BuildOutputLine() {
+	std::ostringstream out;
+	out << "{\"time\":" << (GameTimer::GetNanoseconds() - startTime) / 1e9
+		<< ",\"frames\":" << framesSinceOutput
+		<< ",\"frame_ms\":{\"mean\":" << (framesSinceOutput ? totalFrameTime / framesSinceOutput : 0.0f)
+		<< ",\"max\":" << maxFrameTime << "}";
+
+	std::lock_guard<std::mutex> guard(registryLock);
+
+	out << ",\"counters\":{";
+	bool first = true;
+	for (auto& i : counters) {
+		MetricCounter& c = *i.second;
+		int64_t total = c.GetTotal();
+		out << (first ? "" : ",");
+		WriteName(out, i.first);
+		out << "{\"total\":" << total
+			<< ",\"interval\":" << total - c.lastOutputTotal
+			<< ",\"last_frame\":" << c.frameValue
+			<< ",\"max_frame\":" << c.intervalMax << "}";
+		c.lastOutputTotal	= total;
+		c.intervalMax		= 0;
+		first = false;
+	}
+
+	out << "},\"gauges\":{";
+	first = true;
+	for (auto& i : gauges) {
+		out << (first ? "" : ",");
+		WriteName(out, i.first);
+		out << i.second->Get();
+		first = false;
+	}
+
+	out << "},\"histograms\":{";
+	first = true;
+	for (auto& i : histograms) {
+		MetricHistogram& h = *i.second;
+		out << (first ? "" : ",");
+		WriteName(out, i.first);
+		out << "{\"bounds\":[";
+		for (size_t b = 0; b < h.bounds.size(); ++b) {
+			out << (b ? "," : "") << h.bounds[b];
+		}
+		out << "],\"bins\":[";
+		for (size_t b = 0; b <= h.bounds.size(); ++b) {
+			out << (b ? "," : "") << h.bins[b].exchange(0, std::memory_order_relaxed);
+		}
+		out << "],\"count\":"	<< h.count.exchange(0, std::memory_order_relaxed)
+			<< ",\"sum\":"		<< h.sum.exchange(0.0, std::memory_order_relaxed) << "}";
+		first = false;
+	}
+	out << "}}";
+	return out.str();
+}
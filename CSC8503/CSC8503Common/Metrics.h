@@ -0,0 +1,135 @@
+/******************************************************************************
+Class:Metrics
+Implements:
+Description:A registry of named runtime metrics, for keeping an eye on how much
+work the game is doing without needing a profiler attached:
+
+Counters count things that happen - pairs tested, packets sent, paths found.
+They only ever go up, and the registry works out how much they went up by
+in each frame.
+
+Gauges hold a value that goes up and down - how many clients are connected,
+how many objects were drawn.
+
+Histograms count how many recorded values fell into each of a fixed set of
+bins - useful for things like path lengths, where the spread matters more
+than the average.
+
+Everything is looked up by name, and the lookup takes a lock, so keep hold of
+the reference rather than looking it up every time - a function level static
+is the easiest way. Updating a metric is lock free, so it's fine from any
+thread.
+
+Once a frame, call EndFrame. If an output file or socket has been set, every
+interval a line of JSON gets written out with everything in the registry:
+counter totals, along with how much they went up by in the interval and in
+the busiest frame of it; gauge values; and histogram bins, which are then
+emptied out ready for the next interval. Lining the max frame time up with
+the max per frame counts should point out what made a frame spike.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		class MetricCounter {
+		public:
+			MetricCounter() : total(0), lastFrameTotal(0), lastOutputTotal(0), frameValue(0), intervalMax(0) {}
+
+			void Add(int64_t amount = 1) {
+				total.fetch_add(amount, std::memory_order_relaxed);
+			}
+
+			int64_t GetTotal() const {
+				return total.load(std::memory_order_relaxed);
+			}
+
+			//How much it went up by in the last frame
+			int64_t GetFrameValue() const {
+				return frameValue;
+			}
+
+		protected:
+			friend class Metrics;
+			std::atomic<int64_t> total;
+
+			//Only touched by EndFrame
+			int64_t lastFrameTotal;
+			int64_t lastOutputTotal;
+			int64_t frameValue;
+			int64_t intervalMax;
+		};
+
+		class MetricGauge {
+		public:
+			MetricGauge() : value(0.0) {}
+
+			void Set(double v) {
+				value.store(v, std::memory_order_relaxed);
+			}
+
+			double Get() const {
+				return value.load(std::memory_order_relaxed);
+			}
+
+		protected:
+			std::atomic<double> value;
+		};
+
+		class MetricHistogram {
+		public:
+			//Bin i counts values <= upperBounds[i] (and above the bin before);
+			//there's always one more bin on the end for anything larger
+			MetricHistogram(const std::vector<double>& upperBounds);
+
+			void Record(double value);
+
+			const std::vector<double>& GetBounds() const {
+				return bounds;
+			}
+
+		protected:
+			friend class Metrics;
+			std::vector<double>						bounds;
+			std::unique_ptr<std::atomic<int64_t>[]>	bins;
+			std::atomic<int64_t>					count;
+			std::atomic<double>						sum;
+		};
+
+		class Metrics {
+		public:
+			static MetricCounter&	GetCounter(const std::string& name);
+			static MetricGauge&		GetGauge(const std::string& name);
+			//The bounds are only used the first time a name is seen
+			static MetricHistogram& GetHistogram(const std::string& name, const std::vector<double>& upperBounds);
+
+			//dt is in seconds, as passed to UpdateGame
+			static void EndFrame(float dt);
+
+			//Appends a JSON line to the file every interval seconds - an
+			//interval of 0 writes out every frame
+			static bool OutputToFile(const std::string& filename, float interval);
+
+			//Sends each JSON line as a UDP packet to localhost:port instead
+			static bool OutputToSocket(int port, float interval);
+
+			static void CloseOutput();
+
+			//Writes out a line now, whether the interval is up or not
+			static void Output();
+
+		protected:
+			static std::string BuildOutputLine();
+		};
+	}
+}
@@ -0,0 +1,555 @@
+#include "NavigationBaker.h"
+#include "NavigationGrid.h"
+#include "NavigationMesh.h"
+#include "../../Common/Maths.h"
+#include "../../Common/Profiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//Cuts away the part of the polygon on one side of an axis aligned line
+	//- keeping the part where the axis is above value, or below it. Points
+	//right on the line are cut away too, so a wall lying along the line
+	//between two columns doesn't go in either of them - the box it's the
+	//side of fills in the columns it's really in
+	void ClipPolygon(const std::vector<Vector3>& in, std::vector<Vector3>& out, int axis, float value, bool keepAbove) {
+		out.clear();
+		for (size_t i = 0; i < in.size(); ++i) {
+			const Vector3& a = in[i];
+			const Vector3& b = in[(i + 1) % in.size()];
+			float da = (a[axis] - value) * (keepAbove ? 1.0f : -1.0f);
+			float db = (b[axis] - value) * (keepAbove ? 1.0f : -1.0f);
+
+			if (da > 0.0f) {
+				out.push_back(a);
+			}
+			if ((da > 0.0f) != (db > 0.0f) && da != db) {
+				out.push_back(a + ((b - a) * (da / (da - db))));
+			}
+		}
+	}
+}
+
+NavigationBaker::NavigationBaker(const NavigationBakeSettings& settings) : settings(settings) {
+	width		= 0;
+	depth		= 0;
+	regionCount = 0;
+}
+
+NavigationBaker::~NavigationBaker() {
+}
+
+void NavigationBaker::AddTriangles(const std::vector<Vector3>& positions, const std::vector<unsigned int>& indices, const Matrix4& transform) {
+	int object = triangleObjects.empty() ? 0 : triangleObjects.back() + 1;
+	if (indices.empty()) {
+		for (size_t i = 0; i + 2 < positions.size(); i += 3) {
+			triangles.push_back(transform * positions[i]);
+			triangles.push_back(transform * positions[i + 1]);
+			triangles.push_back(transform * positions[i + 2]);
+			triangleObjects.push_back(object);
+		}
+		return;
+	}
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		triangles.push_back(transform * positions[indices[i]]);
+		triangles.push_back(transform * positions[indices[i + 1]]);
+		triangles.push_back(transform * positions[indices[i + 2]]);
+		triangleObjects.push_back(object);
+	}
+}
+
+void NavigationBaker::AddBox(const Vector3& position, const Vector3& halfSize) {
+	std::vector<Vector3> corners;
+	for (int i = 0; i < 8; ++i) {
+		corners.push_back(position + Vector3(
+			(i & 1) ? halfSize.x : -halfSize.x,
+			(i & 2) ? halfSize.y : -halfSize.y,
+			(i & 4) ? halfSize.z : -halfSize.z));
+	}
+	//Wound anticlockwise from outside, like a mesh, so the bottom faces
+	//down and the top faces up
+	const std::vector<unsigned int> faces = {
+		0, 1, 5, 0, 5, 4,	//bottom
+		2, 7, 3, 2, 6, 7,	//top
+		0, 4, 6, 0, 6, 2,	//left
+		1, 3, 7, 1, 7, 5,	//right
+		0, 2, 3, 0, 3, 1,	//back
+		4, 5, 7, 4, 7, 6	//front
+	};
+	AddTriangles(corners, faces, Matrix4());
+}
+
+bool NavigationBaker::Bake() {
+	return BakeRegions(nullptr);
+}
+
+bool NavigationBaker::Bake(const Vector3& start) {
+	return BakeRegions(&start);
+}
+
+bool NavigationBaker::BakeRegions(const Vector3* start) {
+	NCL_PROFILE_ZONE("Nav::Bake");
+	width		= 0;
+	depth		= 0;
+	regionCount = 0;
+	spans.clear();
+	allFloors.clear();
+	columnFloors.clear();
+	floors.clear();
+
+	if (triangles.empty()) {
+		return false;
+	}
+	boundsMin = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+	boundsMax = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const Vector3& v : triangles) {
+		for (int i = 0; i < 3; ++i) {
+			boundsMin[i] = std::min(boundsMin[i], v[i]);
+			boundsMax[i] = std::max(boundsMax[i], v[i]);
+		}
+	}
+	width	= std::max((int)std::ceil((boundsMax.x - boundsMin.x) / settings.cellSize), 1);
+	depth	= std::max((int)std::ceil((boundsMax.z - boundsMin.z) / settings.cellSize), 1);
+	spans.resize(width * depth);
+
+	for (size_t i = 0; i < triangles.size(); i += 3) {
+		Rasterise(triangles[i], triangles[i + 1], triangles[i + 2], triangleObjects[i / 3]);
+	}
+	MergeSpans();
+	FindFloors();
+	regionCount = FloodRegions();
+
+	//The region to keep - whichever has the floor closest under the start,
+	//or the one with the most floors
+	int keep = -1;
+	if (start) {
+		int x = (int)std::floor((start->x - boundsMin.x) / settings.cellSize);
+		int z = (int)std::floor((start->z - boundsMin.z) / settings.cellSize);
+		if (x >= 0 && x < width && z >= 0 && z < depth) {
+			int column		= (z * width) + x;
+			float closest	= FLT_MAX;
+			for (int f = columnFloors[column]; f < columnFloors[column + 1]; ++f) {
+				float distance = std::abs(start->y - (boundsMin.y + (allFloors[f].top * settings.cellHeight)));
+				if (distance < closest) {
+					closest = distance;
+					keep	= allFloors[f].region;
+				}
+			}
+		}
+	}
+	else {
+		std::vector<int> sizes(regionCount, 0);
+		for (const Floor& f : allFloors) {
+			sizes[f.region]++;
+		}
+		if (regionCount > 0) {
+			keep = (int)(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+		}
+	}
+
+	floors.assign(width * depth, -1);
+	for (int c = 0; c < width * depth; ++c) {
+		for (int f = columnFloors[c]; f < columnFloors[c + 1]; ++f) {
+			if (allFloors[f].region == keep) {
+				floors[c] = allFloors[f].top;
+				break; //floors go upwards, so this is the lowest
+			}
+		}
+	}
+	Erode();
+	return std::any_of(floors.begin(), floors.end(), [](int f) { return f >= 0; });
+}
+
+/*
+The triangle is clipped to each column it might touch, and whatever's left
+of it gives the span's height. Steep triangles only make walls, and ones
+facing down are the undersides of something solid.
+*/
+void NavigationBaker::Rasterise(const Vector3& a, const Vector3& b, const Vector3& c, int object) {
+	Vector3 normal		= Vector3::Cross(b - a, c - a);
+	float	length		= normal.Length();
+	if (length <= 0.0f) {
+		return;
+	}
+	float	up			= normal.y / length;
+	bool	walkable	= up >= std::cos(DegreesToRadians(settings.maxSlope));
+	int		facing		= up > 1e-3f ? 1 : (up < -1e-3f ? -1 : 0);
+
+	float	cs		= settings.cellSize;
+	int		minX	= std::max((int)std::floor((std::min(a.x, std::min(b.x, c.x)) - boundsMin.x) / cs), 0);
+	int		maxX	= std::min((int)std::floor((std::max(a.x, std::max(b.x, c.x)) - boundsMin.x) / cs), width - 1);
+	int		minZ	= std::max((int)std::floor((std::min(a.z, std::min(b.z, c.z)) - boundsMin.z) / cs), 0);
+	int		maxZ	= std::min((int)std::floor((std::max(a.z, std::max(b.z, c.z)) - boundsMin.z) / cs), depth - 1);
+
+	std::vector<Vector3> row;
+	std::vector<Vector3> cell;
+	std::vector<Vector3> temp;
+	std::vector<Vector3> triangle = { a, b, c };
+
+	for (int z = minZ; z <= maxZ; ++z) {
+		float z0 = boundsMin.z + (z * cs);
+		ClipPolygon(triangle, temp, 2, z0, true);
+		ClipPolygon(temp, row, 2, z0 + cs, false);
+		if (row.empty()) {
+			continue;
+		}
+		for (int x = minX; x <= maxX; ++x) {
+			float x0 = boundsMin.x + (x * cs);
+			ClipPolygon(row, temp, 0, x0, true);
+			ClipPolygon(temp, cell, 0, x0 + cs, false);
+			if (cell.empty()) {
+				continue;
+			}
+			float low	= FLT_MAX;
+			float high	= -FLT_MAX;
+			for (const Vector3& v : cell) {
+				low		= std::min(low, v.y);
+				high	= std::max(high, v.y);
+			}
+			Span s;
+			s.bottom	= (int)std::floor((low	- boundsMin.y) / settings.cellHeight);
+			s.top		= (int)std::ceil((high	- boundsMin.y) / settings.cellHeight);
+			s.walkable	= walkable;
+			s.facing	= facing;
+			s.object	= object;
+			spans[(z * width) + x].push_back(s);
+		}
+	}
+}
+
+/*
+Only the surfaces of the geometry get rasterised, so a box is just its top
+and bottom in most columns - an underside is filled up to the next surface
+above it that faces up, to make it solid again. That surface has to be from
+the same object, or anything sunk into a floor would only be filled up to
+the top of the floor, leaving the rest of it hollow.
+
+Then overlapping spans become one span. If their tops are close enough to
+step between, the top's walkable if either was, otherwise it's whatever the
+higher one was - so a wall that reaches above a floor hides it.
+*/
+void NavigationBaker::MergeSpans() {
+	int climb = (int)std::floor(settings.maxClimb / settings.cellHeight);
+
+	for (std::vector<Span>& column : spans) {
+		if (column.empty()) {
+			continue;
+		}
+		std::sort(column.begin(), column.end(), [](const Span& a, const Span& b) {
+			return a.bottom < b.bottom;
+		});
+		for (size_t i = 0; i < column.size(); ++i) {
+			if (column[i].facing >= 0) {
+				continue;
+			}
+			for (size_t j = i + 1; j < column.size(); ++j) {
+				if (column[j].facing > 0 && column[j].object == column[i].object) {
+					column[i].top = std::max(column[i].top, column[j].top);
+					break;
+				}
+			}
+		}
+		std::vector<Span> merged;
+		merged.push_back(column[0]);
+		for (size_t i = 1; i < column.size(); ++i) {
+			Span& last		= merged.back();
+			const Span& s	= column[i];
+			if (s.bottom > last.top) {
+				merged.push_back(s);
+				continue;
+			}
+			if (std::abs(s.top - last.top) <= climb) {
+				last.walkable = last.walkable || s.walkable;
+			}
+			else if (s.top > last.top) {
+				last.walkable = s.walkable;
+			}
+			last.top = std::max(last.top, s.top);
+		}
+		column.swap(merged);
+	}
+}
+
+void NavigationBaker::FindFloors() {
+	int height = (int)std::ceil(settings.agentHeight / settings.cellHeight);
+
+	columnFloors.assign((width * depth) + 1, 0);
+	for (int c = 0; c < width * depth; ++c) {
+		columnFloors[c] = (int)allFloors.size();
+		const std::vector<Span>& column = spans[c];
+		for (size_t i = 0; i < column.size(); ++i) {
+			Floor f;
+			f.column	= c;
+			f.top		= column[i].top;
+			f.ceiling	= i + 1 < column.size() ? column[i + 1].bottom : INT_MAX;
+			f.region	= -1;
+			if (column[i].walkable && f.ceiling - f.top >= height) {
+				allFloors.push_back(f);
+			}
+		}
+	}
+	columnFloors.back() = (int)allFloors.size();
+}
+
+bool NavigationBaker::CanStep(const Floor& from, const Floor& to) const {
+	int climb	= (int)std::floor(settings.maxClimb / settings.cellHeight);
+	int height	= (int)std::ceil(settings.agentHeight / settings.cellHeight);
+
+	return std::abs(from.top - to.top) <= climb
+		&& std::min(from.ceiling, to.ceiling) - std::max(from.top, to.top) >= height;
+}
+
+int NavigationBaker::FloodRegions() {
+	const int dx[4] = { 1, -1, 0,  0 };
+	const int dz[4] = { 0,  0, 1, -1 };
+
+	int					regions = 0;
+	std::vector<int>	open;
+	for (size_t i = 0; i < allFloors.size(); ++i) {
+		if (allFloors[i].region >= 0) {
+			continue;
+		}
+		allFloors[i].region = regions;
+		open.push_back((int)i);
+		while (!open.empty()) {
+			const Floor& f = allFloors[open.back()];
+			open.pop_back();
+
+			int x = f.column % width;
+			int z = f.column / width;
+			for (int d = 0; d < 4; ++d) {
+				int nx = x + dx[d];
+				int nz = z + dz[d];
+				if (nx < 0 || nx >= width || nz < 0 || nz >= depth) {
+					continue;
+				}
+				int column = (nz * width) + nx;
+				for (int n = columnFloors[column]; n < columnFloors[column + 1]; ++n) {
+					if (allFloors[n].region < 0 && CanStep(f, allFloors[n])) {
+						allFloors[n].region = regions;
+						open.push_back(n);
+					}
+				}
+			}
+		}
+		regions++;
+	}
+	return regions;
+}
+
+/*
+A column is only kept if an agent stood in the middle of it wouldn't
+overlap any column that isn't walkable, or the edge of the map.
+*/
+void NavigationBaker::Erode() {
+	float	cs		= settings.cellSize;
+	float	radius	= settings.agentRadius;
+	int		reach	= (int)std::ceil(radius / cs);
+
+	std::vector<int> eroded(floors);
+	for (int z = 0; z < depth; ++z) {
+		for (int x = 0; x < width; ++x) {
+			if (floors[(z * width) + x] < 0) {
+				continue;
+			}
+			for (int oz = -reach; oz <= reach && eroded[(z * width) + x] >= 0; ++oz) {
+				for (int ox = -reach; ox <= reach; ++ox) {
+					if (IsWalkable(x + ox, z + oz)) {
+						continue;
+					}
+					float gapX = std::max((std::abs(ox) * cs) - (cs * 0.5f), 0.0f);
+					float gapZ = std::max((std::abs(oz) * cs) - (cs * 0.5f), 0.0f);
+					if ((gapX * gapX) + (gapZ * gapZ) < radius * radius) {
+						eroded[(z * width) + x] = -1;
+						break;
+					}
+				}
+			}
+		}
+	}
+	floors.swap(eroded);
+}
+
+float NavigationBaker::FloorHeight(int column) const {
+	return boundsMin.y + (floors[column] * settings.cellHeight);
+}
+
+/*
+Nodes are in the middle of their cells, and the cells cover the bounds of the
+geometry - node (0, 0) is in the corner at the lowest x and highest z, as
+rows go towards -z. Each node is whatever was baked at its centre, and the
+nodes sit at the height of the lowest floor.
+*/
+bool NavigationBaker::SampleGrid(int nodeSize, int& outWidth, int& outHeight, Vector3& outOrigin, std::vector<bool>& outWalkable) const {
+	outWidth	= 0;
+	outHeight	= 0;
+	outWalkable.clear();
+	if (floors.empty() || nodeSize < 1) {
+		return false;
+	}
+	float lowest = FLT_MAX;
+	for (int c = 0; c < width * depth; ++c) {
+		if (floors[c] >= 0) {
+			lowest = std::min(lowest, FloorHeight(c));
+		}
+	}
+	outWidth	= std::max((int)std::ceil((boundsMax.x - boundsMin.x) / nodeSize), 1);
+	outHeight	= std::max((int)std::ceil((boundsMax.z - boundsMin.z) / nodeSize), 1);
+	outOrigin	= Vector3(boundsMin.x + (nodeSize * 0.5f), lowest == FLT_MAX ? boundsMin.y : lowest, boundsMax.z - (nodeSize * 0.5f));
+	outWalkable.assign(outWidth * outHeight, false);
+
+	bool anyWalkable = false;
+	for (int gz = 0; gz < outHeight; ++gz) {
+		for (int gx = 0; gx < outWidth; ++gx) {
+			float	worldX	= outOrigin.x + (gx * nodeSize);
+			float	worldZ	= outOrigin.z - (gz * nodeSize);
+			int		x		= (int)std::floor((worldX - boundsMin.x) / settings.cellSize);
+			int		z		= (int)std::floor((worldZ - boundsMin.z) / settings.cellSize);
+			if (IsWalkable(x, z)) {
+				outWalkable[(gz * outWidth) + gx] = true;
+				anyWalkable = true;
+			}
+		}
+	}
+	return anyWalkable;
+}
+
+bool NavigationBaker::WriteGrid(std::ostream& output, int nodeSize) const {
+	int					gridWidth;
+	int					gridHeight;
+	Vector3				origin;
+	std::vector<bool>	walkable;
+	if (!SampleGrid(nodeSize, gridWidth, gridHeight, origin, walkable)) {
+		return false;
+	}
+	output << nodeSize << "\n" << gridWidth << "\n" << gridHeight << "\n";
+	output << "origin " << origin.x << " " << origin.y << " " << origin.z << "\n";
+	for (int gz = 0; gz < gridHeight; ++gz) {
+		for (int gx = 0; gx < gridWidth; ++gx) {
+			output << (walkable[(gz * gridWidth) + gx] ? '.' : 'x');
+		}
+		output << "\n";
+	}
+	return true;
+}
+
+//Same grid as WriteGrid, but made straight into a NavigationGrid
+bool NavigationBaker::WriteBinaryGrid(std::ostream& output, int nodeSize) const {
+	int					gridWidth;
+	int					gridHeight;
+	Vector3				origin;
+	std::vector<bool>	walkable;
+	if (!SampleGrid(nodeSize, gridWidth, gridHeight, origin, walkable)) {
+		return false;
+	}
+	NavigationGrid grid(gridWidth, gridHeight, nodeSize, origin, walkable);
+	grid.WriteGrid(output);
+	return true;
+}
+
+/*
+Rectangles are grown greedily - as far along x as they'll go, then as far
+along z as the whole width allows. Wherever one rectangle's corner lies on
+another's side, it's added to that side too, so that neighbours always share
+a whole edge, which is how NavigationMesh knows they're neighbours.
+*/
+void NavigationBaker::BuildMesh(std::vector<Vector3>& outVertices, std::vector<std::vector<int>>& outPolygons, int maxSide) const {
+	outVertices.clear();
+	outPolygons.clear();
+	maxSide = std::min(std::max(maxSide, 1), NavigationMesh::MAX_SIDES / 4);
+
+	struct Rect {
+		int x0, z0, x1, z1;	//corners, in grid points
+	};
+	std::vector<Rect>	rects;
+	std::vector<bool>	covered(width * depth, false);
+	for (int z = 0; z < depth; ++z) {
+		for (int x = 0; x < width; ++x) {
+			if (covered[(z * width) + x] || !IsWalkable(x, z)) {
+				continue;
+			}
+			int x1 = x + 1;
+			while (x1 < width && x1 - x < maxSide && IsWalkable(x1, z) && !covered[(z * width) + x1]) {
+				x1++;
+			}
+			int z1 = z + 1;
+			while (z1 < depth && z1 - z < maxSide) {
+				bool rowFree = true;
+				for (int i = x; i < x1 && rowFree; ++i) {
+					rowFree = IsWalkable(i, z1) && !covered[(z1 * width) + i];
+				}
+				if (!rowFree) {
+					break;
+				}
+				z1++;
+			}
+			for (int j = z; j < z1; ++j) {
+				for (int i = x; i < x1; ++i) {
+					covered[(j * width) + i] = true;
+				}
+			}
+			rects.push_back({ x, z, x1, z1 });
+		}
+	}
+
+	int pointsX = width + 1;
+	std::vector<bool>	isCorner(pointsX * (depth + 1), false);
+	std::vector<int>	vertexAt(pointsX * (depth + 1), -1);
+	for (const Rect& r : rects) {
+		isCorner[(r.z0 * pointsX) + r.x0] = true;
+		isCorner[(r.z0 * pointsX) + r.x1] = true;
+		isCorner[(r.z1 * pointsX) + r.x0] = true;
+		isCorner[(r.z1 * pointsX) + r.x1] = true;
+	}
+
+	//A grid point's height is the average of the floors around it
+	auto vertexIndex = [&](int px, int pz) {
+		int& index = vertexAt[(pz * pointsX) + px];
+		if (index < 0) {
+			float	height	= 0.0f;
+			int		count	= 0;
+			for (int z = pz - 1; z <= pz; ++z) {
+				for (int x = px - 1; x <= px; ++x) {
+					if (IsWalkable(x, z)) {
+						height += FloorHeight((z * width) + x);
+						count++;
+					}
+				}
+			}
+			index = (int)outVertices.size();
+			outVertices.push_back(Vector3(boundsMin.x + (px * settings.cellSize), height / std::max(count, 1), boundsMin.z + (pz * settings.cellSize)));
+		}
+		return index;
+	};
+
+	for (const Rect& r : rects) {
+		std::vector<int> polygon;
+		for (int x = r.x0; x < r.x1; ++x) {
+			if (x == r.x0 || isCorner[(r.z0 * pointsX) + x]) {
+				polygon.push_back(vertexIndex(x, r.z0));
+			}
+		}
+		for (int z = r.z0; z < r.z1; ++z) {
+			if (z == r.z0 || isCorner[(z * pointsX) + r.x1]) {
+				polygon.push_back(vertexIndex(r.x1, z));
+			}
+		}
+		for (int x = r.x1; x > r.x0; --x) {
+			if (x == r.x1 || isCorner[(r.z1 * pointsX) + x]) {
+				polygon.push_back(vertexIndex(x, r.z1));
+			}
+		}
+		for (int z = r.z1; z > r.z0; --z) {
+			if (z == r.z1 || isCorner[(z * pointsX) + r.x0]) {
+				polygon.push_back(vertexIndex(r.x0, z));
+			}
+		}
+		outPolygons.push_back(polygon);
+	}
+}
@@ -0,0 +1,155 @@
+/******************************************************************************
+Class:NavigationBaker
+Implements:
+Description:Works out where agents can walk, from a level's static collision
+geometry, and turns it into a NavigationGrid file or a NavigationMesh, so
+that maps don't have to be drawn out by hand.
+
+It works much like Recast. The level is voxelised: it's cut into columns,
+cellSize across, and each triangle adds a solid span to every column it
+passes through, from the lowest to the highest point of the triangle in
+that column, rounded out to cellHeight. Triangles facing down are taken to
+be the underside of something solid, and their spans are filled up to the
+next surface above them that faces up and belongs to the same object, so
+meshes need to be closed, with the usual anticlockwise winding - but they
+can overlap, or be sunk into each other. The top of a span is a floor if
+the triangle it came from isn't too steep, and there's room for an agent to
+stand on it before the next span up.
+
+Floors in neighbouring columns are joined if an agent could step between
+them - they're no more than maxClimb apart, and there's room overhead - and
+the joined up floors are split into regions. Only one region is kept: the
+one the start position is in, or otherwise the biggest, which throws away
+the tops of boxes, and anywhere else agents can't get to. Lastly the edges
+are eroded by the agent's radius, so agents following a path don't scrape
+along walls.
+
+The grids and meshes are flat, so if there are floors above each other in
+the kept region, only the lowest is used.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "../../Common/Vector3.h"
+#include "../../Common/Matrix4.h"
+#include <vector>
+#include <ostream>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		struct NavigationBakeSettings {
+			float cellSize;		//width and depth of each column
+			float cellHeight;	//what span heights are rounded to
+			float agentHeight;
+			float agentRadius;
+			float maxClimb;		//the highest step an agent can go up
+			float maxSlope;		//in degrees
+
+			NavigationBakeSettings() {
+				cellSize	= 1.0f;
+				cellHeight	= 0.25f;
+				agentHeight = 2.0f;
+				agentRadius = 0.5f;
+				maxClimb	= 0.5f;
+				maxSlope	= 45.0f;
+			}
+		};
+
+		class NavigationBaker {
+		public:
+			NavigationBaker(const NavigationBakeSettings& settings = NavigationBakeSettings());
+			~NavigationBaker();
+
+			//Triangles as in a MeshGeometry - if there are no indices, every
+			//three positions are a triangle. Each call adds one object
+			void AddTriangles(const std::vector<Vector3>& positions, const std::vector<unsigned int>& indices, const Matrix4& transform);
+
+			//An axis aligned box, as made by TutorialGame's AddCubeToWorld
+			//and AddFloorToWorld
+			void AddBox(const Vector3& position, const Vector3& halfSize);
+
+			//Returns false if there's nothing walkable
+			bool Bake();
+			bool Bake(const Vector3& start);
+
+			int GetWidth() const {
+				return width;
+			}
+			int GetDepth() const {
+				return depth;
+			}
+			bool IsWalkable(int x, int z) const {
+				return x >= 0 && x < width && z >= 0 && z < depth && floors[(z * width) + x] >= 0;
+			}
+			int GetRegionCount() const {
+				return regionCount;
+			}
+
+			//In the NavigationGrid text format, with an origin line, so the
+			//grid covers the whole of the baked area wherever it is. Returns
+			//false, and writes nothing, if none of the nodes are walkable -
+			//if nodeSize is much bigger than the gaps between walls, say
+			bool WriteGrid(std::ostream& output, int nodeSize) const;
+			//As above, in the NavigationGrid binary format
+			bool WriteBinaryGrid(std::ostream& output, int nodeSize) const;
+
+			//Covers the walkable columns with rectangles, no more than
+			//maxSide columns across, ready to make a NavigationMesh from.
+			//Each side of a rectangle can pick up a vertex per column from
+			//its neighbours, so maxSide is capped at a quarter of
+			//NavigationMesh::MAX_SIDES, to keep the mesh writable
+			void BuildMesh(std::vector<Vector3>& outVertices, std::vector<std::vector<int>>& outPolygons, int maxSide = 32) const;
+
+		protected:
+			struct Span {
+				int		bottom;
+				int		top;
+				bool	walkable;
+				int		facing;		//1 up, -1 down, 0 for walls
+				int		object;
+			};
+
+			//Somewhere an agent could stand - the top of a span, and the
+			//bottom of the next one up
+			struct Floor {
+				int column;
+				int top;
+				int ceiling;
+				int region;
+			};
+
+			bool	BakeRegions(const Vector3* start);
+			void	Rasterise(const Vector3& a, const Vector3& b, const Vector3& c, int object);
+			void	MergeSpans();
+			void	FindFloors();
+			bool	CanStep(const Floor& from, const Floor& to) const;
+			int		FloodRegions();
+			void	Erode();
+
+			float	FloorHeight(int column) const;
+			bool	SampleGrid(int nodeSize, int& outWidth, int& outHeight, Vector3& outOrigin, std::vector<bool>& outWalkable) const;
+
+			NavigationBakeSettings		settings;
+			std::vector<Vector3>		triangles;
+			std::vector<int>			triangleObjects;	//which AddTriangles call each came from
+
+			Vector3						boundsMin;
+			Vector3						boundsMax;
+			int							width;
+			int							depth;
+
+			std::vector<std::vector<Span>>	spans;			//per column
+			std::vector<Floor>				allFloors;
+			std::vector<int>				columnFloors;	//the first of each column's floors, in allFloors
+			int								regionCount;
+
+			//The height of each column's floor, in cells, or -1
+			std::vector<int>				floors;
+		};
+	}
+}
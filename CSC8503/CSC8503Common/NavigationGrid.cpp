@@ -1,7 +1,17 @@
 #include "NavigationGrid.h"
 #include "../../Common/Assets.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
 
 #include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 using namespace NCL;
 using namespace CSC8503;
@@ -14,160 +24,676 @@ const int BOTTOM_NODE	= 3;
 const char WALL_NODE	= 'x';
 const char FLOOR_NODE	= '.';
 
+namespace {
+	//The first 4 directions are straight, the rest diagonal
+	const int DIR_X[8] = { 1, -1, 0,  0, 1, -1,  1, -1 };
+	const int DIR_Z[8] = { 0,  0, 1, -1, 1,  1, -1, -1 };
+
+	const float SQRT2 = 1.41421356f;
+
+	//Only this many changes are remembered for GetChangesSince - anything
+	//that falls further behind has to rebuild from scratch
+	const size_t MAX_CHANGE_LOG = 4096;
+
+	const uint32_t GRID_VERSION		= 1;
+	const uint32_t GRID_HAS_COSTS	= 1;
+
+	struct GridHeader {
+		char		magic[4];
+		uint32_t	version;
+		uint32_t	flags;
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	nodeSize;
+		float		origin[3];
+	};
+	static_assert(sizeof(GridHeader) == 36, "GridHeader has to match the file format");
+
+	size_t WalkBytes(size_t cellCount) {
+		return (cellCount + 7) / 8;
+	}
+
+	bool IsBinaryGrid(const char* data, size_t size) {
+		return size >= 4 && std::memcmp(data, "NAVG", 4) == 0;
+	}
+
+	template<class T>
+	void WriteValue(std::ostream& output, const T& value) {
+		output.write((const char*)&value, sizeof(T));
+	}
+
+	int Sign(int v) {
+		return (v > 0) - (v < 0);
+	}
+
+	int DirectionOf(int dx, int dz) {
+		for (int i = 0; i < 8; ++i) {
+			if (DIR_X[i] == dx && DIR_Z[i] == dz) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	//The exact cost of the cheapest route between two cells with no walls
+	//in the way - octile distance if diagonals are allowed, otherwise
+	//manhattan distance
+	float GridDistance(int ax, int az, int bx, int bz, bool diagonal) {
+		int dx = std::abs(ax - bx);
+		int dz = std::abs(az - bz);
+		if (!diagonal) {
+			return (float)(dx + dz);
+		}
+		return (float)std::abs(dx - dz) + SQRT2 * std::min(dx, dz);
+	}
+
+	void RecordQuery(bool found, int nodesExpanded) {
+		static MetricCounter&	queries		= Metrics::GetCounter("path.queries");
+		static MetricCounter&	failures	= Metrics::GetCounter("path.failures");
+		static MetricHistogram& expanded	= Metrics::GetHistogram("path.nodes_expanded", { 16, 64, 256, 1024, 4096, 16384 });
+
+		queries.Add();
+		if (!found) {
+			failures.Add();
+		}
+		expanded.Record(nodesExpanded);
+	}
+}
+
 NavigationGrid::NavigationGrid()	{
 	nodeSize	= 0;
 	gridWidth	= 0;
 	gridHeight	= 0;
-	allNodes	= nullptr;
+	walkBits	= nullptr;
+	cellCosts	= nullptr;
+
+	searchType		= GridSearchType::AStar;
+	diagonalMoves	= false;
+	version			= 0;
+	changeLogStart	= 0;
 }
 
+/*
+Binary grids are mapped, and used straight from the file - nothing is read
+until a search touches it, and every process on the machine that loads the
+same grid shares the one copy of it.
+*/
 NavigationGrid::NavigationGrid(const std::string&filename) : NavigationGrid() {
-	std::ifstream infile(Assets::DATADIR + filename);
+	std::string path = Assets::DATADIR + filename;
+
+	std::unique_ptr<MappedFile> file(new MappedFile(path));
+	if (file->IsOpen() && IsBinaryGrid(file->GetData(), file->GetSize())) {
+		if (UseBinaryGrid(file->GetData(), file->GetSize())) {
+			mappedFile = std::move(file);
+		}
+		return;
+	}
+	std::ifstream infile(path, std::ios::binary);
+	LoadGrid(infile);
+}
+
+NavigationGrid::NavigationGrid(std::istream& input) : NavigationGrid() {
+	LoadGrid(input);
+}
 
+NavigationGrid::NavigationGrid(int width, int height, int nodeSize, const Vector3& origin, const std::vector<bool>& walkable) : NavigationGrid() {
+	if (width < 1 || height < 1 || nodeSize < 1 || walkable.size() != (size_t)width * height) {
+		std::cout << "NavigationGrid is the wrong size!" << std::endl;
+		return;
+	}
+	this->nodeSize	= nodeSize;
+	this->origin	= origin;
+	gridWidth		= width;
+	gridHeight		= height;
+
+	walkData.assign(WalkBytes(width * height), 0);
+	for (int cell = 0; cell < width * height; ++cell) {
+		if (walkable[cell]) {
+			walkData[cell >> 3] |= (unsigned char)(1 << (cell & 7));
+		}
+	}
+	walkBits = walkData.data();
+}
+
+//Text grids always start with a number, so only binary ones start with N
+void NavigationGrid::LoadGrid(std::istream& input) {
+	if (input.peek() != 'N') {
+		LoadTextGrid(input);
+		return;
+	}
+	std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	if (!IsBinaryGrid(data.data(), data.size())) {
+		std::cout << "File is not a NavigationGrid file!" << std::endl;
+		return;
+	}
+	if (UseBinaryGrid(data.data(), data.size())) {
+		walkData.assign(walkBits, walkBits + WalkBytes(gridWidth * gridHeight));
+		walkBits = walkData.data();
+		if (cellCosts) {
+			costData.assign(cellCosts, cellCosts + (gridWidth * gridHeight));
+			cellCosts = costData.data();
+		}
+	}
+}
+
+void NavigationGrid::LoadTextGrid(std::istream& infile) {
 	infile >> nodeSize;
 	infile >> gridWidth;
 	infile >> gridHeight;
 
-	allNodes = new GridNode[gridWidth * gridHeight];
+	if (!infile || nodeSize < 1 || gridWidth < 1 || gridHeight < 1) {
+		std::cout << "NavigationGrid file is damaged!" << std::endl;
+		nodeSize = gridWidth = gridHeight = 0;
+		return;
+	}
+	origin = Vector3(-100, 0, 100);
 
-	for (int y = 0; y < gridHeight; ++y) {
-		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];
-			char type = 0;
-			infile >> type;
-			n.type = type;
-			n.position = Vector3(x * nodeSize, 0, -y * nodeSize);
-			n.position += Vector3(-100, 0, 100);
+	//Optionally followed by where node (0, 0) is
+	infile >> std::ws;
+	if (infile.peek() == 'o') {
+		std::string word;
+		infile >> word >> origin.x >> origin.y >> origin.z;
+		if (!infile || word != "origin") {
+			std::cout << "NavigationGrid file is damaged!" << std::endl;
+			nodeSize = gridWidth = gridHeight = 0;
+			return;
 		}
 	}
-	
-	//now to build the connectivity between the nodes
-	for (int y = 0; y < gridHeight; ++y) {
-		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];		
 
-			if (y > 0) { //get the above node
-				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
-			}
-			if (y < gridHeight - 1) { //get the below node
-				n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
-			}
-			if (x > 0) { //get left node
-				n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
-			}
-			if (x < gridWidth - 1) { //get right node
-				n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
-			}
-			for (int i = 0; i < 4; ++i) {
-				if (n.connected[i]) {
-					if (n.connected[i]->type == '.') {
-						n.costs[i]		= 1;
-					}
-					if (n.connected[i]->type == 'x') {
-						n.connected[i] = nullptr; //actually a wall, disconnect!
-					}
-				}
-			}
-		}	
+	walkData.assign(WalkBytes(gridWidth * gridHeight), 0);
+	for (int cell = 0; cell < gridWidth * gridHeight; ++cell) {
+		char type = 0;
+		infile >> type;
+		if (type != WALL_NODE) {
+			walkData[cell >> 3] |= (unsigned char)(1 << (cell & 7));
+		}
+	}
+	walkBits = walkData.data();
+}
+
+//Points the grid at the cells in data, which has to stay around for as long
+//as the grid does
+bool NavigationGrid::UseBinaryGrid(const char* data, size_t size) {
+	GridHeader header;
+	if (size < sizeof(GridHeader)) {
+		std::cout << "NavigationGrid file is damaged!" << std::endl;
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(GridHeader));
+	if (header.version != GRID_VERSION) {
+		std::cout << "NavigationGrid file has incompatible version!" << std::endl;
+		return false;
+	}
+	uint64_t cellCount = (uint64_t)header.width * header.height;
+	if (header.width == 0 || header.height == 0 || header.nodeSize == 0 || header.nodeSize > INT_MAX || cellCount > INT_MAX) {
+		std::cout << "NavigationGrid file is damaged!" << std::endl;
+		return false;
+	}
+	size_t walkBytes = WalkBytes((size_t)cellCount);
+	size_t costBytes = (header.flags & GRID_HAS_COSTS) ? (size_t)cellCount : 0;
+	if (size - sizeof(GridHeader) < walkBytes + costBytes) {
+		std::cout << "NavigationGrid file is damaged!" << std::endl;
+		return false;
+	}
+	nodeSize	= (int)header.nodeSize;
+	gridWidth	= (int)header.width;
+	gridHeight	= (int)header.height;
+	origin		= Vector3(header.origin[0], header.origin[1], header.origin[2]);
+
+	walkBits	= (const unsigned char*)data + sizeof(GridHeader);
+	cellCosts	= costBytes > 0 ? walkBits + walkBytes : nullptr;
+	return true;
+}
+
+void NavigationGrid::WriteGrid(std::ostream& output) const {
+	if (!IsLoaded()) {
+		return;
+	}
+	int cellCount = gridWidth * gridHeight;
+
+	output.write("NAVG", 4);
+	WriteValue(output, GRID_VERSION);
+	WriteValue(output, cellCosts ? GRID_HAS_COSTS : (uint32_t)0);
+	WriteValue(output, (uint32_t)gridWidth);
+	WriteValue(output, (uint32_t)gridHeight);
+	WriteValue(output, (uint32_t)nodeSize);
+	WriteValue(output, origin.x);
+	WriteValue(output, origin.y);
+	WriteValue(output, origin.z);
+
+	output.write((const char*)walkBits, WalkBytes(cellCount));
+	if (cellCosts) {
+		for (int i = 0; i < cellCount; ++i) {
+			WriteValue(output, (uint8_t)GetCellCost(i));
+		}
 	}
 }
 
 NavigationGrid::~NavigationGrid()	{
-	delete[] allNodes;
 }
 
-bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	return FindPath(from, to, outPath, PathSearchContext::ForThisThread());
+}
+
+bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const {
+	NCL_PROFILE_ZONE("Path::GridFindPath");
 	// need to work out which node from  sits in , and to  sits in
-	int fromX = (from.x / nodeSize);
-	int fromZ = (from.z / nodeSize);
-	
-	int toX = (to.x / nodeSize);
-	int toZ = (to.z / nodeSize);
-	
-	if (fromX < 0 || fromX > gridWidth - 1 || fromZ < 0 || fromZ > gridHeight - 1) {
+	int startIndex	= GetNodeAt(from);
+	int endIndex	= GetNodeAt(to);
+
+	if (startIndex < 0 || endIndex < 0) {
+		RecordQuery(false, 0);
 		return false; // outside of map region !
 	}
-	
-	if (toX < 0 || toX > gridWidth - 1 || toZ < 0 || toZ > gridHeight - 1) {
-		return false; // outside of map region !
+
+	//The grid itself is never written to - the costs, parents and open
+	//list all live in the context
+	bool found = searchType == GridSearchType::JumpPoint && !HasCellCosts() ?
+		JumpPointSearch(startIndex, endIndex, context) :
+		AStarSearch(startIndex, endIndex, context);
+
+	if (found) {
+		int node = endIndex;
+		while (node != PathSearchContext::NO_PARENT) {
+			outPath.PushWaypoint(GetNodePosition(node));
+			node = context.GetParent(node); // Build up the waypoints
+		}
 	}
+	RecordQuery(found, context.GetNodesExpanded());
+	return found;
+}
 
-	GridNode * startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode * endNode = &allNodes[(toZ * gridWidth) + toX];
-	
-	std::vector < GridNode * > openList;
-	std::vector < GridNode * > closedList;
-	
-	openList.emplace_back(startNode);
-	
-	startNode->f = 0;
-	startNode->g = 0;
-	startNode->parent = nullptr;
-	
-	GridNode * currentBestNode = nullptr;
-	while (!openList.empty()) {
-		currentBestNode = RemoveBestNode(openList);
-		
-		if (currentBestNode == endNode) {// we ve found the path !
-			GridNode * node = endNode;
-			while (node != nullptr) {
-				outPath.PushWaypoint(node->position);
-				node = node->parent; // Build up the waypoints
-			}
+bool NavigationGrid::AStarSearch(int startIndex, int endIndex, PathSearchContext& context) const {
+	context.BeginSearch(gridWidth * gridHeight);
+	context.Open(startIndex, PathSearchContext::NO_PARENT, 0.0f, GetCellDistance(startIndex, endIndex));
+
+	int		neighbours[8];
+	float	costs[8];
+	while (context.HasOpenNodes()) {
+		int currentIndex = context.PopBestNode();
+
+		if (currentIndex == endIndex) {// we ve found the path !
 			return true;
 		}
-		else {
-			for (int i = 0; i < 4; ++i) {
-				GridNode * neighbour = currentBestNode->connected[i];
-				if (!neighbour) { // might not be connected ...
-					continue;
-				}
-				bool inClosed = NodeInList(neighbour, closedList);
-				if (inClosed) {
-					continue; // already discarded this neighbour ...
-				}
-				
-				float h = Heuristic(neighbour, endNode);
-				float g = currentBestNode->g + currentBestNode->costs[i];
-				float f = h + g;
-				
-				bool inOpen = NodeInList(neighbour, openList);
-				
-				if (!inOpen) { // first time we ve seen this neighbour
-					openList.emplace_back(neighbour);
-				}
-				// might be a better route to this node !
-				if (!inOpen || f < neighbour->f) {
-					neighbour->parent = currentBestNode;
-					neighbour->f = f;
-					neighbour->g = g;
-				}
-				
+		float	currentG	= context.GetCost(currentIndex);
+		int		count		= GetNeighbours(currentIndex, neighbours, costs);
+
+		for (int i = 0; i < count; ++i) {
+			int neighbourIndex = neighbours[i];
+
+			float g = currentG + costs[i];
+
+			if (!context.IsReached(neighbourIndex) // first time we ve seen this neighbour
+				|| (context.IsOpen(neighbourIndex) && g < context.GetCost(neighbourIndex))) { // might be a better route to this node !
+				context.Open(neighbourIndex, currentIndex, g, g + GetCellDistance(neighbourIndex, endIndex));
 			}
-			closedList.emplace_back(currentBestNode);
+			//otherwise it's already closed, and been discarded
 		}
 	}
 	return false; // open list emptied out with no path !
 }
 
-bool NavigationGrid::NodeInList(GridNode* n, std::vector<GridNode*>& list) const {
-	std::vector <GridNode*>::iterator i = std::find(list.begin(), list.end(), n);
-	return i == list.end() ? false : true;
+/*
+Jump Point Search. Each node taken off the open list only looks in the
+directions a shortest path could carry on in, given the direction it was
+arrived from, and in each of those it jumps along until it finds a cell
+worth stopping at - the goal, or somewhere a wall ends, and so a shortest
+path might turn the corner. Every cell jumped over in between is never
+added to the open list at all.
+
+Without diagonal moves, a vertical jump also stops anywhere a horizontal
+jump from it would find something, as does a diagonal jump with diagonal
+moves on for both of its straight parts - otherwise those paths would be
+missed. Diagonals never cut the corner of a wall, as in the A* search.
+*/
+bool NavigationGrid::JumpPointSearch(int startIndex, int endIndex, PathSearchContext& context) const {
+	int goalX = endIndex % gridWidth;
+	int goalZ = endIndex / gridWidth;
+
+	context.BeginSearch(gridWidth * gridHeight);
+	context.Open(startIndex, PathSearchContext::NO_PARENT, 0.0f,
+		GridDistance(startIndex % gridWidth, startIndex / gridWidth, goalX, goalZ, diagonalMoves));
+
+	while (context.HasOpenNodes()) {
+		int current = context.PopBestNode();
+		if (current == endIndex) {
+			return true;
+		}
+		int x = current % gridWidth;
+		int z = current / gridWidth;
+
+		int parent	= context.GetParent(current);
+		int dirs[8];
+		int dirCount = parent == PathSearchContext::NO_PARENT ?
+			PrunedDirections(x, z, x, z, dirs) :
+			PrunedDirections(x, z, parent % gridWidth, parent / gridWidth, dirs);
+
+		float currentG = context.GetCost(current);
+
+		for (int i = 0; i < dirCount; ++i) {
+			int next = HasJumpTable() ? JumpFromTable(x, z, dirs[i], goalX, goalZ) : Jump(x, z, dirs[i], goalX, goalZ);
+			if (next < 0) {
+				continue;
+			}
+			int nextX = next % gridWidth;
+			int nextZ = next / gridWidth;
+
+			float g = currentG + GridDistance(x, z, nextX, nextZ, diagonalMoves);
+
+			if (!context.IsReached(next) || (context.IsOpen(next) && g < context.GetCost(next))) {
+				context.Open(next, current, g, g + GridDistance(nextX, nextZ, goalX, goalZ, diagonalMoves));
+			}
+		}
+	}
+	return false;
+}
+
+//Whether a single step in dir from (x, z) is allowed
+bool NavigationGrid::CanStep(int x, int z, int dir) const {
+	int dx = DIR_X[dir];
+	int dz = DIR_Z[dir];
+	if (!IsWalkable(x + dx, z + dz)) {
+		return false;
+	}
+	return dir < 4 || (IsWalkable(x + dx, z) && IsWalkable(x, z + dz));
+}
+
+//Having arrived at (x, z) by moving in straight direction dir, whether a
+//wall just behind us ends here, opening up a way to the side
+bool NavigationGrid::IsForced(int x, int z, int dir) const {
+	int dx = DIR_X[dir];
+	int dz = DIR_Z[dir];
+	if (dx != 0) {
+		return (IsWalkable(x, z - 1) && !IsWalkable(x - dx, z - 1))
+			|| (IsWalkable(x, z + 1) && !IsWalkable(x - dx, z + 1));
+	}
+	return (IsWalkable(x - 1, z) && !IsWalkable(x - 1, z - dz))
+		|| (IsWalkable(x + 1, z) && !IsWalkable(x + 1, z - dz));
+}
+
+bool NavigationGrid::IsJumpPoint(int x, int z, int dir, int goalX, int goalZ) const {
+	if (x == goalX && z == goalZ) {
+		return true;
+	}
+	if (dir >= 4) { //diagonal, so try both of its straight parts
+		return Jump(x, z, DirectionOf(DIR_X[dir], 0), goalX, goalZ) >= 0
+			|| Jump(x, z, DirectionOf(0, DIR_Z[dir]), goalX, goalZ) >= 0;
+	}
+	if (!diagonalMoves && DIR_Z[dir] != 0) {
+		return IsForced(x, z, dir)
+			|| Jump(x, z, 0, goalX, goalZ) >= 0
+			|| Jump(x, z, 1, goalX, goalZ) >= 0;
+	}
+	return IsForced(x, z, dir);
+}
+
+//Steps along from (x, z) in dir until it reaches a jump point, whose index
+//is returned, or can't go any further, which returns -1
+int NavigationGrid::Jump(int x, int z, int dir, int goalX, int goalZ) const {
+	while (CanStep(x, z, dir)) {
+		x += DIR_X[dir];
+		z += DIR_Z[dir];
+		if (IsJumpPoint(x, z, dir, goalX, goalZ)) {
+			return (z * gridWidth) + x;
+		}
+	}
+	return -1;
+}
+
+/*
+The same as Jump, but with the answer already worked out by BakeJumpTable.
+The table doesn't know where the goal is, so if the goal is along the way,
+the jump stops there instead - and for the jumps that look out to the side
+as they go, it stops as soon as it's lined up with the goal, as the next
+jump from there might reach it.
+*/
+int NavigationGrid::JumpFromTable(int x, int z, int dir, int goalX, int goalZ) const {
+	int entry		= jumpTable[(((z * gridWidth) + x) * 8) + dir];
+	int maxSteps	= entry > 0 ? entry : -entry;
+
+	int dx		= DIR_X[dir];
+	int dz		= DIR_Z[dir];
+	int toGoalX = goalX - x;
+	int toGoalZ = goalZ - z;
+
+	int goalSteps = 0;
+	if (dir >= 4) {
+		if (Sign(toGoalX) == dx && Sign(toGoalZ) == dz) {
+			goalSteps = std::min(std::abs(toGoalX), std::abs(toGoalZ));
+		}
+	}
+	else if (dx != 0) {
+		if (toGoalZ == 0 && Sign(toGoalX) == dx) {
+			goalSteps = std::abs(toGoalX);
+		}
+	}
+	else if (Sign(toGoalZ) == dz && (toGoalX == 0 || !diagonalMoves)) {
+		goalSteps = std::abs(toGoalZ);
+	}
+
+	int steps = -1;
+	if (goalSteps > 0 && goalSteps <= maxSteps) {
+		steps = goalSteps;
+	}
+	else if (entry > 0) {
+		steps = entry;
+	}
+	if (steps < 0) {
+		return -1;
+	}
+	return ((z + steps * dz) * gridWidth) + x + (steps * dx);
 }
 
-GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
-	std::vector < GridNode * >::iterator bestI = list.begin();
-	GridNode * bestNode = *list.begin();
-	for (auto i = list.begin(); i != list.end(); ++i) {
-		if ((*i)->f < bestNode->f) {
-			bestNode = (*i);
-			bestI = i;
+//Which directions are worth jumping in from (x, z), having arrived from
+//(parentX, parentZ) - every direction, for the start node
+int NavigationGrid::PrunedDirections(int x, int z, int parentX, int parentZ, int* dirs) const {
+	int dx = Sign(x - parentX);
+	int dz = Sign(z - parentZ);
+
+	int count = 0;
+	if (dx == 0 && dz == 0) {
+		int dirCount = diagonalMoves ? 8 : 4;
+		for (int i = 0; i < dirCount; ++i) {
+			dirs[count++] = i;
 		}
+		return count;
 	}
-	list.erase(bestI);
-	return bestNode;
+	int dir = DirectionOf(dx, dz);
+
+	if (dx != 0 && dz != 0) {
+		dirs[count++] = DirectionOf(dx, 0);
+		dirs[count++] = DirectionOf(0, dz);
+		dirs[count++] = dir;
+	}
+	else if (!diagonalMoves) {
+		dirs[count++] = dir;
+		dirs[count++] = DirectionOf(dz, dx);	//both sides
+		dirs[count++] = DirectionOf(-dz, -dx);
+	}
+	else {
+		dirs[count++] = dir;
+		dirs[count++] = DirectionOf(dz, dx);
+		dirs[count++] = DirectionOf(-dz, -dx);
+		dirs[count++] = DirectionOf(dx + dz, dz + dx);	//and diagonally forwards to each side
+		dirs[count++] = DirectionOf(dx - dz, dz - dx);
+	}
+	return count;
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
-	return (hNode->position - endNode->position).Length();
-}
\ No newline at end of file
+int NavigationGrid::GetNeighbours(int cell, int* neighbours, float* costs) const {
+	int x = cell % gridWidth;
+	int z = cell / gridWidth;
+
+	int count		= 0;
+	int dirCount	= diagonalMoves ? 8 : 4;
+	for (int i = 0; i < dirCount; ++i) {
+		if (CanStep(x, z, i)) {
+			neighbours[count]	= cell + DIR_X[i] + (DIR_Z[i] * gridWidth);
+			costs[count]		= i < 4 ? 1.0f : SQRT2;
+			if (cellCosts) {
+				costs[count] *= 0.5f * (GetCellCost(cell) + GetCellCost(neighbours[count]));
+			}
+			count++;
+		}
+	}
+	return count;
+}
+
+float NavigationGrid::GetCellDistance(int a, int b) const {
+	return GridDistance(a % gridWidth, a / gridWidth, b % gridWidth, b / gridWidth, diagonalMoves);
+}
+
+void NavigationGrid::SetDiagonalMoves(bool allowed) {
+	diagonalMoves = allowed;
+	RecordReset();
+	if (HasJumpTable()) {
+		BakeJumpTable();
+	}
+}
+
+void NavigationGrid::SetWalkable(int x, int z, bool walkable) {
+	if (x < 0 || x >= gridWidth || z < 0 || z >= gridHeight || IsWalkable(x, z) == walkable) {
+		return;
+	}
+	MakeWritable();
+	int cell = (z * gridWidth) + x;
+	walkData[cell >> 3] ^= (unsigned char)(1 << (cell & 7));
+	RecordChange(cell);
+}
+
+void NavigationGrid::SetCellCost(int x, int z, int cost) {
+	cost = std::min(std::max(cost, 1), 255);
+	if (x < 0 || x >= gridWidth || z < 0 || z >= gridHeight) {
+		return;
+	}
+	int cell = (z * gridWidth) + x;
+	if (GetCellCost(cell) == cost) {
+		return;
+	}
+	MakeWritable();
+	if (!cellCosts) {
+		costData.assign(gridWidth * gridHeight, 1);
+		cellCosts = costData.data();
+	}
+	costData[cell] = (unsigned char)cost;
+	RecordChange(cell);
+}
+
+//Copies the cells out of the mapped file, if they're still in it
+void NavigationGrid::MakeWritable() {
+	if (!mappedFile) {
+		return;
+	}
+	walkData.assign(walkBits, walkBits + WalkBytes(gridWidth * gridHeight));
+	walkBits = walkData.data();
+	if (cellCosts) {
+		costData.assign(cellCosts, cellCosts + (gridWidth * gridHeight));
+		cellCosts = costData.data();
+	}
+	mappedFile.reset();
+}
+
+//The jump table would be out of date, so it's thrown away
+void NavigationGrid::RecordChange(int cell) {
+	ClearJumpTable();
+	version++;
+	changeLog.emplace_back(cell);
+	if (changeLog.size() > MAX_CHANGE_LOG) {
+		size_t forget = changeLog.size() / 2;
+		changeLog.erase(changeLog.begin(), changeLog.begin() + forget);
+		changeLogStart += (unsigned int)forget;
+	}
+}
+
+//For changes that can't be put down to a handful of cells
+void NavigationGrid::RecordReset() {
+	version++;
+	changeLog.clear();
+	changeLogStart = version;
+}
+
+bool NavigationGrid::GetChangesSince(unsigned int sinceVersion, std::vector<int>& outCells) const {
+	outCells.clear();
+	if (sinceVersion < changeLogStart || sinceVersion > version) {
+		return false;
+	}
+	outCells.assign(changeLog.begin() + (sinceVersion - changeLogStart), changeLog.end());
+	return true;
+}
+
+/*
+Each direction is filled in working backwards from the far edge, so that the
+entry for the next cell along is always ready before it's needed. The jumps
+that look out to the side as they go (diagonals, or verticals with no
+diagonals) need the straight ones to be done first.
+*/
+void NavigationGrid::BakeJumpTable() {
+	jumpTable.assign(gridWidth * gridHeight * 8, 0);
+
+	const int straight4[2]	= { 0, 1 };
+	const int side4[2]		= { 2, 3 };
+	const int straight8[4]	= { 0, 1, 2, 3 };
+	const int side8[4]		= { 4, 5, 6, 7 };
+
+	const int*	straightDirs	= diagonalMoves ? straight8 : straight4;
+	const int*	sideDirs		= diagonalMoves ? side8		: side4;
+	int			dirCount		= diagonalMoves ? 4 : 2;
+
+	auto isJumpPoint = [&](int x, int z, int dir, bool lookToSides) {
+		if (!lookToSides) {
+			return IsForced(x, z, dir);
+		}
+		const int* entry = &jumpTable[((z * gridWidth) + x) * 8];
+		if (dir >= 4) {
+			return entry[DirectionOf(DIR_X[dir], 0)] > 0 || entry[DirectionOf(0, DIR_Z[dir])] > 0;
+		}
+		return IsForced(x, z, dir) || entry[0] > 0 || entry[1] > 0;
+	};
+
+	auto fill = [&](int dir, bool lookToSides) {
+		int dx = DIR_X[dir];
+		int dz = DIR_Z[dir];
+		for (int zi = 0; zi < gridHeight; ++zi) {
+			int z = dz > 0 ? gridHeight - 1 - zi : zi;
+			for (int xi = 0; xi < gridWidth; ++xi) {
+				int x = dx > 0 ? gridWidth - 1 - xi : xi;
+
+				int& entry = jumpTable[(((z * gridWidth) + x) * 8) + dir];
+				if (!CanStep(x, z, dir)) {
+					entry = 0;
+				}
+				else if (isJumpPoint(x + dx, z + dz, dir, lookToSides)) {
+					entry = 1;
+				}
+				else {
+					int next = jumpTable[((((z + dz) * gridWidth) + x + dx) * 8) + dir];
+					entry = next > 0 ? next + 1 : next - 1;
+				}
+			}
+		}
+	};
+
+	for (int i = 0; i < dirCount; ++i) {
+		fill(straightDirs[i], false);
+	}
+	for (int i = 0; i < dirCount; ++i) {
+		fill(sideDirs[i], true);
+	}
+}
+
+//The inverse of GetNodePosition - each node sits in the middle of its cell,
+//so anywhere within half a node of it is in that cell. Rows go down the
+//grid towards -z, as in the text files
+int NavigationGrid::GetNodeAt(const Vector3& position) const {
+	if (nodeSize <= 0) {
+		return -1;
+	}
+	int x = (int)std::floor(((position.x - origin.x) / nodeSize) + 0.5f);
+	int z = (int)std::floor(((origin.z - position.z) / nodeSize) + 0.5f);
+
+	if (x < 0 || x > gridWidth - 1 || z < 0 || z > gridHeight - 1) {
+		return -1;
+	}
+	return (z * gridWidth) + x;
+}
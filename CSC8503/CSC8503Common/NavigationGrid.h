@@ -1,51 +1,228 @@
 #pragma once
 #include "NavigationMap.h"
+#include "PathSearchContext.h"
+#include "../../Common/MappedFile.h"
 #include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
 namespace NCL {
 	namespace CSC8503 {
-		struct GridNode {
-			GridNode* parent;
-
-			GridNode* connected[4];
-			int		  costs[4];
-
-			Vector3		position;
-
-			float f;
-			float g;
+		/*
+		AStar searches node by node. JumpPoint is Jump Point Search, which
+		only works on grids where every floor cell costs the same to cross -
+		grids with cell costs always use AStar. Rather than adding every
+		neighbour to the open list, it runs along in straight lines until it
+		hits a wall, or somewhere a different route could branch off, and
+		only adds those 'jump points'.
+		The paths are just as short, but the open list stays tiny, and the
+		waypoints are only the corners.
+		*/
+		enum class GridSearchType {
+			AStar,
+			JumpPoint
+		};
 
-			int type;
+		/*
+		Grids can be loaded from text files - the node size, width and
+		height, optionally a line 'origin x y z' with the position of node
+		(0, 0), which is otherwise at (-100, 0, 100), and then a character
+		per cell, 'x' for walls and '.' for floor. Or they can be loaded
+		from binary files, little endian, which are mapped straight into
+		memory and used as they are, so they load instantly:
 
-			GridNode() {
-				for (int i = 0; i < 4; ++i) {
-					connected[i] = nullptr;
-					costs[i] = 0;
-				}
-				f = 0;
-				g = 0;
-				type = 0;
-				parent = nullptr;
-			}
-			~GridNode() {	}
-		};
+			char		magic[4]		"NAVG"
+			uint32		version			1
+			uint32		flags			1 if there are cell costs
+			uint32		width
+			uint32		height
+			uint32		nodeSize
+			float		origin[3]		the position of node (0, 0)
+			uint8		walkable[(width * height + 7) / 8]
+										a bit per cell, lowest bit first,
+										set for floor
+			uint8		costs[width * height]
+										only if flagged, from 1 to 255
 
+		Either way, x goes along the rows, and z down them, towards -z.
+		*/
 		class NavigationGrid : public NavigationMap	{
 		public:
 			NavigationGrid();
 			NavigationGrid(const std::string&filename);
+			//Reads the same formats as the files, for grids built in code
+			NavigationGrid(std::istream& input);
+			//Made in code - walkable has a value per cell, indexed as
+			//below, and there are no cell costs
+			NavigationGrid(int width, int height, int nodeSize, const Vector3& origin, const std::vector<bool>& walkable);
 			~NavigationGrid();
 
-			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+			//In the binary format - cell costs are only written if there
+			//are any
+			void WriteGrid(std::ostream& output) const;
+
+			bool IsLoaded() const {
+				return walkBits != nullptr;
+			}
+			//Whether the cells are being used straight from a mapped file
+			bool IsMapped() const {
+				return mappedFile != nullptr;
+			}
+
+			//None of these are safe to call while searches are running -
+			//set them up straight after loading
+			void SetSearchType(GridSearchType type) {
+				searchType = type;
+			}
+			GridSearchType GetSearchType() const {
+				return searchType;
+			}
+
+			//Allows moving diagonally between cells, as long as it doesn't
+			//cut the corner of a wall, at a cost of sqrt(2)
+			void SetDiagonalMoves(bool allowed);
+			bool GetDiagonalMoves() const {
+				return diagonalMoves;
+			}
+
+			//JPS+: works out where every jump from every cell in every
+			//direction would end up, so that JumpPoint searches can look
+			//them up instead of scanning along the grid. Costs 8 ints per
+			//cell, and is rebuilt if the diagonal setting changes
+			void BakeJumpTable();
+			void ClearJumpTable() {
+				jumpTable.clear();
+			}
+			bool HasJumpTable() const {
+				return !jumpTable.empty();
+			}
+
+			//For doors, walls getting knocked down, barricades and so on.
+			//Like the settings above, these aren't safe to call while
+			//searches are running - Flush any PathRequestQueue using the
+			//grid first, and don't build FlowFields at the same time. A
+			//mapped grid is copied the first time it's changed, and the
+			//jump table is thrown away, as it'd be out of date - bake it
+			//again once the changes are done
+			void SetWalkable(int x, int z, bool walkable);
+			//From 1 to 255
+			void SetCellCost(int x, int z, int cost);
+
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const override;
+
+			//As above, but with the caller's own search state, rather than
+			//this thread's
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const;
+
+			int GetNodeAt(const Vector3& position) const override;
+				
+			int GetWidth() const {
+				return gridWidth;
+			}
+			int GetHeight() const {
+				return gridHeight;
+			}
+			int GetNodeSize() const {
+				return nodeSize;
+			}
+			Vector3 GetOrigin() const {
+				return origin;
+			}
+
+			//Cells are indexed (z * width) + x, as returned by GetNodeAt
+			bool IsWalkable(int x, int z) const {
+				if (x < 0 || x >= gridWidth || z < 0 || z >= gridHeight) {
+					return false;
+				}
+				int cell = (z * gridWidth) + x;
+				return (walkBits[cell >> 3] >> (cell & 7)) & 1;
+			}
+
+			//The middle of a cell. Columns go along +x from the origin, and
+			//rows along -z, and GetNodeAt is the exact inverse of this
+			Vector3 GetNodePosition(int cell) const {
+				int x = cell % gridWidth;
+				int z = cell / gridWidth;
+				return origin + Vector3((float)(x * nodeSize), 0.0f, (float)(-z * nodeSize));
+			}
+
+			//How many times more than usual it costs to cross a cell. Each
+			//move costs the average of the two cells it's between, so moves
+			//cost the same both ways
+			bool HasCellCosts() const {
+				return cellCosts != nullptr;
+			}
+			int GetCellCost(int cell) const {
+				return cellCosts && cellCosts[cell] > 1 ? cellCosts[cell] : 1;
+			}
+
+			//The cells that can be reached from cell in a single move, and
+			//what that move costs - 1 for straight moves, sqrt(2) for
+			//diagonals, times the average cost of the two cells. Both
+			//arrays need room for 8 entries
+			int GetNeighbours(int cell, int* neighbours, float* costs) const;
+
+			//What the cheapest route between two cells would cost if there
+			//were no walls in the way
+			float GetCellDistance(int a, int b) const;
+
+			//Goes up every time something changes that could change a path,
+			//so anything built from the grid can tell when it's out of date
+			unsigned int GetVersion() const {
+				return version;
+			}
+
+			//Fills outCells with the cells changed since the grid was at
+			//sinceVersion, so that anything built from the grid can just
+			//fix up around them. Returns false if it can't tell - it was
+			//too long ago, or a setting changed - and everything has to be
+			//rebuilt
+			bool GetChangesSince(unsigned int sinceVersion, std::vector<int>& outCells) const;
 				
 		protected:
-			bool		NodeInList(GridNode* n, std::vector<GridNode*>& list) const;
-			GridNode*	RemoveBestNode(std::vector<GridNode*>& list) const;
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
-			int nodeSize;
-			int gridWidth;
-			int gridHeight;
-
-			GridNode* allNodes;
+			void		LoadGrid(std::istream& input);
+			void		LoadTextGrid(std::istream& input);
+			bool		UseBinaryGrid(const char* data, size_t size);
+			void		MakeWritable();
+			void		RecordChange(int cell);
+			void		RecordReset();
+
+			bool		AStarSearch(int startIndex, int endIndex, PathSearchContext& context) const;
+			bool		JumpPointSearch(int startIndex, int endIndex, PathSearchContext& context) const;
+
+			bool		CanStep(int x, int z, int dir) const;
+			bool		IsForced(int x, int z, int dir) const;
+			bool		IsJumpPoint(int x, int z, int dir, int goalX, int goalZ) const;
+			int			Jump(int x, int z, int dir, int goalX, int goalZ) const;
+			int			JumpFromTable(int x, int z, int dir, int goalX, int goalZ) const;
+			int			PrunedDirections(int x, int z, int parentX, int parentZ, int* dirs) const;
+
+			int		nodeSize;
+			int		gridWidth;
+			int		gridHeight;
+			Vector3 origin;
+
+			//These point either into walkData and costData, or straight
+			//into mappedFile. There's no cost data unless a file had some
+			const unsigned char*		walkBits;
+			const unsigned char*		cellCosts;
+			std::vector<unsigned char>	walkData;
+			std::vector<unsigned char>	costData;
+			std::unique_ptr<MappedFile>	mappedFile;
+
+			GridSearchType	searchType;
+			bool			diagonalMoves;
+			unsigned int	version;
+
+			//The cell each version changed, from changeLogStart + 1 onwards
+			std::vector<int>	changeLog;
+			unsigned int		changeLogStart;
+
+			//For each cell, 8 entries, one per direction: a positive entry
+			//is how many steps away the next jump point is, anything else is
+			//minus how many steps can be taken before hitting a wall
+			std::vector<int> jumpTable;
 		};
 	}
 }
@@ -10,7 +10,19 @@ namespace NCL {
 			NavigationMap() {}
 			~NavigationMap() {}
 
-			virtual bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) = 0;
+			//FindPath can be called from any number of threads at once, as
+			//long as nothing changes the map while it's running - some maps
+			//can be changed after loading, but not while searches are in
+			//flight, so a PathRequestQueue using the map has to be Flushed
+			//before anything is changed
+			virtual bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const = 0;
+
+			//Which node a position falls in, or -1 if it's off the map. Two
+			//positions in the same node always get the same path, so this
+			//can be used to share searches between requests
+			virtual int GetNodeAt(const Vector3& position) const {
+				return -1;
+			}
 		};
 	}
 }
@@ -1,19 +1,584 @@
 #include "NavigationMesh.h"
+#include "../../Common/Assets.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
 using namespace NCL;
 using namespace CSC8503;
 
+namespace {
+	const uint32_t MESH_VERSION = 1;
+
+	//The least a vertex and a polygon (a triangle) can take up in a file
+	const uint64_t VERTEX_BYTES		= sizeof(float) * 3;
+	const uint64_t MIN_POLYGON_BYTES	= sizeof(uint8_t) + (3 * sizeof(uint32_t)) + (3 * sizeof(int32_t));
+
+	//Twice the signed area of the triangle abc, in x and z - negative if
+	//it winds anticlockwise, seen from above
+	float Cross2D(const Vector3& a, const Vector3& b, const Vector3& c) {
+		return ((b.x - a.x) * (c.z - a.z)) - ((b.z - a.z) * (c.x - a.x));
+	}
+
+	float DistanceSquared2D(const Vector3& a, const Vector3& b) {
+		float dx = b.x - a.x;
+		float dz = b.z - a.z;
+		return (dx * dx) + (dz * dz);
+	}
+
+	bool SamePoint(const Vector3& a, const Vector3& b) {
+		return DistanceSquared2D(a, b) < 1e-8f;
+	}
+
+	template<class T>
+	bool ReadValue(std::istream& input, T& value) {
+		return (bool)input.read((char*)&value, sizeof(T));
+	}
+
+	template<class T>
+	void WriteValue(std::ostream& output, const T& value) {
+		output.write((const char*)&value, sizeof(T));
+	}
+
+	//How many bytes are left to read, or -1 if the stream can't say
+	std::streamoff BytesLeft(std::istream& input) {
+		std::streampos here = input.tellg();
+		if (here == std::streampos(-1)) {
+			return -1;
+		}
+		input.seekg(0, std::ios::end);
+		std::streampos end = input.tellg();
+		input.seekg(here);
+		return end == std::streampos(-1) ? -1 : (std::streamoff)(end - here);
+	}
+
+	void RecordQuery(bool found) {
+		static MetricCounter& queries	= Metrics::GetCounter("path.mesh.queries");
+		static MetricCounter& failures	= Metrics::GetCounter("path.mesh.failures");
+
+		queries.Add();
+		if (!found) {
+			failures.Add();
+		}
+	}
+}
+
 NavigationMesh::NavigationMesh()
 {
+	Clear();
+}
+
+NavigationMesh::NavigationMesh(const std::string&filename) : NavigationMesh()
+{
+	std::ifstream infile(Assets::DATADIR + filename, std::ios::binary);
+	LoadMesh(infile);
+}
+
+NavigationMesh::NavigationMesh(std::istream& input) : NavigationMesh()
+{
+	LoadMesh(input);
 }
 
-NavigationMesh::NavigationMesh(const std::string&filename)
+NavigationMesh::NavigationMesh(const std::vector<Vector3>& meshVertices, const std::vector<std::vector<int>>& polygons) : NavigationMesh()
 {
+	vertices = meshVertices;
+	for (const std::vector<int>& p : polygons) {
+		indices.insert(indices.end(), p.begin(), p.end());
+		polygonStarts.push_back((int)indices.size());
+	}
+	neighbours.assign(indices.size(), -1);
+
+	//Winding has to be sorted out first, so that a shared edge runs one
+	//way in one polygon, and the other way in its neighbour
+	FixWinding();
+
+	std::map<std::pair<int, int>, int> edges; //to the index of its first vertex
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		int start = polygonStarts[p];
+		int sides = PolygonSides(p);
+		for (int i = 0; i < sides; ++i) {
+			int a = indices[start + i];
+			int b = indices[start + ((i + 1) % sides)];
+
+			auto other = edges.find(std::make_pair(b, a));
+			if (other != edges.end()) {
+				int otherPoly = (int)(std::upper_bound(polygonStarts.begin(), polygonStarts.end(), other->second) - polygonStarts.begin()) - 1;
+				neighbours[start + i]		= otherPoly;
+				neighbours[other->second]	= p;
+				edges.erase(other);
+			}
+			else {
+				edges[std::make_pair(a, b)] = start + i;
+			}
+		}
+	}
+	BuildCentres();
+	BuildBuckets();
 }
 
 NavigationMesh::~NavigationMesh()
 {
 }
 
-bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
+void NavigationMesh::Clear() {
+	vertices.clear();
+	polygonStarts.assign(1, 0);
+	indices.clear();
+	neighbours.clear();
+	centres.clear();
+	bucketStarts.clear();
+	bucketPolygons.clear();
+	bucketSize	= 1.0f;
+	bucketsX	= 0;
+	bucketsZ	= 0;
+}
+
+void NavigationMesh::LoadMesh(std::istream& input) {
+	char		magic[4]		= { 0 };
+	uint32_t	version			= 0;
+	uint32_t	vertexCount		= 0;
+	uint32_t	polygonCount	= 0;
+
+	input.read(magic, 4);
+	if (!input || std::memcmp(magic, "NAVM", 4) != 0) {
+		std::cout << "File is not a NavigationMesh file!" << std::endl;
+		return;
+	}
+	ReadValue(input, version);
+	if (version != MESH_VERSION) {
+		std::cout << "NavigationMesh file has incompatible version!" << std::endl;
+		return;
+	}
+	bool valid = ReadValue(input, vertexCount) && ReadValue(input, polygonCount);
+
+	//A damaged count could ask for gigabytes, so they're checked against
+	//what's actually left in the file before anything is allocated. Streams
+	//that can't say how much is left are just read until they run out
+	std::streamoff left = BytesLeft(input);
+	if (valid && left >= 0) {
+		valid = (vertexCount * VERTEX_BYTES) + (polygonCount * MIN_POLYGON_BYTES) <= (uint64_t)left;
+		if (valid) {
+			vertices.reserve(vertexCount);
+		}
+	}
+	for (uint32_t i = 0; i < vertexCount && valid; ++i) {
+		Vector3 v;
+		valid = ReadValue(input, v.x) && ReadValue(input, v.y) && ReadValue(input, v.z);
+		vertices.push_back(v);
+	}
+	for (uint32_t p = 0; p < polygonCount && valid; ++p) {
+		uint8_t sides = 0;
+		valid = ReadValue(input, sides) && sides >= 3;
+
+		for (int i = 0; i < sides && valid; ++i) {
+			uint32_t index = 0;
+			valid = ReadValue(input, index) && index < vertexCount;
+			indices.push_back((int)index);
+		}
+		for (int i = 0; i < sides && valid; ++i) {
+			int32_t neighbour = -1;
+			valid = ReadValue(input, neighbour) && neighbour >= -1 && neighbour < (int32_t)polygonCount;
+			neighbours.push_back(neighbour);
+		}
+		polygonStarts.push_back((int)indices.size());
+	}
+	if (!valid) {
+		std::cout << "NavigationMesh file is damaged!" << std::endl;
+		Clear();
+		return;
+	}
+	FixWinding();
+	BuildCentres();
+	BuildBuckets();
+}
+
+bool NavigationMesh::WriteMesh(std::ostream& output) const {
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		if (PolygonSides(p) > MAX_SIDES) {
+			std::cout << __FUNCTION__ << " polygon " << p << " has " << PolygonSides(p) << " sides - the file can't hold more than " << MAX_SIDES << "!" << std::endl;
+			return false;
+		}
+	}
+	output.write("NAVM", 4);
+	WriteValue(output, MESH_VERSION);
+	WriteValue(output, (uint32_t)vertices.size());
+	WriteValue(output, (uint32_t)GetPolygonCount());
+
+	for (const Vector3& v : vertices) {
+		WriteValue(output, v.x);
+		WriteValue(output, v.y);
+		WriteValue(output, v.z);
+	}
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		int start = polygonStarts[p];
+		int sides = PolygonSides(p);
+		WriteValue(output, (uint8_t)sides);
+		for (int i = 0; i < sides; ++i) {
+			WriteValue(output, (uint32_t)indices[start + i]);
+		}
+		for (int i = 0; i < sides; ++i) {
+			WriteValue(output, (int32_t)neighbours[start + i]);
+		}
+	}
+	return true;
+}
+
+/*
+Each edge's neighbour belongs to the vertex it starts from, so when a
+polygon's corners are turned round, the neighbours have to move round by
+one, as well as being reversed.
+*/
+void NavigationMesh::FixWinding() {
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		int		start	= polygonStarts[p];
+		int		sides	= PolygonSides(p);
+		float	area	= 0.0f;
+		for (int i = 1; i < sides - 1; ++i) {
+			area += Cross2D(PolygonVertex(p, 0), PolygonVertex(p, i), PolygonVertex(p, i + 1));
+		}
+		if (area <= 0.0f) {
+			continue;
+		}
+		std::reverse(indices.begin() + start, indices.begin() + start + sides);
+		std::reverse(neighbours.begin() + start, neighbours.begin() + start + sides - 1);
+	}
+}
+
+void NavigationMesh::BuildCentres() {
+	centres.resize(GetPolygonCount());
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		Vector3 centre;
+		for (int i = 0; i < PolygonSides(p); ++i) {
+			centre += PolygonVertex(p, i);
+		}
+		centres[p] = centre / (float)PolygonSides(p);
+	}
+}
+
+/*
+The buckets are sized so that there's about one polygon's worth of area in
+each. Polygons go in every bucket their bounding box touches, so a big one
+can be in lots of buckets - but then there aren't many polygons around it.
+*/
+void NavigationMesh::BuildBuckets() {
+	if (vertices.empty() || !IsLoaded()) {
+		return;
+	}
+	boundsMin = vertices[0];
+	Vector3 boundsMax = vertices[0];
+	for (const Vector3& v : vertices) {
+		boundsMin.x = std::min(boundsMin.x, v.x);
+		boundsMin.z = std::min(boundsMin.z, v.z);
+		boundsMax.x = std::max(boundsMax.x, v.x);
+		boundsMax.z = std::max(boundsMax.z, v.z);
+	}
+	float width		= std::max(boundsMax.x - boundsMin.x, 1e-3f);
+	float depth		= std::max(boundsMax.z - boundsMin.z, 1e-3f);
+	bucketSize		= std::sqrt((width * depth) / GetPolygonCount());
+	bucketsX		= std::min((int)(width / bucketSize) + 1, 1024);
+	bucketsZ		= std::min((int)(depth / bucketSize) + 1, 1024);
+	bucketSize		= std::max(width / bucketsX, depth / bucketsZ) * 1.0001f;
+
+	auto bucketRange = [&](int p, int& minX, int& minZ, int& maxX, int& maxZ) {
+		float lowX = FLT_MAX, lowZ = FLT_MAX, highX = -FLT_MAX, highZ = -FLT_MAX;
+		for (int i = 0; i < PolygonSides(p); ++i) {
+			const Vector3& v = PolygonVertex(p, i);
+			lowX	= std::min(lowX, v.x);
+			lowZ	= std::min(lowZ, v.z);
+			highX	= std::max(highX, v.x);
+			highZ	= std::max(highZ, v.z);
+		}
+		minX = std::min((int)((lowX		- boundsMin.x) / bucketSize), bucketsX - 1);
+		minZ = std::min((int)((lowZ		- boundsMin.z) / bucketSize), bucketsZ - 1);
+		maxX = std::min((int)((highX	- boundsMin.x) / bucketSize), bucketsX - 1);
+		maxZ = std::min((int)((highZ	- boundsMin.z) / bucketSize), bucketsZ - 1);
+	};
+
+	//Counted first, so the buckets can all share one array
+	bucketStarts.assign((bucketsX * bucketsZ) + 1, 0);
+	int minX, minZ, maxX, maxZ;
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		bucketRange(p, minX, minZ, maxX, maxZ);
+		for (int z = minZ; z <= maxZ; ++z) {
+			for (int x = minX; x <= maxX; ++x) {
+				bucketStarts[(z * bucketsX) + x + 1]++;
+			}
+		}
+	}
+	for (size_t i = 1; i < bucketStarts.size(); ++i) {
+		bucketStarts[i] += bucketStarts[i - 1];
+	}
+	bucketPolygons.resize(bucketStarts.back());
+	std::vector<int> filled(bucketStarts.begin(), bucketStarts.end() - 1);
+	for (int p = 0; p < GetPolygonCount(); ++p) {
+		bucketRange(p, minX, minZ, maxX, maxZ);
+		for (int z = minZ; z <= maxZ; ++z) {
+			for (int x = minX; x <= maxX; ++x) {
+				bucketPolygons[filled[(z * bucketsX) + x]++] = p;
+			}
+		}
+	}
+}
+
+bool NavigationMesh::ContainsPoint(int poly, const Vector3& point) const {
+	int sides = PolygonSides(poly);
+	for (int i = 0; i < sides; ++i) {
+		if (Cross2D(PolygonVertex(poly, i), PolygonVertex(poly, (i + 1) % sides), point) > 1e-6f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//Returns the squared distance to the closest point, in x and z
+float NavigationMesh::ClosestPoint(int poly, const Vector3& point, Vector3& outPoint) const {
+	if (ContainsPoint(poly, point)) {
+		outPoint = point;
+		return 0.0f;
+	}
+	float	best	= FLT_MAX;
+	int		sides	= PolygonSides(poly);
+	for (int i = 0; i < sides; ++i) {
+		const Vector3& a = PolygonVertex(poly, i);
+		const Vector3& b = PolygonVertex(poly, (i + 1) % sides);
+
+		Vector3 edge	= b - a;
+		float	length	= (edge.x * edge.x) + (edge.z * edge.z);
+		float	t		= length > 0.0f ? (((point.x - a.x) * edge.x) + ((point.z - a.z) * edge.z)) / length : 0.0f;
+		Vector3 onEdge	= a + (edge * std::min(std::max(t, 0.0f), 1.0f));
+
+		float distance = DistanceSquared2D(point, onEdge);
+		if (distance < best) {
+			best		= distance;
+			outPoint	= onEdge;
+		}
+	}
+	return best;
+}
+
+/*
+Only the bucket the position is in, and the ones around it, are looked at -
+anything further away than that is too far off the mesh to count.
+*/
+int NavigationMesh::GetPolygonAt(const Vector3& position, Vector3* onMesh) const {
+	if (bucketStarts.empty()) {
+		return -1;
+	}
+	int bx = (int)std::floor((position.x - boundsMin.x) / bucketSize);
+	int bz = (int)std::floor((position.z - boundsMin.z) / bucketSize);
+
+	int		bestPoly		= -1;
+	float	bestDistance	= FLT_MAX;
+	float	bestHeight		= FLT_MAX;
+	Vector3 bestPoint;
+	for (int z = std::max(bz - 1, 0); z <= std::min(bz + 1, bucketsZ - 1); ++z) {
+		for (int x = std::max(bx - 1, 0); x <= std::min(bx + 1, bucketsX - 1); ++x) {
+			int bucket = (z * bucketsX) + x;
+			for (int i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; ++i) {
+				int		poly = bucketPolygons[i];
+				Vector3 point;
+				float	distance	= ClosestPoint(poly, position, point);
+				float	height		= std::abs(centres[poly].y - position.y);
+				if (distance < bestDistance || (distance == bestDistance && height < bestHeight)) {
+					bestPoly		= poly;
+					bestDistance	= distance;
+					bestHeight		= height;
+					bestPoint		= point;
+				}
+			}
+		}
+	}
+	if (bestPoly >= 0 && onMesh) {
+		bestPoint.y = position.y;
+		*onMesh		= bestPoint;
+	}
+	return bestPoly;
+}
+
+bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	return FindPath(from, to, outPath, PathSearchContext::ForThisThread());
+}
+
+bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const {
+	NCL_PROFILE_ZONE("Path::MeshFindPath");
+
+	Vector3 start;
+	Vector3 end;
+	int startPoly	= GetPolygonAt(from, &start);
+	int endPoly		= GetPolygonAt(to, &end);
+
+	if (startPoly < 0 || endPoly < 0) {
+		RecordQuery(false);
+		return false; //not on the mesh!
+	}
+	if (!SearchCorridor(startPoly, endPoly, start, end, context)) {
+		RecordQuery(false);
+		return false;
+	}
+	std::vector<int> corridor;
+	for (int poly = endPoly; poly != PathSearchContext::NO_PARENT; poly = context.GetParent(poly)) {
+		corridor.push_back(poly);
+	}
+	std::reverse(corridor.begin(), corridor.end());
+
+	PullString(corridor, start, end, outPath);
+	RecordQuery(true);
+	return true;
+}
+
+/*
+A polygon can be big, so rather than its centre, each one is treated as
+being wherever the search came into it - the middle of the edge it was
+reached through, or the start itself. The goal's cost includes the last
+bit from there to the goal, so that the search can tell which way in gets
+there soonest. It's still not exact, but the funnel tightens the path up
+afterwards anyway.
+*/
+bool NavigationMesh::SearchCorridor(int startPoly, int endPoly, const Vector3& from, const Vector3& to, PathSearchContext& context) const {
+	context.BeginSearch(GetPolygonCount());
+	context.Open(startPoly, PathSearchContext::NO_PARENT, 0.0f, (to - from).Length());
+
+	Vector3 left;
+	Vector3 right;
+	while (context.HasOpenNodes()) {
+		int poly = context.PopBestNode();
+		if (poly == endPoly) {
+			return true;
+		}
+		Vector3 position = from;
+		if (poly != startPoly) {
+			GetPortal(context.GetParent(poly), poly, left, right);
+			position = (left + right) * 0.5f;
+		}
+		float cost = context.GetCost(poly);
+
+		int start = polygonStarts[poly];
+		int sides = PolygonSides(poly);
+		for (int i = 0; i < sides; ++i) {
+			int neighbour = neighbours[start + i];
+			if (neighbour < 0) {
+				continue;
+			}
+			bool reached = context.IsReached(neighbour);
+			if (reached && !context.IsOpen(neighbour)) {
+				continue; //already closed
+			}
+			//The heuristic can't depend on the way in, or a cheaper way in
+			//could still raise the node's priority
+			Vector3 entry	= (PolygonVertex(poly, i) + PolygonVertex(poly, (i + 1) % sides)) * 0.5f;
+			float	g		= cost + (entry - position).Length();
+			float	h		= (to - centres[neighbour]).Length();
+			if (neighbour == endPoly) {
+				g += (to - entry).Length();
+				h = 0.0f;
+			}
+			if (!reached || g < context.GetCost(neighbour)) {
+				context.Open(neighbour, poly, g, g + h);
+			}
+		}
+	}
 	return false;
 }
+
+//The edge between two neighbouring polygons, as seen walking from one into
+//the other
+void NavigationMesh::GetPortal(int fromPoly, int toPoly, Vector3& left, Vector3& right) const {
+	int start = polygonStarts[fromPoly];
+	int sides = PolygonSides(fromPoly);
+	for (int i = 0; i < sides; ++i) {
+		if (neighbours[start + i] == toPoly) {
+			left	= PolygonVertex(fromPoly, i);
+			right	= PolygonVertex(fromPoly, (i + 1) % sides);
+			return;
+		}
+	}
+}
+
+/*
+The simple stupid funnel algorithm. The funnel starts at the apex (the
+start, or the last corner added to the path), and its sides run out to the
+left and right ends of the portal it has got to. Going through the portals
+in turn, each side is pulled in to the new portal's end if that narrows the
+funnel - but if pulling one side in would cross over the other side, then
+the path has to turn the corner at that other side, which becomes the
+apex of a new funnel, and the portals are gone through again from there.
+
+The portals have to be the right way round for this - left and right as
+seen walking along the corridor. The start and goal are portals with both
+ends at the same point.
+*/
+void NavigationMesh::PullString(const std::vector<int>& corridor, const Vector3& from, const Vector3& to, NavigationPath& outPath) const {
+	std::vector<Vector3> lefts;
+	std::vector<Vector3> rights;
+	lefts.push_back(from);
+	rights.push_back(from);
+	for (size_t i = 1; i < corridor.size(); ++i) {
+		Vector3 left;
+		Vector3 right;
+		GetPortal(corridor[i - 1], corridor[i], left, right);
+		lefts.push_back(left);
+		rights.push_back(right);
+	}
+	lefts.push_back(to);
+	rights.push_back(to);
+
+	std::vector<Vector3> points;
+	points.push_back(from);
+
+	Vector3 apex		= from;
+	Vector3 funnelLeft	= from;
+	Vector3 funnelRight = from;
+	size_t	leftIndex	= 0;
+	size_t	rightIndex	= 0;
+
+	for (size_t i = 1; i < lefts.size(); ++i) {
+		const Vector3& left		= lefts[i];
+		const Vector3& right	= rights[i];
+
+		//Try to narrow the right side
+		if (Cross2D(apex, funnelRight, right) >= 0.0f) {
+			if (SamePoint(apex, funnelRight) || Cross2D(apex, funnelLeft, right) < 0.0f) {
+				funnelRight = right;
+				rightIndex	= i;
+			}
+			else { //it crosses the left side, so turn the corner there
+				points.push_back(funnelLeft);
+				apex		= funnelLeft;
+				funnelRight = apex;
+				rightIndex	= leftIndex;
+				i			= leftIndex;
+				continue;
+			}
+		}
+		//And then the left
+		if (Cross2D(apex, funnelLeft, left) <= 0.0f) {
+			if (SamePoint(apex, funnelLeft) || Cross2D(apex, funnelRight, left) > 0.0f) {
+				funnelLeft	= left;
+				leftIndex	= i;
+			}
+			else {
+				points.push_back(funnelRight);
+				apex		= funnelRight;
+				funnelLeft	= apex;
+				leftIndex	= rightIndex;
+				i			= rightIndex;
+				continue;
+			}
+		}
+	}
+	if (!SamePoint(points.back(), to)) {
+		points.push_back(to);
+	}
+	//Waypoints are popped off the back
+	for (auto p = points.rbegin(); p != points.rend(); ++p) {
+		outPath.PushWaypoint(*p);
+	}
+}
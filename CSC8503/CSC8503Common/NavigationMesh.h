@@ -1,19 +1,132 @@
+/******************************************************************************
+Class:NavigationMesh
+Implements:NavigationMap
+Description:A navigation mesh - the walkable parts of a level, covered by
+convex polygons. Anywhere inside a polygon can be walked to in a straight
+line from anywhere else in it, so a big open room can be a handful of
+polygons, where a grid would need hundreds of cells.
+
+A search runs A* over the polygons, from the one the start is in to the one
+the goal is in, moving between neighbours that share an edge. That gives a
+corridor of polygons, which is then pulled tight into the shortest line
+through it with the 'simple stupid funnel' algorithm - so the waypoints are
+just the corners the path has to go around.
+
+The start and goal polygons are found with a uniform grid of buckets over
+the mesh, each listing the polygons that overlap it. Positions that aren't
+on the mesh are moved to the closest point of a nearby polygon.
+
+Mesh files are binary, little endian:
+
+	char		magic[4]		"NAVM"
+	uint32		version			1
+	uint32		vertexCount
+	uint32		polygonCount
+	float		vertices[vertexCount * 3]
+	per polygon:
+		uint8	sides				3 to 255
+		uint32	indices[sides]
+		int32	neighbours[sides]	the polygon across the edge from each
+									vertex to the next, or -1
+
+The mesh is only walked in x and z - y is just carried along into the
+waypoints, so levels can slope, but polygons shouldn't overlap from above.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "NavigationMap.h"
+#include "PathSearchContext.h"
 #include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
 
 namespace NCL {
 	namespace CSC8503 {
 		class NavigationMesh : public NavigationMap	{
 		public:
+			//A polygon's side count has to fit in a byte in the file
+			static const int MAX_SIDES = 255;
+
 			NavigationMesh();
 			NavigationMesh(const std::string&filename);
+			NavigationMesh(std::istream& input);
+			//For meshes built in code - the neighbours are worked out from
+			//which polygons share an edge's vertices
+			NavigationMesh(const std::vector<Vector3>& vertices, const std::vector<std::vector<int>>& polygons);
 			~NavigationMesh();
 
-			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
-		
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) const override;
+
+			//As above, but with the caller's own search state, rather than
+			//this thread's
+			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath, PathSearchContext& context) const;
+
+			//The polygon the position is in, or failing that the closest
+			//one nearby, or -1 if there's nothing near. onMesh is set to the
+			//closest point on that polygon. GetNodeAt isn't overridden, as
+			//two positions in the same polygon can get different paths
+			int GetPolygonAt(const Vector3& position, Vector3* onMesh = nullptr) const;
+
+			//In the same format the file constructor reads - false, and
+			//writes nothing, if any polygon has more than MAX_SIDES sides
+			bool WriteMesh(std::ostream& output) const;
+
+			int GetPolygonCount() const {
+				return (int)polygonStarts.size() - 1;
+			}
+			int GetVertexCount() const {
+				return (int)vertices.size();
+			}
+			bool IsLoaded() const {
+				return GetPolygonCount() > 0;
+			}
+
 		protected:
-	
+			void	LoadMesh(std::istream& input);
+			void	Clear();
+			void	FixWinding();
+			void	BuildCentres();
+			void	BuildBuckets();
+
+			int		PolygonSides(int poly) const {
+				return polygonStarts[poly + 1] - polygonStarts[poly];
+			}
+			const Vector3& PolygonVertex(int poly, int i) const {
+				return vertices[indices[polygonStarts[poly] + i]];
+			}
+
+			bool	ContainsPoint(int poly, const Vector3& point) const;
+			float	ClosestPoint(int poly, const Vector3& point, Vector3& outPoint) const;
+
+			bool	SearchCorridor(int startPoly, int endPoly, const Vector3& from, const Vector3& to, PathSearchContext& context) const;
+			void	GetPortal(int fromPoly, int toPoly, Vector3& left, Vector3& right) const;
+			void	PullString(const std::vector<int>& corridor, const Vector3& from, const Vector3& to, NavigationPath& outPath) const;
+
+			std::vector<Vector3>	vertices;
+
+			//The corners of polygon i are indices[polygonStarts[i]] up to
+			//polygonStarts[i + 1], anticlockwise from above, and neighbours
+			//runs alongside indices
+			std::vector<int>		polygonStarts;
+			std::vector<int>		indices;
+			std::vector<int>		neighbours;
+			std::vector<Vector3>	centres;
+
+			//The buckets cover the mesh's bounds in x and z. The polygons
+			//in bucket i are bucketPolygons[bucketStarts[i]] up to
+			//bucketStarts[i + 1]
+			Vector3					boundsMin;
+			float					bucketSize;
+			int						bucketsX;
+			int						bucketsZ;
+			std::vector<int>		bucketStarts;
+			std::vector<int>		bucketPolygons;
 		};
 	}
-}
\ No newline at end of file
+}
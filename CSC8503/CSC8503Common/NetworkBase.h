@@ -3,6 +3,7 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <cstring>
 
 enum BasicNetworkMessages {
 	None,
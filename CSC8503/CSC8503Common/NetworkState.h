@@ -11,7 +11,7 @@ namespace NCL {
 			NetworkState() {
 				stateID = 0;
 			}
-			virtual ~NetworkState();
+			virtual ~NetworkState() {}
 
 			Vector3		position;
 			Quaternion	orientation;
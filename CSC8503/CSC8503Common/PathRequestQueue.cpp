@@ -0,0 +1,283 @@
+#include "PathRequestQueue.h"
+#include "../../Common/GameTimer.h"
+#include "../../Common/Profiler.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	const int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+}
+
+PathRequestQueue::PathRequestQueue(const NavigationMap& map, JobSystem& jobs) : map(map), jobs(jobs) {
+	nextID			= 0;
+	nextOrder		= 0;
+	pendingCount	= 0;
+	batchNext		= 0;
+	batchEnd		= 0;
+	batchRunning	= false;
+}
+
+PathRequestQueue::~PathRequestQueue() {
+	if (batchRunning) {
+		jobs.Wait(batchCounter);
+	}
+}
+
+PathRequestQueue::RequestID PathRequestQueue::Request(const Vector3& from, const Vector3& to, int priority, float deadline, const Callback& callback) {
+	static MetricCounter& requestCount	= Metrics::GetCounter("path.requests");
+	static MetricCounter& sharedCount	= Metrics::GetCounter("path.requests_shared");
+	requestCount.Add();
+
+	RequestID	id			= nextID++;
+	int64_t		deadlineNs	= deadline > 0.0f ? GameTimer::GetNanoseconds() + (int64_t)(deadline * 1e9) : NO_DEADLINE;
+
+	int		startNode	= map.GetNodeAt(from);
+	int		goalNode	= map.GetNodeAt(to);
+	int64_t key			= (startNode >= 0 && goalNode >= 0) ? ((int64_t)startNode << 32) | (uint32_t)goalNode : -1;
+
+	Search* search = nullptr;
+	if (key >= 0) {
+		auto i = searchesByKey.find(key);
+		if (i != searchesByKey.end()) {
+			search = i->second;
+		}
+	}
+	if (search) {
+		//It's only searched for once, so it has to suit the most urgent
+		//request, and still be wanted as long as any of them want it
+		search->priority = std::max(search->priority, priority);
+		if (deadlineNs > search->deadline.load(std::memory_order_relaxed)) {
+			search->deadline.store(deadlineNs, std::memory_order_relaxed);
+		}
+		sharedCount.Add();
+	}
+	else {
+		searches.emplace_back(new Search());
+		search = searches.back().get();
+		search->from		= from;
+		search->to			= to;
+		search->key			= key;
+		search->priority	= priority;
+		search->order		= nextOrder++;
+		search->deadline	= deadlineNs;
+		search->inBatch		= false;
+		search->state		= Search::Waiting;
+		search->found		= false;
+		if (key >= 0) {
+			searchesByKey[key] = search;
+		}
+	}
+	search->requests.push_back(id);
+
+	PendingRequest& request = requests[id];
+	request.status		= PathRequestStatus::Pending;
+	request.search		= search;
+	request.callback	= callback;
+	pendingCount++;
+	return id;
+}
+
+void PathRequestQueue::Cancel(RequestID id) {
+	auto i = requests.find(id);
+	if (i == requests.end()) {
+		return;
+	}
+	Search* search = i->second.search;
+	if (search) {
+		search->requests.erase(std::find(search->requests.begin(), search->requests.end(), id));
+		pendingCount--;
+
+		//If it's in the batch, a worker might be on it right now, so it's
+		//left for FinishBatch to throw away
+		if (search->requests.empty() && !search->inBatch) {
+			search->state = Search::Expired;
+			RemoveFinishedSearches();
+		}
+	}
+	requests.erase(i);
+}
+
+PathRequestStatus PathRequestQueue::GetStatus(RequestID id) const {
+	auto i = requests.find(id);
+	if (i == requests.end()) {
+		return PathRequestStatus::Unknown;
+	}
+	return i->second.status;
+}
+
+bool PathRequestQueue::TakeResult(RequestID id, NavigationPath& outPath) {
+	auto i = requests.find(id);
+	if (i == requests.end() || i->second.status == PathRequestStatus::Pending) {
+		return false;
+	}
+	outPath = std::move(i->second.path);
+	requests.erase(i);
+	return true;
+}
+
+int PathRequestQueue::GetPendingCount() const {
+	return pendingCount;
+}
+
+void PathRequestQueue::Update(float budget) {
+	NCL_PROFILE_ZONE("Path::QueueUpdate");
+	static MetricGauge& queueLength = Metrics::GetGauge("path.queue_length");
+
+	if (batchRunning && batchCounter.IsDone()) {
+		FinishBatch();
+	}
+	if (!batchRunning) {
+		StartBatch(budget);
+	}
+	queueLength.Set(pendingCount);
+	RunCallbacks();
+}
+
+void PathRequestQueue::Flush() {
+	NCL_PROFILE_ZONE("Path::QueueFlush");
+	if (batchRunning) {
+		jobs.Wait(batchCounter);
+		FinishBatch();
+	}
+	RunCallbacks();
+}
+
+void PathRequestQueue::RunCallbacks() {
+	std::vector<std::function<void()>> toCall;
+	toCall.swap(callbacks);
+	for (auto& c : toCall) {
+		c();
+	}
+}
+
+/*
+Everything that's waiting goes into the batch, most urgent first - whatever
+the workers don't get round to this frame goes back to waiting, and gets
+sorted in with the next frame's requests.
+*/
+void PathRequestQueue::StartBatch(float budget) {
+	int64_t now = GameTimer::GetNanoseconds();
+
+	bool dropped = false;
+	for (auto& s : searches) {
+		if (s->requests.empty()) {
+			s->state	= Search::Expired;
+			dropped		= true;
+		}
+		else if (s->deadline.load(std::memory_order_relaxed) < now) {
+			s->state	= Search::Expired;
+			dropped		= true;
+			Deliver(*s);
+		}
+	}
+	if (dropped) {
+		RemoveFinishedSearches();
+	}
+	if (searches.empty()) {
+		return;
+	}
+
+	batch.clear();
+	for (auto& s : searches) {
+		s->inBatch = true;
+		batch.push_back(s.get());
+	}
+	std::sort(batch.begin(), batch.end(), [](const Search* a, const Search* b) {
+		if (a->priority != b->priority) {
+			return a->priority > b->priority;
+		}
+		return a->order < b->order;
+	});
+
+	batchNext		= 0;
+	batchEnd		= now + (int64_t)(budget * 1e6);
+	batchRunning	= true;
+
+	size_t workerCount = std::min((size_t)std::max(1u, jobs.GetWorkerCount()), batch.size());
+	for (size_t i = 0; i < workerCount; ++i) {
+		jobs.Run([this]() { ProcessBatch(); }, &batchCounter);
+	}
+}
+
+//Runs on the workers. Each one always does at least one search, so that
+//the queue keeps moving however small the budget is
+void PathRequestQueue::ProcessBatch() {
+	do {
+		size_t i = batchNext.fetch_add(1);
+		if (i >= batch.size()) {
+			return;
+		}
+		Search& s = *batch[i];
+		if (GameTimer::GetNanoseconds() > s.deadline.load(std::memory_order_relaxed)) {
+			s.state = Search::Expired;
+			continue;
+		}
+		s.found = map.FindPath(s.from, s.to, s.path);
+		s.state = Search::Searched;
+	} while (GameTimer::GetNanoseconds() < batchEnd);
+}
+
+void PathRequestQueue::FinishBatch() {
+	int64_t now = GameTimer::GetNanoseconds();
+
+	for (Search* s : batch) {
+		s->inBatch = false;
+		if (s->state == Search::Expired && s->deadline.load(std::memory_order_relaxed) > now) {
+			s->state = Search::Waiting; //a later request joined it after it expired
+		}
+		if (s->state != Search::Waiting) {
+			Deliver(*s);
+		}
+	}
+	batch.clear();
+	batchRunning = false;
+	RemoveFinishedSearches();
+}
+
+void PathRequestQueue::Deliver(Search& search) {
+	static MetricCounter& expiredCount = Metrics::GetCounter("path.requests_expired");
+
+	PathRequestStatus status = PathRequestStatus::NotFound;
+	if (search.state == Search::Expired) {
+		status = PathRequestStatus::Expired;
+		expiredCount.Add((int64_t)search.requests.size());
+	}
+	else if (search.found) {
+		status = PathRequestStatus::Found;
+	}
+
+	for (RequestID id : search.requests) {
+		auto i = requests.find(id);
+		PendingRequest& r = i->second;
+		r.status	= status;
+		r.search	= nullptr;
+		r.path		= search.path;
+		pendingCount--;
+
+		if (r.callback) {
+			Callback				callback	= std::move(r.callback);
+			std::shared_ptr<NavigationPath> path(new NavigationPath(std::move(r.path)));
+			callbacks.emplace_back([callback, id, status, path]() { callback(id, status, *path); });
+			requests.erase(i);
+		}
+	}
+	search.requests.clear();
+}
+
+void PathRequestQueue::RemoveFinishedSearches() {
+	auto newEnd = std::remove_if(searches.begin(), searches.end(), [&](const std::unique_ptr<Search>& s) {
+		if (s->state == Search::Waiting || s->inBatch) {
+			return false;
+		}
+		if (s->key >= 0) {
+			searchesByKey.erase(s->key);
+		}
+		return true;
+	});
+	searches.erase(newEnd, searches.end());
+}
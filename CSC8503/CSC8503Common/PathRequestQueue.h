@@ -0,0 +1,153 @@
+/******************************************************************************
+Class:PathRequestQueue
+Implements:
+Description:Takes path requests from the game, and answers them over the next
+few frames on the JobSystem's workers, rather than every agent calling
+FindPath on the game thread - so a whole wave of agents repathing at once
+doesn't turn into one huge frame.
+
+Requests have a priority - higher goes first - and optionally a deadline, in
+seconds; a request that hasn't been started by its deadline is dropped as
+Expired rather than searched for, as whoever asked has probably moved on.
+
+Requests whose start and goal fall in the same map nodes as one that's
+already waiting (see NavigationMap::GetNodeAt) don't get searches of their
+own, they just share the result.
+
+Call Update once a frame on the game thread. That hands out the results of
+the last frame's searches, and starts the workers on the next lot, which
+they keep picking off in priority order until the budget is used up. The
+budget is only checked between searches, so a single long search can still
+run over it. Results come back either through the request's callback, which
+is called from Update, or by polling with GetStatus / TakeResult.
+
+Everything other than the searches themselves happens on the game thread,
+so none of these methods are safe to call from anywhere else. The searches
+run in between Updates, so the map mustn't be changed without a Flush
+first.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "NavigationMap.h"
+#include "../../Common/JobSystem.h"
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		enum class PathRequestStatus {
+			Unknown,	//never requested, cancelled, or already taken
+			Pending,
+			Found,
+			NotFound,
+			Expired
+		};
+
+		class PathRequestQueue {
+		public:
+			typedef int RequestID;
+			typedef std::function<void(RequestID, PathRequestStatus, NavigationPath&)> Callback;
+
+			PathRequestQueue(const NavigationMap& map, JobSystem& jobs);
+			~PathRequestQueue();
+
+			//A deadline of 0 means it'll wait as long as it takes. If there's
+			//a callback, it gets the result and the request is then
+			//forgotten about, otherwise it's kept until TakeResult
+			RequestID	Request(const Vector3& from, const Vector3& to, int priority = 0, float deadline = 0.0f, const Callback& callback = nullptr);
+			void		Cancel(RequestID id);
+
+			PathRequestStatus GetStatus(RequestID id) const;
+
+			//Moves the path out of a finished request, and forgets about it.
+			//Returns false if it isn't finished yet
+			bool TakeResult(RequestID id, NavigationPath& outPath);
+
+			//budget is the milliseconds of search the workers can do
+			//before they stop for the frame
+			void Update(float budget);
+
+			//Waits for the workers to finish whatever searches they're on,
+			//and hands out their results - callbacks included - so that
+			//nothing is reading the map until the next Update, and every
+			//path handed out so far was searched on the map as it is now.
+			//Call it before changing the map - NavigationGrid::SetWalkable
+			//and so on
+			void Flush();
+
+			//Requests waiting for, or in the middle of, a search
+			int GetPendingCount() const;
+
+		protected:
+			//One search, shared by every request that asked for the same
+			//start and goal nodes
+			struct Search {
+				enum State {
+					Waiting,
+					Searched,
+					Expired
+				};
+				Vector3					from;
+				Vector3					to;
+				int64_t					key;		//-1 if it can't be shared
+				int						priority;
+				uint64_t				order;		//so that equal priorities are first come, first served
+				std::atomic<int64_t>	deadline;	//GameTimer nanoseconds
+				std::vector<RequestID>	requests;
+
+				bool					inBatch;
+
+				//Written by the worker that takes it on
+				State					state;
+				bool					found;
+				NavigationPath			path;
+			};
+
+			struct PendingRequest {
+				PathRequestStatus	status;
+				Search*				search;
+				Callback			callback;
+				NavigationPath		path;
+			};
+
+			void StartBatch(float budget);
+			void FinishBatch();
+			void ProcessBatch();
+			void Deliver(Search& search);
+			void RemoveFinishedSearches();
+			void RunCallbacks();
+
+			const NavigationMap&	map;
+			JobSystem&				jobs;
+
+			std::unordered_map<RequestID, PendingRequest>		requests;
+			std::vector<std::unique_ptr<Search>>				searches;		//waiting, or in the batch
+			std::unordered_map<int64_t, Search*>				searchesByKey;
+			RequestID											nextID;
+			uint64_t											nextOrder;
+			int													pendingCount;
+
+			//Called at the end of Update or Flush, so that they can make new
+			//requests
+			std::vector<std::function<void()>>	callbacks;
+
+			//The searches being worked on, in order. Workers take the next
+			//one with batchNext; nothing else touches the batch until
+			//batchCounter says they're done
+			std::vector<Search*>	batch;
+			std::atomic<size_t>		batchNext;
+			int64_t					batchEnd;
+			JobCounter				batchCounter;
+			bool					batchRunning;
+		};
+	}
+}
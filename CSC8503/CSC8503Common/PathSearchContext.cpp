@@ -0,0 +1,9 @@
+#include "PathSearchContext.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+PathSearchContext& PathSearchContext::ForThisThread() {
+	static thread_local PathSearchContext context;
+	return context;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+Class:PathSearchContext
+Implements:
+Description:Everything an A* style search writes to while it runs - the open
+list, and each node's cost so far and parent - kept apart from the map being
+searched. That way a map never changes once it's loaded, and any number of
+searches can run over it at once, as long as each has its own context.
+
+A context can be used for search after search (and map after map) without
+being cleared: each search gets a new ID, and a node only counts as reached
+if its stamp matches the current ID. Only when the ID wraps around do the
+stamps need resetting. Contexts only ever grow, so once a thread has
+searched its biggest map it won't allocate again.
+
+Nodes are ints in [0, nodeCount), usually an index into the map's nodes.
+
+ForThisThread hands out one context per thread, which is what FindPath
+uses if it isn't given one.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "BinaryHeap.h"
+#include <vector>
+#include <algorithm>
+
+namespace NCL {
+	namespace CSC8503 {
+		class PathSearchContext {
+		public:
+			enum { NO_PARENT = -1 };
+
+			PathSearchContext() : searchID(0), nodesExpanded(0) {}
+
+			//Starts a new search over a map with nodeCount nodes
+			void BeginSearch(int nodeCount) {
+				if ((int)stamps.size() < nodeCount) {
+					stamps.resize(nodeCount, 0);
+					parents.resize(nodeCount);
+					costs.resize(nodeCount);
+					openList.SetCapacity(nodeCount); //empties it, too
+				}
+				else {
+					openList.Clear();
+				}
+				if (++searchID == 0) {
+					std::fill(stamps.begin(), stamps.end(), 0);
+					searchID = 1;
+				}
+				nodesExpanded = 0;
+			}
+
+			//Whether the current search has reached this node yet - if it
+			//has, it's closed once it's no longer in the open list
+			bool IsReached(int node) const {
+				return stamps[node] == searchID;
+			}
+
+			bool IsOpen(int node) const {
+				return openList.Contains(node);
+			}
+
+			//Sets the node's cost and parent, and puts it in the open list
+			//with the given priority, or lowers its priority if it's already
+			//there
+			void Open(int node, int parent, float g, float f) {
+				stamps[node]	= searchID;
+				parents[node]	= parent;
+				costs[node]		= g;
+				if (openList.Contains(node)) {
+					openList.DecreaseKey(node, f);
+				}
+				else {
+					openList.Push(node, f);
+				}
+			}
+
+			bool HasOpenNodes() const {
+				return !openList.Empty();
+			}
+
+			int PopBestNode() {
+				nodesExpanded++;
+				return openList.Pop();
+			}
+
+			//How many nodes the current search has taken off the open list
+			int GetNodesExpanded() const {
+				return nodesExpanded;
+			}
+
+			float GetCost(int node) const {
+				return costs[node];
+			}
+
+			int GetParent(int node) const {
+				return parents[node];
+			}
+
+			//One context per calling thread, created on first use
+			static PathSearchContext& ForThisThread();
+
+		protected:
+			IndexedMinHeap<float>		openList;
+			std::vector<unsigned int>	stamps;
+			std::vector<int>			parents;
+			std::vector<float>			costs;
+			unsigned int				searchID;
+			int							nodesExpanded;
+		};
+	}
+}
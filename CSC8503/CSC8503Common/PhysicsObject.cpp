@@ -11,6 +11,9 @@ PhysicsObject::PhysicsObject(Transform* parentTransform, const CollisionVolume*
 	inverseMass = 1.0f;
 	elasticity	= 0.8f;
 	friction	= 0.8f;
+
+	tensorDirty			= true;
+	isotropicInertia	= false;
 }
 
 PhysicsObject::~PhysicsObject()	{
@@ -18,7 +21,7 @@ PhysicsObject::~PhysicsObject()	{
 }
 
 void PhysicsObject::ApplyAngularImpulse(const Vector3& force) {
-	angularVelocity += inverseInteriaTensor * force;
+	angularVelocity += ApplyInverseInertia(force);
 }
 
 void PhysicsObject::ApplyLinearImpulse(const Vector3& force) {
@@ -52,6 +55,9 @@ void PhysicsObject::InitCubeInertia() {
 	inverseInertia.x = (12.0f * inverseMass) / (dimsSqr.y + dimsSqr.z);
 	inverseInertia.y = (12.0f * inverseMass) / (dimsSqr.x + dimsSqr.z);
 	inverseInertia.z = (12.0f * inverseMass) / (dimsSqr.x + dimsSqr.y);
+
+	isotropicInertia	= (inverseInertia.x == inverseInertia.y) && (inverseInertia.x == inverseInertia.z);
+	tensorDirty			= true;
 }
 
 void PhysicsObject::InitSphereInertia() {
@@ -59,13 +65,54 @@ void PhysicsObject::InitSphereInertia() {
 	float i			= 2.5f * inverseMass / (radius*radius);
 
 	inverseInertia = Vector3(i, i, i);
+
+	isotropicInertia	= true;
+	tensorDirty			= true;
 }
 
+/*
+The world inverse inertia tensor is R * D * R^T, where R is the orientation
+as a matrix, and D is our (diagonal) local inverse inertia. Rather than build
+R^T from a second quaternion and do two full matrix multiplies, each element
+is built straight from R, as T(i,j) = sum over k of R(i,k) * D(k) * R(j,k).
+The result is symmetric, so only 6 of the 9 values need working out.
+
+This gets called every substep, but most objects aren't rotating most of
+the time - so if the orientation hasn't changed, the last tensor still holds.
+*/
 void PhysicsObject::UpdateInertiaTensor() {
+	if (isotropicInertia) {
+		//The same whatever the orientation - ApplyInverseInertia doesn't
+		//even use it, but keep GetInertiaTensor valid
+		if (tensorDirty) {
+			inverseInteriaTensor	= Matrix3::Scale(inverseInertia);
+			tensorDirty				= false;
+		}
+		return;
+	}
 	Quaternion q = transform->GetWorldOrientation();
-	
-	Matrix3 invOrientation	= q.Conjugate().ToMatrix3();
-	Matrix3 orientation		= q.ToMatrix3();
 
-	inverseInteriaTensor = orientation * Matrix3::Scale(inverseInertia) *invOrientation;
-}
\ No newline at end of file
+	if (!tensorDirty &&
+		q.x == tensorOrientation.x && q.y == tensorOrientation.y &&
+		q.z == tensorOrientation.z && q.w == tensorOrientation.w) {
+		return;
+	}
+	tensorOrientation	= q;
+	tensorDirty			= false;
+
+	Matrix3 r = q.ToMatrix3();
+	const float* m = r.values;	//column major, so R(i,k) is m[k * 3 + i]
+	const Vector3& d = inverseInertia;
+
+	float* t = inverseInteriaTensor.values;
+
+	for (int i = 0; i < 3; ++i) {
+		for (int j = i; j < 3; ++j) {
+			float v = m[i] * d.x * m[j]
+					+ m[3 + i] * d.y * m[3 + j]
+					+ m[6 + i] * d.z * m[6 + j];
+			t[j * 3 + i] = v;
+			t[i * 3 + j] = v;
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "../../Common/Vector3.h"
 #include "../../Common/Matrix3.h"
+#include "../../Common/Quaternion.h"
 
 using namespace NCL::Maths;
 
@@ -62,12 +63,24 @@ namespace NCL {
 			void InitCubeInertia();
 			void InitSphereInertia();
 
+			//Rebuilds the world space inverse inertia tensor - but only if the
+			//orientation (or the inertia itself) has changed since last time
 			void UpdateInertiaTensor();
 
 			Matrix3 GetInertiaTensor() const {
 				return inverseInteriaTensor;
 			}
 
+			//World inverse inertia * v. Spheres (and anything else with the
+			//same inertia on every axis) skip the tensor altogether, as it's
+			//just a scale whatever the orientation is
+			Vector3 ApplyInverseInertia(const Vector3& v) const {
+				if (isotropicInertia) {
+					return v * inverseInertia.x;
+				}
+				return inverseInteriaTensor * v;
+			}
+
 		protected:
 			const CollisionVolume* volume;
 			Transform*		transform;
@@ -85,6 +98,10 @@ namespace NCL {
 			Vector3 torque;
 			Vector3 inverseInertia;
 			Matrix3 inverseInteriaTensor;
+
+			Quaternion	tensorOrientation;	//orientation the tensor was built for
+			bool		tensorDirty;
+			bool		isotropicInertia;
 		};
 	}
 }
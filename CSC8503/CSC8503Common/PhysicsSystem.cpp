@@ -3,12 +3,16 @@
 #include "GameObject.h"
 #include "CollisionDetection.h"
 #include "../../Common/Quaternion.h"
+#include "../../Common/FastMaths.h"
+#include "../../Common/Profiler.h"
 
 #include "Constraint.h"
 
 #include "Debug.h"
+#include "Metrics.h"
 
 #include <functional>
+#include <algorithm>
 using namespace NCL;
 using namespace CSC8503;
 
@@ -19,10 +23,36 @@ and the forces that are added to objects to change those positions
 
 */
 
+namespace {
+	//Milliseconds between start and now - start is then moved up to now,
+	//so that back to back phases can be timed with one Timepoint
+	float MillisecondsSince(Timepoint& start) {
+		Timepoint now = std::chrono::high_resolution_clock::now();
+		float ms = std::chrono::duration<float, std::milli>(now - start).count();
+		start = now;
+		return ms;
+	}
+
+	void RecordMetrics(const PhysicsSystem::UpdateStats& stats) {
+		static MetricCounter&	pairs		= Metrics::GetCounter("physics.broadphase_pairs");
+		static MetricCounter&	tests		= Metrics::GetCounter("physics.narrowphase_tests");
+		static MetricCounter&	contacts	= Metrics::GetCounter("physics.contacts");
+		static MetricCounter&	constraints	= Metrics::GetCounter("physics.constraints");
+		static MetricHistogram& updateTime	= Metrics::GetHistogram("physics.update_ms", { 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 });
+
+		pairs.Add(stats.broadphasePairs);
+		tests.Add(stats.narrowphaseTests);
+		contacts.Add(stats.contacts);
+		constraints.Add(stats.constraints);
+		updateTime.Record(stats.broadphaseTime + stats.narrowphaseTime + stats.solveTime + stats.integrateTime);
+	}
+}
+
 const float PhysicsSystem::UNIT_MULTIPLIER = 1.0f;
 const float PhysicsSystem::UNIT_RECIPROCAL = 1.0f / UNIT_MULTIPLIER;
 
 PhysicsSystem::PhysicsSystem(GameWorld& g) : gameWorld(g)	{
+	jobs			= nullptr;
 	applyGravity	= false;
 	useBroadPhase	= false;	
 	dTOffset		= 0.0f;
@@ -49,6 +79,7 @@ any collisions they are in.
 */
 void PhysicsSystem::Clear() {
 	allCollisions.clear();
+	collisionEvents.clear();
 }
 
 /*
@@ -57,6 +88,7 @@ This is the core of the physics engine update
 
 */
 void PhysicsSystem::Update(float dt) {
+	NCL_PROFILE_ZONE("Physics");
 	const float iterationDt = 1.0f / 240.0f; //Ideally we'll have 120 physics updates a second 
 	dTOffset += dt; //We accumulate time delta here - there might be remainders from previous frame!
 
@@ -66,15 +98,9 @@ void PhysicsSystem::Update(float dt) {
 
 	//IntegrateAccel(dt); //Update accelerations from external forces
 
-	for (int i = 0; i < iterationCount; ++i) {
-		if (useBroadPhase) {
-			BroadPhase();
-			NarrowPhase();
-		}
-		else {
-			
-		}
+	stats = UpdateStats();
 
+	for (int i = 0; i < iterationCount; ++i) {
 		//This is our simple iterative solver - 
 		//we just run things multiple times, slowly moving things forward
 		//and then rechecking that the constraints have been met
@@ -83,16 +109,39 @@ void PhysicsSystem::Update(float dt) {
 		float constraintDt = subDt / (float)constraintIterationCount;
 
 		for (int i = 0; i < constraintIterationCount; ++i) {
-			BasicCollisionDetection();
+			//Find the pairs that might be touching, either with the quadtree
+			//or by testing everything against everything...
+			Timepoint phaseStart = std::chrono::high_resolution_clock::now();
+			UpdateObjectAABBs();
+			if (useBroadPhase) {
+				BroadPhase();
+			}
+			else {
+				BasicCollisionDetection();
+			}
+			stats.broadphaseTime += MillisecondsSince(phaseStart);
+
+			//...then work out which of them really are, and push them apart
+			NarrowPhase();
+			phaseStart = std::chrono::high_resolution_clock::now();
+
 			IntegrateAccel(constraintDt);
 			IntegrateVelocity(constraintDt); //update positions from new velocity changes
+			stats.integrateTime += MillisecondsSince(phaseStart);
+
 			UpdateConstraints(constraintDt);
+			stats.solveTime += MillisecondsSince(phaseStart);
 		}
 		dTOffset -= iterationDt;
 	}
 	ClearForces();	//Once we've finished with the forces, reset them to zero
 
 	UpdateCollisionList(); //Remove any old collisions
+	if (!deferCallbacks) {
+		DispatchCollisionCallbacks();
+	}
+
+	RecordMetrics(stats);
 }
 
 /*
@@ -105,17 +154,19 @@ The frame they are to be removed, we tell them they're no longer colliding.
 From this simple mechanism, we we build up gameplay interactions inside the
 OnCollisionBegin / OnCollisionEnd functions (removing health when hit by a 
 rocket launcher, gaining a point when the player hits the gold coin, and so on).
+The objects aren't told straight away, though - the events are queued up, and
+handed out by DispatchCollisionCallbacks, so that they can be sent from the
+main thread when the physics is being updated on another.
 */
 void PhysicsSystem::UpdateCollisionList() {
+	NCL_PROFILE_ZONE("Physics::CollisionList");
 	for (std::set<CollisionDetection::CollisionInfo>::iterator i = allCollisions.begin(); i != allCollisions.end(); ) {
 		if ((*i).framesLeft == numCollisionFrames) {
-			i->a->OnCollisionBegin(i->b);
-			i->b->OnCollisionBegin(i->a);
+			collisionEvents.push_back({ i->a, i->b, true });
 		}
 		(*i).framesLeft = (*i).framesLeft - 1;
 		if ((*i).framesLeft < 0) {
-			i->a->OnCollisionEnd(i->b);
-			i->b->OnCollisionEnd(i->a);
+			collisionEvents.push_back({ i->a, i->b, false });
 			i = allCollisions.erase(i);
 		}
 		else {
@@ -124,6 +175,20 @@ void PhysicsSystem::UpdateCollisionList() {
 	}
 }
 
+void PhysicsSystem::DispatchCollisionCallbacks() {
+	for (const CollisionEvent& e : collisionEvents) {
+		if (e.begin) {
+			e.a->OnCollisionBegin(e.b);
+			e.b->OnCollisionBegin(e.a);
+		}
+		else {
+			e.a->OnCollisionEnd(e.b);
+			e.b->OnCollisionEnd(e.a);
+		}
+	}
+	collisionEvents.clear();
+}
+
 /*
 
 This is how we'll be doing collision detection in tutorial 4.
@@ -133,28 +198,49 @@ to the collision set for later processing. The set will guarantee that
 a particular pair will only be added once, so objects colliding for
 multiple frames won't flood the set with duplicates.
 */
+namespace {
+	//Spheres can give the broadphase a tighter bounding sphere than the one
+	//around their AABB - anything else uses the AABB's one (signalled by -1)
+	float BroadphaseRadius(const GameObject* object) {
+		const CollisionVolume* volume = object->GetBoundingVolume();
+		if (volume->type == VolumeType::Sphere) {
+			return ((const SphereVolume*)volume)->GetRadius();
+		}
+		return -1.0f;
+	}
+}
+
+/*
+The simplest possible broadphase - every object against every other object.
+Rather than run the full intersection test on every pair, every object's
+bounds are put into a ShapeBatch first, so that each object can be tested
+against 8 others at once - only the pairs whose bounds overlap are passed on
+to the narrowphase.
+*/
 void PhysicsSystem::BasicCollisionDetection() {
-	std::vector < GameObject * >::const_iterator first;
-	std::vector < GameObject * >::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	
-	for (auto i = first; i != last; ++i) {
-		if ((*i)->GetPhysicsObject() == nullptr) {
+	NCL_PROFILE_ZONE("Physics::AllPairs");
+	const ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
+
+	allShapes.Clear();
+	for (size_t i = 0; i < physicsObjects.GetSlotCount(); ++i) {
+		GameObject* object = physicsObjects.GetOwner(i);
+		Vector3 halfSizes;
+		if (!object || !object->GetBroadphaseAABB(halfSizes)) {
 			continue;
 		}
-		for (auto j = i + 1; j != last; ++j) {
-			if ((*j)->GetPhysicsObject() == nullptr) {
-				continue;
-			}
+		allShapes.Add(object, object->GetConstTransform().GetWorldPosition(), halfSizes, BroadphaseRadius(object));
+	}
+
+	broadphasePairs.clear();
+	for (int i = 0; i < allShapes.Size(); ++i) {
+		allShapes.ForEachOverlap(i, i + 1, [&](int j) {
 			CollisionDetection::CollisionInfo info;
-			if (CollisionDetection::ObjectIntersection(*i, *j, info)) {
-				//std::cout << "Collision between " << (*i)->GetName() << " and " << (*j)->GetName() << std::endl;
-				ImpulseResolveCollision(*info.a, *info.b, info.point);
-				info.framesLeft = numCollisionFrames;
-				allCollisions.insert(info);
-			}
-		}
+			info.a = allShapes.GetObject(i);
+			info.b = allShapes.GetObject(j);
+			broadphasePairs.emplace_back(info);
+		});
 	}
+	stats.broadphasePairs += (int)broadphasePairs.size();
 }
 
 /*
@@ -193,8 +279,8 @@ void PhysicsSystem::ImpulseResolveCollision(GameObject& a, GameObject& b, Collis
 	if (impulseForce > 0) return;
 
 	// now to work out the effect of inertia ....
-	Vector3 inertiaA = Vector3::Cross(physA->GetInertiaTensor() * Vector3::Cross(relativeA, p.normal), relativeA);
-	Vector3 inertiaB = Vector3::Cross(physB->GetInertiaTensor() * Vector3::Cross(relativeB, p.normal), relativeB);
+	Vector3 inertiaA = Vector3::Cross(physA->ApplyInverseInertia(Vector3::Cross(relativeA, p.normal)), relativeA);
+	Vector3 inertiaB = Vector3::Cross(physB->ApplyInverseInertia(Vector3::Cross(relativeB, p.normal)), relativeB);
 	float angularEffect = Vector3::Dot(inertiaA + inertiaB, p.normal);
 	
 	float cRestitution = 0.66f; // disperse some kinectic energy
@@ -218,59 +304,99 @@ compare the collisions that we absolutely need to.
 
 */
 void PhysicsSystem::BroadPhase() {
-	broadphaseCollisions.clear();
+	NCL_PROFILE_ZONE("Physics::BroadPhase");
+	broadphasePairs.clear();
 	QuadTree < GameObject * > tree(Vector2(1024, 1024), 7, 6);
 	
-	std::vector < GameObject * >::const_iterator first;
-	std::vector < GameObject * >::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	for (auto i = first; i != last; ++i) {
+	const ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
+	for (size_t i = 0; i < physicsObjects.GetSlotCount(); ++i) {
+		GameObject* object = physicsObjects.GetOwner(i);
 		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes)) {
+		if (!object || !object->GetBroadphaseAABB(halfSizes)) {
 			continue;
 		}
-		Vector3 pos = (*i)->GetConstTransform().GetWorldPosition();
-		tree.Insert(*i, pos, halfSizes);
+		Vector3 pos = object->GetConstTransform().GetWorldPosition();
+		tree.Insert(object, pos, halfSizes, BroadphaseRadius(object));
 	}
-	tree.OperateOnContents([&](std::list < QuadTreeEntry < GameObject * > >& data) {
+	tree.OperateOnContents([&](ShapeBatch<GameObject*>& data) {
 		CollisionDetection::CollisionInfo info;
-		
-		for (auto i = data.begin(); i != data.end(); ++i) {
-			for (auto j = std::next(i); j != data.end(); ++j) {
+
+		//Only pairs whose bounds actually overlap are worth a narrowphase test
+		for (int i = 0; i < data.Size(); ++i) {
+			data.ForEachOverlap(i, i + 1, [&](int j) {
 				// is this pair of items already in the collision set -
 				// if the same pair is in another quadtree node together etc
-				info.a = min((*i).object, (*j).object);
-				info.b = max((*i).object, (*j).object);
-				broadphaseCollisions.insert(info);
-			}
+				info.a = std::min(data.GetObject(i), data.GetObject(j));
+				info.b = std::max(data.GetObject(i), data.GetObject(j));
+				broadphasePairs.emplace_back(info);
+			});
 		}
 	});
+	//The same pair can turn up in more than one quadtree node, so get rid
+	//of the duplicates
+	auto pairOrder = [](const CollisionDetection::CollisionInfo& x, const CollisionDetection::CollisionInfo& y) {
+		return x.a != y.a ? x.a < y.a : x.b < y.b;
+	};
+	auto samePair = [](const CollisionDetection::CollisionInfo& x, const CollisionDetection::CollisionInfo& y) {
+		return x.a == y.a && x.b == y.b;
+	};
+	std::sort(broadphasePairs.begin(), broadphasePairs.end(), pairOrder);
+	broadphasePairs.erase(std::unique(broadphasePairs.begin(), broadphasePairs.end(), samePair), broadphasePairs.end());
+
+	stats.broadphasePairs += (int)broadphasePairs.size();
 }
 
 /*
 
 The broadphase will now only give us likely collisions, so we can now go through them,
-and work out if they are truly colliding, and if so, add them into the main collision list
+and work out if they are truly colliding, and if so, resolve them straight away and add
+them into the main collision list - so each pair is tested with wherever the pairs
+before it have pushed its objects to. The time spent resolving is timed separately,
+and counted as the solver's rather than the narrowphase's.
 */
 void PhysicsSystem::NarrowPhase() {
-	for (std::set < CollisionDetection::CollisionInfo >::iterator
-		i = broadphaseCollisions.begin();
-		i != broadphaseCollisions.end(); ++i) {
-		CollisionDetection::CollisionInfo info = *i;
+	NCL_PROFILE_ZONE("Physics::NarrowPhase");
+	Timepoint start		= std::chrono::high_resolution_clock::now();
+	float resolveTime	= 0.0f;
+	int contacts		= 0;
+
+	for (auto& pair : broadphasePairs) {
+		CollisionDetection::CollisionInfo info = pair;
 		if (CollisionDetection::ObjectIntersection(info.a, info.b, info)) {
+			Timepoint resolveStart = std::chrono::high_resolution_clock::now();
 			info.framesLeft = numCollisionFrames;
 			ImpulseResolveCollision(*info.a, *info.b, info.point);
 			allCollisions.insert(info); // insert into our main set
+			resolveTime += MillisecondsSince(resolveStart);
+			contacts++;
 		}
 	}
+	stats.narrowphaseTime	+= MillisecondsSince(start) - resolveTime;
+	stats.solveTime			+= resolveTime;
+	stats.narrowphaseTests	+= (int)broadphasePairs.size();
+	stats.contacts			+= contacts;
 }
 
+//Each object's bounds only depend on its own volume and orientation
 void PhysicsSystem::UpdateObjectAABBs() {
-	std::vector < GameObject * >::const_iterator first;
-	std::vector < GameObject * >::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-	for (auto i = first; i != last; ++i) {
-		(*i)->UpdateBroadphaseAABB();
+	NCL_PROFILE_ZONE("Physics::UpdateAABBs");
+	const ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
+	ForEachObject(physicsObjects.GetSlotCount(), [&](size_t start, size_t end) {
+		for (size_t i = start; i < end; ++i) {
+			if (GameObject* object = physicsObjects.GetOwner(i)) {
+				object->UpdateBroadphaseAABB();
+			}
+		}
+	});
+}
+
+void PhysicsSystem::ForEachObject(size_t count, const JobSystem::RangeFunc& func) const {
+	const size_t batchSize = 256;
+	if (jobs) {
+		jobs->ParallelFor(count, batchSize, func);
+	}
+	else {
+		func(0, count);
 	}
 }
 
@@ -284,40 +410,42 @@ based on any forces that have been accumulated in the objects during
 the course of the previous game frame.
 */
 void PhysicsSystem::IntegrateAccel(float dt) {
-	std::vector < GameObject * >::const_iterator first;
-	std::vector < GameObject * >::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
-
-	for (auto i = first; i != last; ++i) {
-		PhysicsObject * object = (*i)->GetPhysicsObject();
-		if (object == nullptr) {
-			continue; // No physics object for this GameObject !
-		}
+	NCL_PROFILE_ZONE("Physics::IntegrateAccel");
+	ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
+
+	//Every object's velocity only depends on its own forces
+	ForEachObject(physicsObjects.GetSlotCount(), [&](size_t start, size_t end) {
+		for (size_t i = start; i < end; ++i) {
+			PhysicsObject * object = physicsObjects.GetComponent(i);
+			if (!object) {
+				continue;
+			}
 
-		float inverseMass = object->GetInverseMass();
+			float inverseMass = object->GetInverseMass();
 
-		Vector3 linearVel = object->GetLinearVelocity();
-		Vector3 force = object->GetForce();
-		Vector3 accel = force * inverseMass;
+			Vector3 linearVel = object->GetLinearVelocity();
+			Vector3 force = object->GetForce();
+			Vector3 accel = force * inverseMass;
 
-		if (applyGravity && inverseMass > 0) {
-			accel += gravity; // don t move infinitely heavy things
-		}
+			if (applyGravity && inverseMass > 0) {
+				accel += gravity; // don t move infinitely heavy things
+			}
 
-		linearVel += accel * dt; // integrate accel !
-		object->SetLinearVelocity(linearVel); // previous code
+			linearVel += accel * dt; // integrate accel !
+			object->SetLinearVelocity(linearVel); // previous code
 
-		// Angular stuff
-		Vector3 torque = object->GetTorque();
-		Vector3 angVel = object->GetAngularVelocity();
+			// Angular stuff
+			Vector3 torque = object->GetTorque();
+			Vector3 angVel = object->GetAngularVelocity();
 
-		object->UpdateInertiaTensor(); // update tensor vs orientation
+			object->UpdateInertiaTensor(); // update tensor vs orientation
 
-		Vector3 angAccel = object->GetInertiaTensor() * torque;
+			Vector3 angAccel = object->ApplyInverseInertia(torque);
 
-		angVel += angAccel * dt; // integrate angular accel !
-		object->SetAngularVelocity(angVel);
-	}
+			angVel += angAccel * dt; // integrate angular accel !
+			object->SetAngularVelocity(angVel);
+		}
+	});
 }
 
 /*
@@ -325,23 +453,35 @@ This function integrates linear and angular velocity into
 position and orientation. It may be called multiple times
 throughout a physics update, to slowly move the objects through
 the world, looking for collisions.
+
+Moving a transform marks its parents and children dirty too, so only objects
+with neither can be moved in parallel - anything in a hierarchy is left for
+a second pass on this thread.
 */
 void PhysicsSystem::IntegrateVelocity(float dt) {
-	std::vector < GameObject * >::const_iterator first;
-	std::vector < GameObject * >::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
+	NCL_PROFILE_ZONE("Physics::IntegrateVelocity");
+	ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
 	float dampingFactor = 1.0f - 0.95f;
 	float frameDamping = powf(dampingFactor, dt);
-	
-	for (auto i = first; i != last; ++i) {
-		PhysicsObject * object = (*i)->GetPhysicsObject();
-		if (object == nullptr) {
-			continue;
+
+	auto isAlone = [&](size_t i) {
+		const Transform& transform = physicsObjects.GetOwner(i)->GetConstTransform();
+		return !transform.GetParent() && transform.GetChildren().empty();
+	};
+	auto integrate = [&](size_t i) {
+		PhysicsObject * object = physicsObjects.GetComponent(i);
+		Vector3 linearVel	= object->GetLinearVelocity();
+		Vector3 angVel		= object->GetAngularVelocity();
+
+		//Nothing to integrate, so don't touch the transform - otherwise every
+		//static object would be marked dirty and rebuilt every frame!
+		if (linearVel == Vector3() && angVel == Vector3()) {
+			return;
 		}
-		Transform & transform = (*i)->GetTransform();
+
+		Transform & transform = physicsObjects.GetOwner(i)->GetTransform();
 		// Position Stuff
 		Vector3 position = transform.GetLocalPosition();
-		Vector3 linearVel = object->GetLinearVelocity();
 		position += linearVel * dt;
 		transform.SetLocalPosition(position);
 		transform.SetWorldPosition(position);
@@ -351,16 +491,30 @@ void PhysicsSystem::IntegrateVelocity(float dt) {
 		
 		// Orientation Stuff
 		Quaternion orientation = transform.GetLocalOrientation();
-		Vector3 angVel = object->GetAngularVelocity();
 		
 		orientation = orientation + (Quaternion(angVel * dt * 0.5f, 0.0f) * orientation);
-		orientation.Normalise();
+		//A single step only nudges the length away from 1 by a tiny amount,
+		//so the cheap first order fix is good enough here
+		FastRenormalise(orientation);
 		
 		transform.SetLocalOrientation(orientation);
 		
 		// Damp the angular velocity too
 		angVel = angVel * frameDamping;
 		object->SetAngularVelocity(angVel);
+	};
+
+	ForEachObject(physicsObjects.GetSlotCount(), [&](size_t start, size_t end) {
+		for (size_t i = start; i < end; ++i) {
+			if (physicsObjects.GetOwner(i) && isAlone(i)) {
+				integrate(i);
+			}
+		}
+	});
+	for (size_t i = 0; i < physicsObjects.GetSlotCount(); ++i) {
+		if (physicsObjects.GetOwner(i) && !isAlone(i)) {
+			integrate(i);
+		}
 	}
 }
 
@@ -370,13 +524,13 @@ clear out any accumulated forces, ready to receive new
 ones in the next 'game' frame.
 */
 void PhysicsSystem::ClearForces() {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-	gameWorld.GetObjectIterators(first, last);
+	ComponentPool<PhysicsObject>& physicsObjects = gameWorld.GetPhysicsComponents();
 
-	for (auto i = first; i != last; ++i) {
+	for (size_t i = 0; i < physicsObjects.GetSlotCount(); ++i) {
 		//Clear our object's forces for the next frame
-		(*i)->GetPhysicsObject()->ClearForces();
+		if (PhysicsObject* object = physicsObjects.GetComponent(i)) {
+			object->ClearForces();
+		}
 	}
 }
 
@@ -389,6 +543,7 @@ us to model springs and ropes etc.
 
 */
 void PhysicsSystem::UpdateConstraints(float dt) {
+	NCL_PROFILE_ZONE("Physics::Constraints");
 	std::vector<Constraint*>::const_iterator first;
 	std::vector<Constraint*>::const_iterator last;
 	gameWorld.GetConstraintIterators(first, last);
@@ -396,4 +551,5 @@ void PhysicsSystem::UpdateConstraints(float dt) {
 	for (auto i = first; i != last; ++i) {
 		(*i)->UpdateConstraint(dt);
 	}
+	stats.constraints += (int)(last - first);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 #include "../CSC8503Common/GameWorld.h"
+#include "ShapeBatch.h"
+#include "../../Common/GameTimer.h"
+#include "../../Common/JobSystem.h"
 #include <set>
 
 namespace NCL {
@@ -23,6 +26,51 @@ namespace NCL {
 
 			void SetGravity(const Vector3& g);
 
+			//Swaps the all-pairs collision test for the QuadTree broadphase
+			void UseBroadPhase(bool state) {
+				useBroadPhase = state;
+			}
+
+			//The parts of the update that work on each object by itself are
+			//spread over the job system's workers. Without one, everything
+			//runs on the calling thread
+			void SetJobSystem(JobSystem* j) {
+				jobs = j;
+			}
+
+			//OnCollisionBegin / OnCollisionEnd are game code, and can do
+			//anything, so they have to run on the main thread. If Update is
+			//being run somewhere else, defer them, and they'll be queued up
+			//until DispatchCollisionCallbacks is called on the main thread
+			void DeferCollisionCallbacks(bool state) {
+				deferCallbacks = state;
+			}
+
+			void DispatchCollisionCallbacks();
+
+			//How long the last Update spent in each part of the physics, in
+			//milliseconds, along with how many object pairs went through it
+			struct UpdateStats {
+				float	broadphaseTime;
+				float	narrowphaseTime;
+				float	solveTime;
+				float	integrateTime;
+
+				int		broadphasePairs;	//candidate pairs from the broadphase
+				int		narrowphaseTests;	//pairs given the full intersection test
+				int		contacts;			//pairs that were actually touching
+				int		constraints;		//constraint updates
+
+				UpdateStats() {
+					broadphaseTime	= narrowphaseTime = solveTime = integrateTime = 0.0f;
+					broadphasePairs = narrowphaseTests = contacts = constraints = 0;
+				}
+			};
+
+			const UpdateStats& GetLastUpdateStats() const {
+				return stats;
+			}
+
 			static const float UNIT_MULTIPLIER;
 			static const float UNIT_RECIPROCAL;
 
@@ -42,9 +90,12 @@ namespace NCL {
 
 			void UpdateObjectAABBs();
 
+			void ForEachObject(size_t count, const JobSystem::RangeFunc& func) const;
+
 			void ImpulseResolveCollision(GameObject& a , GameObject&b, CollisionDetection::ContactPoint& p) const;
 
 			GameWorld& gameWorld;
+			JobSystem* jobs;
 
 			bool	applyGravity;
 			Vector3 gravity;
@@ -52,8 +103,20 @@ namespace NCL {
 			float	globalDamping;
 
 			std::set<CollisionDetection::CollisionInfo> allCollisions;
-			std::set<CollisionDetection::CollisionInfo> broadphaseCollisions;
+			std::vector<CollisionDetection::CollisionInfo> broadphasePairs;
+
+			struct CollisionEvent {
+				GameObject* a;
+				GameObject* b;
+				bool		begin;	//else it's ending
+			};
+			std::vector<CollisionEvent> collisionEvents;
+
+			ShapeBatch<GameObject*> allShapes;	//kept around to reuse its memory
+
+			UpdateStats stats;
 			bool useBroadPhase		= true;
+			bool deferCallbacks		= false;
 			int numCollisionFrames	= 5;
 
 		};
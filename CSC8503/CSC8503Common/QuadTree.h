@@ -1,7 +1,7 @@
 #pragma once
 #include "../../Common/Vector2.h"
 #include "Debug.h"
-#include <list>
+#include "ShapeBatch.h"
 #include <functional>
 
 namespace NCL {
@@ -10,23 +10,10 @@ namespace NCL {
 		template<class T>
 		class QuadTree;
 
-		template <class T>
-		struct QuadTreeEntry {
-			Vector3 pos;
-			Vector3 size;
-			T object;
-
-			QuadTreeEntry(T obj, Vector3 pos, Vector3 size) {
-				object = obj;
-				this->pos = pos;
-				this->size = size;
-			}
-		};
-
 		template<class T>
 		class QuadTreeNode {
 		public:
-			typedef std::function<void(std::list < QuadTreeEntry <T > >&) > QuadTreeFunc;
+			typedef std::function<void(ShapeBatch<T>&) > QuadTreeFunc;
 		protected:
 			friend class QuadTree<T>;
 
@@ -43,28 +30,28 @@ namespace NCL {
 				delete[] children;
 			}
 
-			void Insert(T& object, const Vector3 & objectPos, const Vector3 & objectSize, int depthLeft, int maxSize) {
-				if (!CollisionDetection::AABBTest(objectPos, Vector3(position.x, 0, position.y), objectSize, Vector3(size.x, 1000.0f, size.y))) {
+			void Insert(const T& object, const Vector3 & objectPos, const Vector3 & objectSize, float objectRadius, int depthLeft, int maxSize) {
+				if (!CollisionKernels::AABBOverlap<float>(objectPos, objectSize, Vector3(position.x, 0, position.y), Vector3(size.x, 1000.0f, size.y))) {
 					return;
 				}
 				if (children) { // not a leaf node , just descend the tree
 					for (int i = 0; i < 4; ++i) {
-						children[i].Insert(object, objectPos, objectSize, depthLeft - 1, maxSize);
+						children[i].Insert(object, objectPos, objectSize, objectRadius, depthLeft - 1, maxSize);
 					}
 				}
 				else { // currently a leaf node , can just expand
-					contents.push_back(QuadTreeEntry <T >(object, objectPos, objectSize));
-					if ((int)contents.size() > maxSize && depthLeft > 0) {
+					contents.Add(object, objectPos, objectSize, objectRadius);
+					if (contents.Size() > maxSize && depthLeft > 0) {
 						if (!children) {
 							Split();
 							// we need to reinsert the contents so far !
-							for (const auto & i : contents) {
+							for (int i = 0; i < contents.Size(); ++i) {
 								for (int j = 0; j < 4; ++j) {
-									auto entry = i;
-									children[j].Insert(entry.object, entry.pos, entry.size, depthLeft - 1, maxSize);
+									children[j].Insert(contents.GetObject(i), contents.GetCentre(i), contents.GetHalfSize(i),
+										contents.GetRadius(i), depthLeft - 1, maxSize);
 								}
 							}
-							contents.clear(); // contents now distributed !
+							contents.Clear(); // contents now distributed !
 						}
 					}
 				}
@@ -90,14 +77,14 @@ namespace NCL {
 
 				}
 				else {
-					if (!contents.empty()) {
+					if (!contents.Empty()) {
 						func(contents);
 					}
 				}
 			}
 
 		protected:
-			std::list< QuadTreeEntry<T> >    contents;
+			ShapeBatch<T>	contents;	//only used by leaves
 
 			Vector2 position;
 			Vector2 size;
@@ -123,8 +110,9 @@ namespace NCL {
 			~QuadTree() {
 			}
 
-			void Insert(T object, const Vector3 & pos, const Vector3 & size) {
-				root.Insert(object, pos, size, maxDepth, maxSize);
+			//A radius < 0 means use the sphere around the AABB
+			void Insert(T object, const Vector3 & pos, const Vector3 & size, float radius = -1.0f) {
+				root.Insert(object, pos, size, radius, maxDepth, maxSize);
 			}
 
 			void DebugDraw() {
@@ -0,0 +1,140 @@
+/******************************************************************************
+Class:ShapeBatch
+Implements:
+Description:A list of objects along with their broadphase bounds - a centre,
+AABB half sizes and a bounding sphere radius - stored as separate arrays of
+floats (Structure of Arrays) rather than as a list of structs. That lets one
+object be tested against 8 others at a time with the Floatx8 overlap kernels
+in CollisionKernels.h, with only the hits being handed back to be tested
+properly. Used for the QuadTree leaves, and for the all-pairs test in the
+PhysicsSystem.
+
+The arrays always have Width spare entries on the end, placed so far away
+that they never overlap anything, so that a batch of Width can be loaded
+from anywhere in the list without checking how many entries are left.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "CollisionKernels.h"
+#include <vector>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		template<class T>
+		class ShapeBatch {
+		public:
+			static const int Width = Floatx8::Width;
+
+			ShapeBatch() {
+				Clear();
+			}
+
+			void Clear() {
+				objects.clear();
+				for (int i = 0; i < ARRAY_COUNT; ++i) {
+					arrays[i].assign(Width, PaddingValue(i));
+				}
+			}
+
+			//A radius < 0 means use the sphere around the AABB
+			void Add(const T& object, const Vector3& centre, const Vector3& halfSize, float radius = -1.0f) {
+				const float values[ARRAY_COUNT] = {
+					centre.x, centre.y, centre.z,
+					halfSize.x, halfSize.y, halfSize.z,
+					radius < 0.0f ? halfSize.Length() : radius
+				};
+				int index = Size();
+				for (int i = 0; i < ARRAY_COUNT; ++i) {
+					arrays[i][index] = values[i];
+					arrays[i].push_back(PaddingValue(i));
+				}
+				objects.push_back(object);
+			}
+
+			int Size() const {
+				return (int)objects.size();
+			}
+
+			bool Empty() const {
+				return objects.empty();
+			}
+
+			const T& GetObject(int i) const {
+				return objects[i];
+			}
+
+			Vector3 GetCentre(int i) const {
+				return Vector3(arrays[X][i], arrays[Y][i], arrays[Z][i]);
+			}
+
+			Vector3 GetHalfSize(int i) const {
+				return Vector3(arrays[HALF_X][i], arrays[HALF_Y][i], arrays[HALF_Z][i]);
+			}
+
+			float GetRadius(int i) const {
+				return arrays[RADIUS][i];
+			}
+
+			/*
+			Tests entry i against entries first to first + Width - 1, and
+			returns a bitmask of which ones overlap it - both their AABBs and
+			their bounding spheres must overlap, as both can be a better fit
+			depending on the shape. Bits past the end of the list are always 0.
+			*/
+			int OverlapMask(int i, int first) const {
+				typedef Vector3Wide<Floatx8> Vec;
+
+				Vec		centre(GetCentre(i));
+				Vec		halfSize(GetHalfSize(i));
+				Floatx8 radius(GetRadius(i));
+
+				Vec others(Floatx8::Load(&arrays[X][first]), Floatx8::Load(&arrays[Y][first]), Floatx8::Load(&arrays[Z][first]));
+				Vec otherSizes(Floatx8::Load(&arrays[HALF_X][first]), Floatx8::Load(&arrays[HALF_Y][first]), Floatx8::Load(&arrays[HALF_Z][first]));
+				Floatx8 otherRadii = Floatx8::Load(&arrays[RADIUS][first]);
+
+				Floatx8 hits =
+					CollisionKernels::AABBOverlap<Floatx8>(centre, halfSize, others, otherSizes) &
+					CollisionKernels::SphereOverlap<Floatx8>(centre, radius, others, otherRadii);
+
+				return Floatx8::MoveMask(hits);
+			}
+
+			//Calls func(j) for every entry j >= first that overlaps entry i
+			template<class Func>
+			void ForEachOverlap(int i, int first, Func func) const {
+				int count = Size();
+				for (int j = first; j < count; j += Width) {
+					int mask = OverlapMask(i, j);
+					for (int k = 0; mask; ++k, mask >>= 1) {
+						if (mask & 1) {
+							func(j + k);
+						}
+					}
+				}
+			}
+
+		protected:
+			enum Arrays {
+				X, Y, Z,
+				HALF_X, HALF_Y, HALF_Z,
+				RADIUS,
+				ARRAY_COUNT
+			};
+
+			//Padding entries are zero sized, and far enough away to never
+			//overlap anything - but not so far that the maths overflows
+			static float PaddingValue(int array) {
+				return array <= Z ? 1e18f : 0.0f;
+			}
+
+			std::vector<float>	arrays[ARRAY_COUNT];
+			std::vector<T>		objects;
+		};
+	}
+}
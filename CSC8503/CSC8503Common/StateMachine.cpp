@@ -7,6 +7,7 @@ using namespace NCL::CSC8503;
 StateMachine::StateMachine()
 {
 	activeState = nullptr;
+	threadSafe	= false;
 }
 
 StateMachine::~StateMachine()
@@ -23,8 +23,21 @@ namespace NCL {
 
 			void Update();
 
+			//State machines are updated one after another on the main thread,
+			//unless they say they're safe to run on the job system's workers -
+			//which means they only ever touch their own object, and never call
+			//anything that isn't thread-safe, like the renderer or the input
+			void SetThreadSafe(bool state) {
+				threadSafe = state;
+			}
+
+			bool IsThreadSafe() const {
+				return threadSafe;
+			}
+
 		protected:
 			State * activeState;
+			bool	threadSafe;
 
 			std::vector<State*> allStates;
 
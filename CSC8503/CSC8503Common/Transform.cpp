@@ -1,53 +1,116 @@
 #include "Transform.h"
+#include "../../Common/TRSBatch.h"
+#include <algorithm>
 
 using namespace NCL::CSC8503;
 
+int Transform::hierarchyVersion = 0;
+
 Transform::Transform()	{
 	parent		= nullptr;
+	worldMatrix	= &ownWorldMatrix;
 	localScale	= Vector3(1,1,1);
+	localDirty	= true;
+	worldDirty	= true;
+	childDirty	= false;
 }
 
 Transform::Transform(const Vector3& position, Transform* p) {
-	parent = p;
+	parent		= nullptr;
+	worldMatrix	= &ownWorldMatrix;
+	localScale	= Vector3(1, 1, 1);
+	localDirty	= true;
+	worldDirty	= true;
+	childDirty	= false;
+	SetParent(p);
 	SetWorldPosition(position);
 }
 
 Transform::~Transform(){
+	SetParent(nullptr);
+	for (auto& i : children) {
+		i->parent = nullptr;
+		i->MarkDirty();
+	}
+	if (!children.empty()) {
+		hierarchyVersion++;
+	}
+}
+
+void Transform::SetParent(Transform* newParent) {
+	if (newParent == parent) {
+		return;
+	}
+	if (parent) {
+		vector<Transform*>& siblings = parent->children;
+		siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+	}
+	parent = newParent;
+	if (parent) {
+		parent->children.emplace_back(this);
+	}
+	hierarchyVersion++;
+	MarkDirty(); //a root's local matrix only ever got built into its world matrix
+}
+
+/*
+A change to our local values means our local matrix needs rebuilding, and
+that our world matrix - and the world matrix of everything below us - is
+now out of date. Everything above us gets told that it has a dirty child,
+so that an update pass knows it can't skip that part of the hierarchy.
+*/
+void Transform::MarkDirty() {
+	localDirty = true;
+	MarkWorldDirty();
+}
+
+void Transform::MarkWorldDirty() {
+	worldDirty = true;
+	for (auto& i : children) {
+		i->MarkWorldDirty();
+	}
+	for (Transform* p = parent; p && !p->childDirty; p = p->parent) {
+		p->childDirty = true;
+	}
 }
 
 void Transform::UpdateMatrices() {
-	localMatrix = 
-		Matrix4::Translation(localPosition) * 
-		localOrientation.ToMatrix4() *
-		Matrix4::Scale(localScale);
+	if (localDirty) {
+		localMatrix = TRSBatch::Compose(localPosition, localOrientation, localScale);
+		localDirty = false;
+		worldDirty = true;
+	}
+	if (!worldDirty) {
+		return;
+	}
 
 	if (parent) {
-		worldMatrix			= parent->GetWorldMatrix() * localMatrix;
+		*worldMatrix		= parent->GetWorldMatrix() * localMatrix;
 		worldOrientation	= parent->GetWorldOrientation() * localOrientation;
 	}
 	else {
-		worldMatrix			= localMatrix;
+		*worldMatrix		= localMatrix;
 		worldOrientation	= localOrientation;
 	}
+	worldDirty = false;
 }
 
 void Transform::SetWorldPosition(const Vector3& worldPos) {
 	if (parent) {
-		Vector3 parentPos = parent->GetWorldMatrix().GetPositionVector();
-		Vector3 posDiff = parentPos - worldPos;
-
-		localPosition = posDiff;
-		localMatrix.SetPositionVector(posDiff);
-		worldMatrix.SetPositionVector(posDiff);
+		localPosition = parent->GetWorldMatrix().Inverse() * worldPos;
 	}
 	else {
 		localPosition = worldPos;
 	}
-	worldMatrix.SetPositionVector(worldPos);
+	//Keep the world position valid straight away, as physics reads it back
+	//before the next transform update
+	worldMatrix->SetPositionVector(worldPos);
+	MarkDirty();
 }
 
 void Transform::SetLocalPosition(const Vector3& localPos) {
 	localPosition = localPos;
+	MarkDirty();
 }
 
 void Transform::SetWorldScale(const Vector3& worldScale) {
@@ -57,8 +120,22 @@ void Transform::SetWorldScale(const Vector3& worldScale) {
 	else {
 		localScale = worldScale;
 	}
+	MarkDirty();
 }
 
 void Transform::SetLocalScale(const Vector3& newScale) {
 	localScale = newScale;
-}
\ No newline at end of file
+	MarkDirty();
+}
+
+void Transform::AttachWorldMatrix(Matrix4* slot) {
+	*slot		= *worldMatrix;
+	worldMatrix	= slot;
+}
+
+void Transform::DetachWorldMatrix() {
+	if (worldMatrix != &ownWorldMatrix) {
+		ownWorldMatrix	= *worldMatrix;
+		worldMatrix		= &ownWorldMatrix;
+	}
+}
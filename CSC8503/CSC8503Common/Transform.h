@@ -11,13 +11,22 @@ using namespace NCL::Maths;
 
 namespace NCL {
 	namespace CSC8503 {
+		class GameWorld;
+
 		class Transform
 		{
 		public:
+			friend class GameWorld;
+
 			Transform();
 			Transform(const Vector3& position, Transform* parent = nullptr);
 			~Transform();
 
+			//A world matrix might be living in a GameWorld's buffer, so
+			//transforms can't be copied around
+			Transform(const Transform&)				= delete;
+			Transform& operator=(const Transform&)	= delete;
+
 			void SetWorldPosition(const Vector3& worldPos);
 			void SetLocalPosition(const Vector3& localPos);
 
@@ -28,20 +37,24 @@ namespace NCL {
 				return parent;
 			}
 
-			void SetParent(Transform* newParent) {
-				parent = newParent;
+			void SetParent(Transform* newParent);
+
+			const vector<Transform*>& GetChildren() const {
+				return children;
 			}
 
-			Matrix4 GetWorldMatrix() const {
-				return worldMatrix;
+			const Matrix4& GetWorldMatrix() const {
+				return *worldMatrix;
 			}
 
-			Matrix4 GetLocalMatrix() const {
-				return localMatrix;
+			//Without a parent, the local matrix is the world matrix, and
+			//only gets built straight into that
+			const Matrix4& GetLocalMatrix() const {
+				return parent ? localMatrix : *worldMatrix;
 			}
 
 			Vector3 GetWorldPosition() const {
-				return worldMatrix.GetPositionVector();
+				return worldMatrix->GetPositionVector();
 			}
 
 			Vector3 GetLocalPosition() const {
@@ -58,6 +71,7 @@ namespace NCL {
 
 			void SetLocalOrientation(const Quaternion& newOr) {
 				localOrientation = newOr;
+				MarkDirty();
 			}
 
 			Quaternion GetWorldOrientation() const {
@@ -68,11 +82,47 @@ namespace NCL {
 				return worldOrientation.Conjugate().ToMatrix3();
 			}
 
+			//Rebuilds the matrices, but only if something has changed since
+			//the last update. The parent must be up to date first!
 			void UpdateMatrices();
 
+			bool IsLocalDirty() const {
+				return localDirty;
+			}
+
+			bool IsDirty() const {
+				return localDirty || worldDirty;
+			}
+
+			//True if something below this transform in the hierarchy has
+			//changed - if this is false and we're not dirty either, the
+			//whole subtree can be skipped
+			bool HasDirtyChildren() const {
+				return childDirty;
+			}
+
+			void ClearDirtyChildren() {
+				childDirty = false;
+			}
+
+			//Bumped every time any parent / child link changes, so anything
+			//that caches the hierarchy order knows when to rebuild it
+			static int GetHierarchyVersion() {
+				return hierarchyVersion;
+			}
+
 		protected:
+			//Moves the world matrix into a slot of the GameWorld's buffer,
+			//and back out again when it leaves the world
+			void AttachWorldMatrix(Matrix4* slot);
+			void DetachWorldMatrix();
+
+			void MarkDirty();
+			void MarkWorldDirty();
+
 			Matrix4		localMatrix;
-			Matrix4		worldMatrix;
+			Matrix4*	worldMatrix;	//either ownWorldMatrix, or a slot in a GameWorld
+			Matrix4		ownWorldMatrix;
 
 			Vector3		localPosition;
 			Vector3		localScale;
@@ -82,6 +132,12 @@ namespace NCL {
 			Transform*	parent;
 
 			vector<Transform*> children;
+
+			bool localDirty;	//local matrix needs rebuilding
+			bool worldDirty;	//we, or something above us, has changed
+			bool childDirty;	//something below us has changed
+
+			static int hierarchyVersion;
 		};
 	}
 }
@@ -0,0 +1,39 @@
+#include "WorldBuilder.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "PhysicsObject.h"
+#include "AABBVolume.h"
+#include "SphereVolume.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+GameObject* WorldBuilder::AddCube(GameWorld& world, const Vector3& position, const Vector3& halfSize, float inverseMass, const std::string& name) {
+	GameObject* cube = new GameObject(name);
+
+	cube->SetBoundingVolume((CollisionVolume*)new AABBVolume(halfSize));
+	cube->GetTransform().SetWorldPosition(position);
+	cube->GetTransform().SetWorldScale(halfSize);
+
+	world.AddGameObject(cube);
+
+	PhysicsObject* physics = cube->SetPhysicsObject(PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
+	physics->SetInverseMass(inverseMass);
+	physics->InitCubeInertia();
+	return cube;
+}
+
+GameObject* WorldBuilder::AddSphere(GameWorld& world, const Vector3& position, float radius, float inverseMass, const std::string& name) {
+	GameObject* sphere = new GameObject(name);
+
+	sphere->SetBoundingVolume((CollisionVolume*)new SphereVolume(radius));
+	sphere->GetTransform().SetWorldScale(Vector3(radius, radius, radius));
+	sphere->GetTransform().SetWorldPosition(position);
+
+	world.AddGameObject(sphere);
+
+	PhysicsObject* physics = sphere->SetPhysicsObject(PhysicsObject(&sphere->GetTransform(), sphere->GetBoundingVolume()));
+	physics->SetInverseMass(inverseMass);
+	physics->InitSphereInertia();
+	return sphere;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "../../Common/Vector3.h"
+#include <string>
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameWorld;
+		class GameObject;
+
+		/*
+		The simple shapes that test scenes are built out of. Each is given a
+		bounding volume, scaled to match, added to the world, and then given
+		a PhysicsObject with the right inertia - in that order, so that the
+		component goes straight into the world's pool. There's no
+		RenderObject, as servers and benchmarks don't draw anything - a game
+		that does can give the object one afterwards.
+		*/
+		class WorldBuilder {
+		public:
+			static GameObject* AddCube(GameWorld& world, const Vector3& position, const Vector3& halfSize, float inverseMass, const std::string& name = "Cube");
+			static GameObject* AddSphere(GameWorld& world, const Vector3& position, float radius, float inverseMass, const std::string& name = "Sphere");
+
+		protected:
+			WorldBuilder() {}
+			~WorldBuilder() {}
+		};
+	}
+}
@@ -3,6 +3,8 @@
 #include "../../Common/Camera.h"
 #include "../../Common/Vector2.h"
 #include "../../Common/Vector3.h"
+#include "../../Common/Profiler.h"
+#include "../CSC8503Common/Metrics.h"
 using namespace NCL;
 using namespace Rendering;
 using namespace CSC8503;
@@ -40,6 +42,8 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 	lightColour = Vector4(1.0f, 1.0f, 0.5f, 1.0f);
 	lightRadius = 800.0f;
 	lightPosition = Vector3(-200.0f, 250.0f, -200.0f);
+
+	objectListReady = false;
 }
 
 GameTechRenderer::~GameTechRenderer()	{
@@ -48,31 +52,42 @@ GameTechRenderer::~GameTechRenderer()	{
 }
 
 void GameTechRenderer::RenderFrame() {
+	NCL_PROFILE_ZONE("Render::Frame");
+	static MetricGauge& objectCount = Metrics::GetGauge("render.objects");
 	glEnable(GL_CULL_FACE);
 	glClearColor(1, 1, 1, 1);
-	BuildObjectList();
+	if (!objectListReady) { //Nobody's built it for us this frame
+		BuildObjectList();
+	}
 	SortObjectList();
 	RenderShadowMap();
 	RenderCamera();
 	glDisable(GL_CULL_FACE); //Todo - text indices are going the wrong way...
+	objectListReady = false;
+
+	objectCount.Set((double)activeObjects.size());
 }
 
 void GameTechRenderer::BuildObjectList() {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	gameWorld.GetObjectIterators(first, last);
+	NCL_PROFILE_ZONE("Render::BuildObjectList");
+	const ComponentPool<RenderObject>& renderObjects = gameWorld.GetRenderComponents();
 
 	activeObjects.clear();
-
-	for (std::vector<GameObject*>::const_iterator i = first; i != last; ++i) {
-		if ((*i)->IsActive()) {
-			const RenderObject*g = (*i)->GetRenderObject();
-			if (g) {
-				activeObjects.emplace_back(g);
-			}
+	activeObjects.reserve(renderObjects.Size());
+	activeMatrices.clear();
+	activeMatrices.reserve(renderObjects.Size());
+
+	//The model matrices aren't copied - they're read straight out of the
+	//world's matrix buffer, which the transform update has just written
+	for (size_t i = 0; i < renderObjects.GetSlotCount(); ++i) {
+		const GameObject* owner = renderObjects.GetOwner(i);
+		if (owner && owner->IsActive()) {
+			const RenderObject* o = renderObjects.GetComponent(i);
+			activeObjects.emplace_back(o);
+			activeMatrices.emplace_back(&o->GetTransform()->GetWorldMatrix());
 		}
 	}
+	objectListReady = true;
 }
 
 void GameTechRenderer::SortObjectList() {
@@ -80,6 +95,7 @@ void GameTechRenderer::SortObjectList() {
 }
 
 void GameTechRenderer::RenderShadowMap() {
+	static MetricCounter& drawCalls = Metrics::GetCounter("render.draw_calls");
 	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
 	glClear(GL_DEPTH_BUFFER_BIT);
 	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
@@ -97,13 +113,13 @@ void GameTechRenderer::RenderShadowMap() {
 
 	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
 
-	for (const auto&i : activeObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetWorldMatrix();
-		Matrix4 mvpMatrix	= mvMatrix * modelMatrix;
+	for (size_t i = 0; i < activeObjects.size(); ++i) {
+		Matrix4 mvpMatrix	= mvMatrix * *activeMatrices[i];
 		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
-		BindMesh((*i).GetMesh());
+		BindMesh(activeObjects[i]->GetMesh());
 		DrawBoundMesh();
 	}
+	drawCalls.Add(activeObjects.size());
 
 	glViewport(0, 0, currentWidth, currentHeight);
 	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
@@ -113,6 +129,7 @@ void GameTechRenderer::RenderShadowMap() {
 }
 
 void GameTechRenderer::RenderCamera() {
+	static MetricCounter& drawCalls = Metrics::GetCounter("render.draw_calls");
 	float screenAspect = (float)currentWidth / (float)currentHeight;
 	Matrix4 viewMatrix = gameWorld.GetMainCamera()->BuildViewMatrix();
 	Matrix4 projMatrix = gameWorld.GetMainCamera()->BuildProjectionMatrix(screenAspect);
@@ -134,7 +151,8 @@ void GameTechRenderer::RenderCamera() {
 	glActiveTexture(GL_TEXTURE0 + 1);
 	glBindTexture(GL_TEXTURE_2D, shadowTex);
 
-	for (const auto&i : activeObjects) {
+	for (size_t o = 0; o < activeObjects.size(); ++o) {
+		const RenderObject* i = activeObjects[o];
 		OGLShader* shader = (OGLShader*)(*i).GetShader();
 		BindShader(shader);
 
@@ -167,7 +185,7 @@ void GameTechRenderer::RenderCamera() {
 			activeShader = shader;
 		}
 
-		Matrix4 modelMatrix = (*i).GetTransform()->GetWorldMatrix();
+		const Matrix4& modelMatrix = *activeMatrices[o];
 		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);			
 		
 		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
@@ -178,6 +196,7 @@ void GameTechRenderer::RenderCamera() {
 		BindMesh((*i).GetMesh());
 		DrawBoundMesh();
 	}
+	drawCalls.Add(activeObjects.size());
 }
 
 void GameTechRenderer::SetupDebugMatrix(OGLShader*s) {
@@ -17,6 +17,10 @@ namespace NCL {
 			GameTechRenderer(GameWorld& world);
 			~GameTechRenderer();
 
+			//Gathers up everything to be drawn this frame. This doesn't touch
+			//OpenGL, so can be run as a job while the main thread is busy
+			void BuildObjectList();
+
 		protected:
 			void RenderFrame()	override;
 
@@ -24,7 +28,6 @@ namespace NCL {
 
 			GameWorld&	gameWorld;
 
-			void BuildObjectList();
 			void SortObjectList();
 			void RenderShadowMap();
 			void RenderCamera(); 
@@ -32,6 +35,8 @@ namespace NCL {
 			void SetupDebugMatrix(OGLShader*s) override;
 
 			vector<const RenderObject*> activeObjects;
+			vector<const Matrix4*>		activeMatrices;	//into the world's matrix buffer
+			bool						objectListReady;
 
 			//shadow mapping things
 			OGLShader*	shadowShader;
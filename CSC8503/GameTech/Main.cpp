@@ -1,4 +1,5 @@
 #include "../../Common/Window.h"
+#include "../../Common/Profiler.h"
 
 #include "../CSC8503Common/StateMachine.h"
 #include "../CSC8503Common/StateTransition.h"
@@ -8,6 +9,7 @@
 #include "../CSC8503Common/GameClient.h"
 
 #include "../CSC8503Common/NavigationGrid.h"
+#include "../CSC8503Common/Metrics.h"
 
 #include "TutorialGame.h"
 #include "NetworkedGame.h"
@@ -26,6 +28,7 @@ int main() {
 	w->LockMouseToWindow(false);
 
 	TutorialGame* g = new TutorialGame();
+	Profiler::SetThreadName("Main");
 
 	while (w->UpdateWindow() && !Window::GetKeyboard()->KeyDown(KEYBOARD_ESCAPE)) {
 		float dt = w->GetTimer()->GetTimeDelta() / 1000.0f;
@@ -43,6 +46,8 @@ int main() {
 		w->SetTitle("Gametech frame time:" + std::to_string(1000.0f * dt));
 
 		g->UpdateGame(dt);
+		Profiler::EndFrame();
+		Metrics::EndFrame(dt);
 	}
 	Window::DestroyGameWindow();
 }
\ No newline at end of file
@@ -7,8 +7,12 @@
 #include "../../Common/TextureLoader.h"
 
 #include "../CSC8503Common/PositionConstraint.h"
+#include "../CSC8503Common/WorldBuilder.h"
+#include "../../Common/Profiler.h"
+#include "../CSC8503Common/Metrics.h"
 
 #include <math.h>
+#include <iostream>
 
 using namespace NCL;
 using namespace CSC8503;
@@ -17,10 +21,18 @@ TutorialGame::TutorialGame()	{
 	world		= new GameWorld();
 	renderer	= new GameTechRenderer(*world);
 	physics		= new PhysicsSystem(*world);
+	jobs		= new JobSystem();
+
+	world->SetJobSystem(jobs);
+	physics->SetJobSystem(jobs);
+	physics->DeferCollisionCallbacks(true);	//physics runs as a job
 
 	forceMagnitude	= 100.0f;
 	useGravity		= true;
 	inSelectionMode = false;
+	showProfiler	= false;
+	logMetrics		= false;
+	frameDT			= 0.0f;
 
 	Debug::SetRenderer(renderer);
 
@@ -41,6 +53,63 @@ void TutorialGame::InitialiseAssets() {
 	
 	InitCamera();
 	InitWorld();
+	InitFrameGraph();
+}
+
+/*
+Each frame's update is split up into phases, which the FrameGraph runs as
+jobs. AI decides what everything wants to do, physics moves everything,
+the transforms are then brought up to date, and finally the renderer can
+gather up what it needs to draw. Each phase needs the last one finished,
+so the parallelism is inside them - the thread-safe state machines, the
+per-object parts of the physics, and each separate transform hierarchy are
+all split over the workers. Anything touching OpenGL, the window or the
+input stays on the main thread, in UpdateGame - including the camera, which
+reads the mouse and keyboard, the state machines that haven't said they're
+thread-safe, and the collision callbacks, which the physics queues up for
+UpdateGame to send out once the graph has finished.
+*/
+void TutorialGame::InitFrameGraph() {
+	FrameGraph::NodeID ai = frameGraph.AddNode("AI", [&]() {
+		UpdateStateMachines(true);
+	});
+	FrameGraph::NodeID phys = frameGraph.AddNode("Physics", [&]() {
+		physics->Update(frameDT);
+	});
+	FrameGraph::NodeID transforms = frameGraph.AddNode("Transforms", [&]() {
+		world->UpdateWorld(frameDT);
+	});
+	FrameGraph::NodeID renderList = frameGraph.AddNode("Render List", [&]() {
+		renderer->BuildObjectList();
+	});
+
+	frameGraph.AddDependency(ai, phys);
+	frameGraph.AddDependency(phys, transforms);
+	frameGraph.AddDependency(transforms, renderList);
+}
+
+//Updates either the state machines that are safe to run on the workers, in
+//parallel, or the rest, one at a time on the calling thread
+void TutorialGame::UpdateStateMachines(bool threadSafe) {
+	std::vector<StateMachine*>::const_iterator first;
+	std::vector<StateMachine*>::const_iterator last;
+	world->GetStateMachineIterators(first, last);
+
+	if (!threadSafe) {
+		for (auto i = first; i != last; ++i) {
+			if (!(*i)->IsThreadSafe()) {
+				(*i)->Update();
+			}
+		}
+		return;
+	}
+	jobs->ParallelFor((size_t)(last - first), 16, [&](size_t start, size_t end) {
+		for (size_t i = start; i < end; ++i) {
+			if ((*(first + i))->IsThreadSafe()) {
+				(*(first + i))->Update();
+			}
+		}
+	});
 }
 
 
@@ -50,6 +119,7 @@ TutorialGame::~TutorialGame()	{
 	delete basicTex;
 	delete basicShader;
 
+	delete jobs;
 	delete physics;
 	delete renderer;
 	delete world;
@@ -58,7 +128,6 @@ TutorialGame::~TutorialGame()	{
 void TutorialGame::UpdateGame(float dt) {
 	if (!inSelectionMode) {
 		Debug::Print("Q: Free Mode!", Vector2(10, 620));
-		world->GetMainCamera()->UpdateCamera(dt);
 	}
 	else {
 		Debug::Print("Q: Select Mode!", Vector2(10, 620));
@@ -68,11 +137,21 @@ void TutorialGame::UpdateGame(float dt) {
 	} else { 
 		Debug::Print("G: Gravity off", Vector2(10, 590)); 
 	}
+	if (showProfiler) {
+		PrintProfilerSummary();
+	}
 
 	UpdateKeys();
 
+	if (!inSelectionMode) {
+		world->GetMainCamera()->UpdateCamera(dt);
+	}
+
 	//We need this stuffs
-	world->UpdateWorld(dt);
+	frameDT = dt;
+	UpdateStateMachines(false);
+	frameGraph.Execute(*jobs);
+	physics->DispatchCollisionCallbacks();
 	renderer->Update(dt);
 
 	Debug::FlushRenderables();
@@ -96,6 +175,42 @@ void TutorialGame::UpdateKeys() {
 			Window::GetWindow()->LockMouseToWindow(true);
 		}
 	}
+
+	if (Window::GetKeyboard()->KeyPressed(KEYBOARD_P)) {
+		showProfiler = !showProfiler;
+	}
+	if (Window::GetKeyboard()->KeyPressed(KEYBOARD_F9)) {
+		if (Profiler::WriteChromeTrace("profile.json")) {
+			std::cout << "Profile written to profile.json" << std::endl;
+		}
+	}
+	if (Window::GetKeyboard()->KeyPressed(KEYBOARD_F10)) {
+		logMetrics = !logMetrics;
+		if (logMetrics) {
+			Metrics::OutputToFile("metrics.json", 1.0f);
+		}
+		else {
+			Metrics::CloseOutput();
+		}
+	}
+}
+
+/*
+Prints where the last frame's time went, longest first, indented by how
+deeply nested each zone is. Times include any nested zones, so they won't
+add up to the frame time!
+*/
+void TutorialGame::PrintProfilerSummary() {
+	const int maxLines = 16;
+
+	Debug::Print("P: Profiler - frame " + std::to_string(Profiler::GetFrameTime()) + "ms (F9 saves a trace, F10 logs metrics)", Vector2(10, 560));
+
+	const auto& zones = Profiler::GetFrameSummary();
+	for (int i = 0; i < (int)zones.size() && i < maxLines; ++i) {
+		const Profiler::ZoneSummary& z = zones[i];
+		std::string line = std::string(z.depth * 2, ' ') + z.name + ": " + std::to_string(z.milliseconds) + "ms x" + std::to_string(z.calls);
+		Debug::Print(line, Vector2(10, 540.0f - i * 20.0f), Vector4(1, 1, 0, 1));
+	}
 }
 
 void TutorialGame::InitCamera() {
@@ -114,62 +229,28 @@ void TutorialGame::InitWorld() {
 	AddFloorToWorld(Vector3(0.0f, 0.0f, 0.0f), Vector3(100.0f, 1.0f, 100.0f));
 }
 
+/*
+The shapes themselves are built by the WorldBuilder, the same as in the
+headless server and the benchmarks - all that's added here is what they
+look like.
+*/
 GameObject* TutorialGame::AddFloorToWorld(const Vector3& position, Vector3 floorSize) {
-	GameObject* floor = new GameObject("Floor");
-
-	AABBVolume* volume = new AABBVolume(floorSize);
-	floor->SetBoundingVolume((CollisionVolume*)volume);
-	floor->GetTransform().SetWorldScale(floorSize);
-	floor->GetTransform().SetWorldPosition(position);
-
-	floor->SetRenderObject(new RenderObject(&floor->GetTransform(), cubeMesh, basicTex, basicShader));
-	floor->SetPhysicsObject(new PhysicsObject(&floor->GetTransform(), floor->GetBoundingVolume()));
-
-	floor->GetPhysicsObject()->SetInverseMass(0);
-	floor->GetPhysicsObject()->InitCubeInertia();
-
-	world->AddGameObject(floor);
+	GameObject* floor = WorldBuilder::AddCube(*world, position, floorSize, 0.0f, "Floor");
+	floor->SetRenderObject(RenderObject(&floor->GetTransform(), cubeMesh, basicTex, basicShader));
 
 	return floor;
 }
 
 GameObject* TutorialGame::AddSphereToWorld(const Vector3& position, float radius, float inverseMass, string name) {
-	GameObject* sphere = new GameObject(name);
-
-	Vector3 sphereSize = Vector3(radius, radius, radius);
-	SphereVolume* volume = new SphereVolume(radius);
-	sphere->SetBoundingVolume((CollisionVolume*)volume);
-	sphere->GetTransform().SetWorldScale(sphereSize);
-	sphere->GetTransform().SetWorldPosition(position);
-
-	sphere->SetRenderObject(new RenderObject(&sphere->GetTransform(), sphereMesh, basicTex, basicShader));
-	sphere->SetPhysicsObject(new PhysicsObject(&sphere->GetTransform(), sphere->GetBoundingVolume()));
-
-	sphere->GetPhysicsObject()->SetInverseMass(inverseMass);
-	sphere->GetPhysicsObject()->InitSphereInertia();
-
-	world->AddGameObject(sphere);
+	GameObject* sphere = WorldBuilder::AddSphere(*world, position, radius, inverseMass, name);
+	sphere->SetRenderObject(RenderObject(&sphere->GetTransform(), sphereMesh, basicTex, basicShader));
 
 	return sphere;
 }
 
 GameObject* TutorialGame::AddCubeToWorld(const Vector3& position, Vector3 dimensions, float inverseMass, string name) {
-	GameObject* cube = new GameObject(name);
-
-	AABBVolume* volume = new AABBVolume(dimensions);
-
-	cube->SetBoundingVolume((CollisionVolume*)volume);
-
-	cube->GetTransform().SetWorldPosition(position);
-	cube->GetTransform().SetWorldScale(dimensions);
-
-	cube->SetRenderObject(new RenderObject(&cube->GetTransform(), cubeMesh, basicTex, basicShader));
-	cube->SetPhysicsObject(new PhysicsObject(&cube->GetTransform(), cube->GetBoundingVolume()));
-
-	cube->GetPhysicsObject()->SetInverseMass(inverseMass);
-	cube->GetPhysicsObject()->InitCubeInertia();
-
-	world->AddGameObject(cube);
+	GameObject* cube = WorldBuilder::AddCube(*world, position, dimensions, inverseMass, name);
+	cube->SetRenderObject(RenderObject(&cube->GetTransform(), cubeMesh, basicTex, basicShader));
 
 	return cube;
 }
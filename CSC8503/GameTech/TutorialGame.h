@@ -6,6 +6,8 @@
 #include "../CSC8503Common/State.h"
 #include "../CSC8503Common/GameServer.h"
 #include "../CSC8503Common/GameClient.h"
+#include "../../Common/JobSystem.h"
+#include "../../Common/FrameGraph.h"
 
 
 namespace NCL {
@@ -23,7 +25,10 @@ namespace NCL {
 			void InitialiseAssets();
 
 			void InitCamera();
+			void InitFrameGraph();
+			void UpdateStateMachines(bool threadSafe);
 			void UpdateKeys();
+			void PrintProfilerSummary();
 
 			void InitWorld();
 
@@ -38,8 +43,14 @@ namespace NCL {
 			PhysicsSystem*		physics;
 			GameWorld*			world;
 
+			JobSystem*			jobs;
+			FrameGraph			frameGraph;
+			float				frameDT;
+
 			bool useGravity;
 			bool inSelectionMode;
+			bool showProfiler;
+			bool logMetrics;
 
 			float		forceMagnitude;
 
@@ -0,0 +1,240 @@
+/*
+A dedicated server, with no window, renderer or GPU - the game world and its
+physics are stepped at a fixed tick rate, and a GameServer handles the
+clients. It's a plain command line process, so it'll run on a Linux box with
+nothing but the CMake build.
+
+Usage:
+	HeadlessServer [--port 1234] [--clients 32] [--tick-rate 60] [--frames 0]
+		[--objects 200] [--status 10] [--metrics file] [--metrics-port port]
+
+--frames 0 runs until Ctrl+C or SIGTERM, either of which lets the current
+frame finish, then shuts the server, the network and the metrics down.
+--status prints the frame times every that many seconds (0 turns it off).
+--metrics logs the Metrics to a file once a second, or --metrics-port sends
+them as UDP packets to that port on localhost.
+*/
+#include "../../Common/Window.h"
+#include "../../Common/NullRenderer.h"
+#include "../../Common/Profiler.h"
+
+#include "../CSC8503Common/GameWorld.h"
+#include "../CSC8503Common/GameObject.h"
+#include "../CSC8503Common/GameServer.h"
+#include "../CSC8503Common/PhysicsSystem.h"
+#include "../CSC8503Common/WorldBuilder.h"
+#include "../CSC8503Common/Metrics.h"
+#include "../CSC8503Common/Debug.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	//Set by the signal handler, and checked once a frame by the main loop -
+	//a handler can't safely do any more than that, so the shutting down is
+	//all left to main
+	volatile std::sig_atomic_t stopRequested = 0;
+
+	void OnStopSignal(int) {
+		stopRequested = 1;
+	}
+
+	struct Settings {
+		int			port		= NetworkBase::GetDefaultPort();
+		int			clients		= 32;
+		float		tickRate	= 60.0f;
+		int			frames		= 0;
+		int			objects		= 200;
+		float		status		= 10.0f;
+		std::string metricsFile;
+		int			metricsPort = 0;
+	};
+
+	bool ParseArgs(int argc, char** argv, Settings& s) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (i + 1 >= argc) {
+				std::cerr << "Missing value for " << arg << std::endl;
+				return false;
+			}
+			std::string value = argv[++i];
+
+			if (arg == "--port") {
+				s.port = std::stoi(value);
+			}
+			else if (arg == "--clients") {
+				s.clients = std::stoi(value);
+			}
+			else if (arg == "--tick-rate") {
+				s.tickRate = std::stof(value);
+			}
+			else if (arg == "--frames") {
+				s.frames = std::stoi(value);
+			}
+			else if (arg == "--objects") {
+				s.objects = std::stoi(value);
+			}
+			else if (arg == "--status") {
+				s.status = std::stof(value);
+			}
+			else if (arg == "--metrics") {
+				s.metricsFile = value;
+			}
+			else if (arg == "--metrics-port") {
+				s.metricsPort = std::stoi(value);
+			}
+			else {
+				std::cerr << "Unknown option " << arg << std::endl;
+				return false;
+			}
+		}
+		return s.tickRate > 0.0f;
+	}
+
+	//The same floor as the TutorialGame, with a grid of spheres dropped
+	//onto it, so that the physics has something to do
+	void BuildWorld(GameWorld& world, int objectCount) {
+		WorldBuilder::AddCube(world, Vector3(0, 0, 0), Vector3(100, 1, 100), 0.0f);
+
+		int		side	= std::max(1, (int)std::ceil(std::sqrt((float)objectCount)));
+		float	spacing = std::min(4.0f, 180.0f / side);
+		float	start	= -0.5f * spacing * (side - 1);
+
+		for (int i = 0; i < objectCount; ++i) {
+			Vector3 pos(start + (i % side) * spacing, 10.0f + (i / (side * side)) * 4.0f, start + ((i / side) % side) * spacing);
+			WorldBuilder::AddSphere(world, pos, 1.0f, 1.0f);
+		}
+	}
+
+	/*
+	Steps the world and the server until the frame limit is reached, or a
+	stop is requested, and returns how many frames were run.
+
+	The simulation always steps by exactly one tick, whatever the real frame
+	time, and the loop sleeps until the next tick is due, so an idle server
+	uses next to no CPU. If a tick runs long, the schedule is reset rather
+	than running a burst of catch-up ticks.
+	*/
+	int RunServer(const Settings& settings, Window& w, Rendering::NullRenderer& renderer, GameWorld& world, PhysicsSystem& physics, GameServer& server) {
+		typedef std::chrono::steady_clock Clock;
+		const float				tickDt		= 1.0f / settings.tickRate;
+		const Clock::duration	tickLength	= std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(tickDt));
+
+		Clock::time_point nextTick = Clock::now() + tickLength;
+
+		int		frame			= 0;
+		float	statusTime		= 0.0f;
+		float	statusMaxMs		= 0.0f;
+		float	statusTotalMs	= 0.0f;
+		int		statusFrames	= 0;
+
+		while (!stopRequested && w.UpdateWindow() && (settings.frames == 0 || frame < settings.frames)) {
+			Clock::time_point frameStart = Clock::now();
+
+			physics.Update(tickDt);
+			world.UpdateWorld(tickDt);
+			server.UpdateServer();
+
+			renderer.Render();
+			Debug::FlushRenderables();
+
+			Profiler::EndFrame();
+			Metrics::EndFrame(w.GetTimer()->GetTimeDelta() / 1000.0f);	//the real frame time, to show up overruns
+			++frame;
+
+			float workMs = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+			statusMaxMs		= std::max(statusMaxMs, workMs);
+			statusTotalMs	+= workMs;
+			statusFrames++;
+			statusTime		+= tickDt;
+
+			if (settings.status > 0.0f && statusTime >= settings.status) {
+				std::cout << "Frame " << frame << ": " << statusTotalMs / statusFrames << "ms mean, "
+					<< statusMaxMs << "ms max, " << server.GetClientCount() << " clients" << std::endl;
+				statusTime = statusMaxMs = statusTotalMs = 0.0f;
+				statusFrames = 0;
+			}
+
+			Clock::time_point now = Clock::now();
+			if (now > nextTick) {
+				nextTick = now;
+			}
+			else {
+				std::this_thread::sleep_until(nextTick);
+			}
+			nextTick += tickLength;
+		}
+		return frame;
+	}
+}
+
+int main(int argc, char** argv) {
+	Settings settings;
+	if (!ParseArgs(argc, argv, settings)) {
+		std::cerr << "Usage: HeadlessServer [--port 1234] [--clients 32] [--tick-rate 60] [--frames 0] [--objects 200] [--status 10] [--metrics file] [--metrics-port port]" << std::endl;
+		return 1;
+	}
+
+	Window* w = Window::CreateHeadlessWindow("CSC8503 headless server");
+	if (!w || !w->HasInitialised()) {
+		std::cerr << "Couldn't create the headless window" << std::endl;
+		Window::DestroyGameWindow();
+		return -1;
+	}
+	Profiler::SetThreadName("Main");
+
+	Rendering::NullRenderer* renderer = new Rendering::NullRenderer(*w);
+	w->SetRenderer(renderer);
+	Debug::SetRenderer(renderer);
+
+	GameWorld*		world	= new GameWorld();
+	PhysicsSystem*	physics = new PhysicsSystem(*world);
+	physics->UseGravity(true);
+	physics->UseBroadPhase(true);
+	BuildWorld(*world, settings.objects);
+
+	//Whether or not the server starts, everything is torn down the same way
+	//at the end, so a failure here doesn't leak the window or the network
+	NetworkBase::Initialise();
+	GameServer* server	= new GameServer(settings.port, settings.clients);
+	bool		started	= server->Initialise();
+	if (started) {
+		server->SetGameWorld(*world);
+
+		if (!settings.metricsFile.empty()) {
+			Metrics::OutputToFile(settings.metricsFile, 1.0f);
+		}
+		else if (settings.metricsPort > 0) {
+			Metrics::OutputToSocket(settings.metricsPort, 1.0f);
+		}
+
+		std::signal(SIGINT, OnStopSignal);
+		std::signal(SIGTERM, OnStopSignal);
+
+		std::cout << "Server running on port " << settings.port << " at " << settings.tickRate << "Hz, Ctrl+C to stop" << std::endl;
+		int frames = RunServer(settings, *w, *renderer, *world, *physics, *server);
+		std::cout << "Server shutting down after " << frames << " frames" << std::endl;
+	}
+	else {
+		std::cerr << "Couldn't start a server on port " << settings.port << std::endl;
+	}
+
+	Metrics::CloseOutput();
+	delete server;
+	NetworkBase::Destroy();
+
+	delete physics;
+	delete world;
+	Debug::SetRenderer(nullptr);
+	delete renderer;
+	Window::DestroyGameWindow();
+	return started ? 0 : -1;
+}
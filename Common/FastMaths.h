@@ -0,0 +1,167 @@
+/******************************************************************************
+Class:FastMaths
+Implements:
+Description:Cheaper, approximate versions of some of the maths functions that
+get called an awful lot - reciprocal square roots, sin / cos, and vector and
+quaternion normalisation. They're all accurate to well within 1e-5 relative
+error (see each function for its bounds), which is fine for physics and
+rendering, but use the exact versions for anything that needs to be exact!
+
+The MathsBenchmark program compares them against the exact versions, both in
+speed and in the worst error found.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "SIMD.h"
+#include "Maths.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+namespace NCL {
+	namespace Maths {
+		/*
+		1 / sqrt(x), for x > 0.
+		SSE: the hardware estimate (12 bits) plus one Newton-Raphson step,
+		max relative error ~5e-7.
+		Scalar: the old 'magic number' bit trick, plus two Newton-Raphson
+		steps, max relative error ~5e-6.
+		*/
+		inline float FastInvSqrt(float x) {
+#ifdef NCL_USE_SSE
+			__m128 v = _mm_set_ss(x);
+			__m128 y = _mm_rsqrt_ss(v);
+			//y = y * (1.5 - 0.5 * x * y * y)
+			__m128 yy = _mm_mul_ss(y, y);
+			y = _mm_mul_ss(y, _mm_sub_ss(_mm_set_ss(1.5f), _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), v), yy)));
+			return _mm_cvtss_f32(y);
+#else
+			uint32_t bits;
+			memcpy(&bits, &x, sizeof(float));
+			bits = 0x5f375a86 - (bits >> 1);
+			float y;
+			memcpy(&y, &bits, sizeof(float));
+
+			float halfX = 0.5f * x;
+			y = y * (1.5f - halfX * y * y);
+			y = y * (1.5f - halfX * y * y);
+			return y;
+#endif
+		}
+
+		inline float FastSqrt(float x) {
+			return x > 0.0f ? x * FastInvSqrt(x) : 0.0f;
+		}
+
+		namespace FastMathsDetail {
+			//x - 2PI * n, for whichever n puts the result in [-PI, PI]. 2PI is
+			//subtracted in two parts (a 'Cody-Waite' reduction) so that the
+			//rounding error doesn't grow with n
+			inline float ReduceAngle(float x) {
+				const float TWO_PI_HI	= 6.28125f;					//exact in a float
+				const float TWO_PI_LO	= 1.9353071795864769e-3f;	//2PI - TWO_PI_HI
+				const float INV_TWO_PI	= 0.15915494309189535f;
+
+#ifdef NCL_USE_SSE
+				//cvtss rounds to nearest, so no need to fiddle with the sign
+				float turns = (float)_mm_cvtss_si32(_mm_set_ss(x * INV_TWO_PI));
+#else
+				float turns = floorf(x * INV_TWO_PI + 0.5f);
+#endif
+				return (x - turns * TWO_PI_HI) - turns * TWO_PI_LO;
+			}
+
+			//sin(x) for x in [-PI, PI]
+			inline float SinReduced(float x) {
+				const float HALF_PI = 0.5f * PI;
+				//mirror into [-PI/2, PI/2], as sin(PI - x) == sin(x). Written
+				//as selects rather than ifs, as random angles make branches
+				//mispredict half of the time
+				float mirrored	= copysignf(PI, x) - x;
+				x				= fabsf(x) > HALF_PI ? mirrored : x;
+				float x2 = x * x;
+				return x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+			}
+		}
+
+		/*
+		sin(x), as an 11th order polynomial after folding x into [-PI/2, PI/2].
+		The polynomial itself is good to 6e-8, and the range reduction keeps
+		the absolute error under 1e-6 for |x| < 1000.
+		*/
+		inline float FastSin(float x) {
+			return FastMathsDetail::SinReduced(FastMathsDetail::ReduceAngle(x));
+		}
+
+		//cos(x) = sin(x + PI/2) - the shift happens after the range reduction,
+		//so that it doesn't cost any precision for large x. Same bounds as FastSin
+		inline float FastCos(float x) {
+			float r = FastMathsDetail::ReduceAngle(x) + 0.5f * PI;
+			if (r > PI) {
+				r -= 2.0f * PI;
+			}
+			return FastMathsDetail::SinReduced(r);
+		}
+
+		inline void FastSinCos(float x, float& outSin, float& outCos) {
+			outSin = FastSin(x);
+			outCos = FastCos(x);
+		}
+
+		//Vector3::Normalise, without the sqrt or divide. Zero length vectors
+		//are left alone. Max relative error is that of FastInvSqrt
+		inline void FastNormalise(Vector3& v) {
+			float lengthSq = (v.x * v.x) + (v.y * v.y) + (v.z * v.z);
+			if (lengthSq > 0.0f) {
+				float invLength = FastInvSqrt(lengthSq);
+				v.x *= invLength;
+				v.y *= invLength;
+				v.z *= invLength;
+			}
+		}
+
+		inline Vector3 FastNormalised(const Vector3& v) {
+			Vector3 temp(v);
+			FastNormalise(temp);
+			return temp;
+		}
+
+		/*
+		Pulls a quaternion that's drifted slightly away from unit length back
+		towards it. If |q|^2 = 1 + e, then 1 / |q| = 1 - e/2 + O(e^2), so
+		scaling by (3 - |q|^2) / 2 fixes the length to within (3/8)e^2. That's
+		under 1e-5 for |e| < 5e-3 - any further out than that, and we fall back
+		to a full normalise. Integrating an orientation by a small step only
+		moves it by e = O(dt^2), so this is the case almost every time.
+		*/
+		inline void FastRenormalise(Quaternion& q) {
+			const float MAX_FIRST_ORDER_ERROR = 5e-3f;
+
+			float lengthSq = (q.x * q.x) + (q.y * q.y) + (q.z * q.z) + (q.w * q.w);
+			float e = lengthSq - 1.0f;
+
+			if (e > MAX_FIRST_ORDER_ERROR || e < -MAX_FIRST_ORDER_ERROR) {
+				if (lengthSq > 0.0f) {
+					float invLength = FastInvSqrt(lengthSq);
+					q.x *= invLength;
+					q.y *= invLength;
+					q.z *= invLength;
+					q.w *= invLength;
+				}
+				return;
+			}
+			float scale = 1.5f - 0.5f * lengthSq;
+			q.x *= scale;
+			q.y *= scale;
+			q.z *= scale;
+			q.w *= scale;
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#include "FrameGraph.h"
+#include <iostream>
+
+using namespace NCL;
+
+FrameGraph::NodeID FrameGraph::AddNode(const std::string& name, const JobSystem::JobFunc& func) {
+	Node* n = new Node();
+	n->name				= name;
+	n->func				= func;
+	n->dependencyCount	= 0;
+	n->remaining		= 0;
+	nodes.emplace_back(n);
+	return (NodeID)nodes.size() - 1;
+}
+
+void FrameGraph::AddDependency(NodeID before, NodeID after) {
+	nodes[before]->dependents.emplace_back(after);
+	nodes[after]->dependencyCount++;
+}
+
+void FrameGraph::Clear() {
+	nodes.clear();
+}
+
+/*
+Once a node has run, it counts down each of its dependents - whoever takes a
+dependent's count to zero is the one that schedules it. New jobs are added
+to the counter before this node's job finishes, so the counter can't reach
+zero until the whole graph has run.
+*/
+void FrameGraph::RunNode(NodeID id, JobSystem& jobs, JobCounter& counter) {
+	Node& n = *nodes[id];
+	n.func();
+
+	for (NodeID d : n.dependents) {
+		if (--nodes[d]->remaining == 0) {
+			jobs.Run([this, d, &jobs, &counter]() { RunNode(d, jobs, counter); }, &counter);
+		}
+	}
+}
+
+void FrameGraph::Execute(JobSystem& jobs) {
+	for (auto& i : nodes) {
+		i->remaining = i->dependencyCount;
+	}
+	JobCounter counter;
+	bool anyStarted = false;
+	for (NodeID i = 0; i < (NodeID)nodes.size(); ++i) {
+		if (nodes[i]->dependencyCount == 0) {
+			jobs.Run([this, i, &jobs, &counter]() { RunNode(i, jobs, counter); }, &counter);
+			anyStarted = true;
+		}
+	}
+	if (!anyStarted && !nodes.empty()) {
+		std::cout << __FUNCTION__ << " graph has no starting node - is there a cycle?" << std::endl;
+		return;
+	}
+	jobs.Wait(counter);
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+Class:FrameGraph
+Implements:
+Description:Describes one frame's worth of work as a set of named nodes, and
+the order they have to happen in. Each node becomes a job once everything it
+depends on has finished, so nodes that don't depend on each other are free
+to run at the same time on different threads.
+
+The graph is built once, and can then be executed every frame.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "JobSystem.h"
+#include <string>
+
+namespace NCL {
+	class FrameGraph {
+	public:
+		typedef int NodeID;
+
+		FrameGraph() {}
+		~FrameGraph() {}
+
+		NodeID	AddNode(const std::string& name, const JobSystem::JobFunc& func);
+
+		//'after' won't start until 'before' has finished
+		void	AddDependency(NodeID before, NodeID after);
+
+		//Runs every node, and returns once the whole graph has finished
+		void	Execute(JobSystem& jobs);
+
+		void	Clear();
+
+		const std::string& GetNodeName(NodeID id) const {
+			return nodes[id]->name;
+		}
+
+	protected:
+		struct Node {
+			std::string			name;
+			JobSystem::JobFunc	func;
+			std::vector<NodeID>	dependents;
+			int					dependencyCount;
+			std::atomic<int>	remaining;
+		};
+
+		void RunNode(NodeID id, JobSystem& jobs, JobCounter& counter);
+
+		std::vector<std::unique_ptr<Node>> nodes;
+	};
+}
@@ -29,4 +29,9 @@ void	GameTimer::Tick() {
 	nowPoint = latestTime;
 
 	timeDelta = msec.count() / 1000.0f;
-}
\ No newline at end of file
+}
+
+int64_t GameTimer::GetNanoseconds() {
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
@@ -16,6 +16,7 @@ _-_-_-_-_-_-_-""  ""
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 namespace NCL {
 	typedef  std::chrono::time_point<std::chrono::high_resolution_clock>  Timepoint;
@@ -28,6 +29,10 @@ namespace NCL {
 		double	GetTotalTime() const;
 		float	GetTimeDelta() const { return timeDelta; };
 		void	Tick();
+
+		//A steady nanosecond count, for timing things much shorter than a
+		//frame. Only the difference between two of these means anything
+		static int64_t GetNanoseconds();
 	protected:
 		float		timeDelta;	//Last time GetTimedMS was called
 		Timepoint	firstPoint;
@@ -0,0 +1,43 @@
+#include "HeadlessWindow.h"
+#include <csignal>
+
+using namespace NCL;
+using namespace Headless;
+
+namespace {
+	volatile std::sig_atomic_t quitRequested = 0;
+
+	void OnQuitSignal(int) {
+		quitRequested = 1;
+	}
+}
+
+HeadlessWindow::HeadlessWindow(const std::string& title, int sizeX, int sizeY) {
+	size		= Vector2((float)sizeX, (float)sizeY);
+	defaultSize = size;
+	position	= Vector2(0.0f, 0.0f);
+	windowTitle = title;
+
+	timer		= new GameTimer();
+	keyboard	= new HeadlessKeyboard();
+	mouse		= new HeadlessMouse();
+
+	quitRequested = 0;
+	std::signal(SIGINT, OnQuitSignal);
+	std::signal(SIGTERM, OnQuitSignal);
+
+	init = true;
+}
+
+HeadlessWindow::~HeadlessWindow(void) {
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+}
+
+void HeadlessWindow::RequestQuit() {
+	quitRequested = 1;
+}
+
+bool HeadlessWindow::InternalUpdate() {
+	return quitRequested == 0;
+}
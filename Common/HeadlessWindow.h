@@ -0,0 +1,50 @@
+/******************************************************************************
+Class:HeadlessWindow
+Implements:Window
+Description:A Window that doesn't open anything - there's no OS window, and the
+keyboard and mouse never report any input. It still ticks the GameTimer every
+UpdateWindow, so that code that only wants the frame timing and the main loop
+(dedicated servers, benchmarks, the Linux build) can carry on using the
+Window just like the game does.
+
+UpdateWindow returns false once the process has been asked to stop with
+Ctrl+C (SIGINT) or SIGTERM, so a server's main loop can shut down cleanly.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Window.h"
+
+namespace NCL {
+	namespace Headless {
+		class HeadlessKeyboard : public Keyboard {
+		public:
+			HeadlessKeyboard() {}
+		};
+
+		class HeadlessMouse : public Mouse {
+		public:
+			HeadlessMouse() {}
+		};
+
+		class HeadlessWindow : public Window {
+		public:
+			friend class Window;
+			void	LockMouseToWindow(bool lock)	override {}
+			void	ShowOSPointer(bool show)		override {}
+
+			//Asks the window to close on its next update, as a signal would
+			void	RequestQuit();
+
+		protected:
+			HeadlessWindow(const std::string& title, int sizeX, int sizeY);
+			virtual ~HeadlessWindow(void);
+
+			bool	InternalUpdate()	override;
+		};
+	}
+}
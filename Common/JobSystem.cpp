@@ -0,0 +1,143 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+using namespace NCL;
+
+//Which system and queue the current thread belongs to - threads that aren't
+//workers (like the main thread) share queue 0
+static thread_local JobSystem*	threadSystem	= nullptr;
+static thread_local size_t		threadQueue		= 0;
+
+JobSystem::JobSystem(unsigned int threadCount) {
+	if (threadCount == 0) {
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+	running		= true;
+	queuedJobs	= 0;
+
+	for (unsigned int i = 0; i <= threadCount; ++i) {
+		queues.emplace_back(new WorkQueue());
+	}
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		workers.emplace_back(&JobSystem::WorkerThread, this, (size_t)i + 1);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		running = false;
+	}
+	wakeCondition.notify_all();
+	for (auto& i : workers) {
+		i.join();
+	}
+}
+
+size_t JobSystem::GetQueueIndex() const {
+	return threadSystem == this ? threadQueue : 0;
+}
+
+void JobSystem::Run(const JobFunc& func, JobCounter* counter) {
+	if (counter) {
+		counter->count++;
+	}
+	WorkQueue& queue = *queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.jobs.push_back({ func, counter });
+	}
+	queuedJobs++;
+	//Taking the lock means a worker can't be stuck between checking for
+	//work and going to sleep, so it can't miss this wake up
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+	}
+	wakeCondition.notify_one();
+}
+
+/*
+Our own queue is used like a stack, as the newest job is the most likely to
+still have its data in the cache. Stealing takes the oldest job from other
+queues instead, which is usually the biggest chunk of remaining work.
+*/
+bool JobSystem::FindJob(Job& job) {
+	size_t home = GetQueueIndex();
+	{
+		WorkQueue& queue = *queues[home];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			queuedJobs--;
+			return true;
+		}
+	}
+	for (size_t i = 1; i < queues.size(); ++i) {
+		WorkQueue& queue = *queues[(home + i) % queues.size()];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (!queue.jobs.empty()) {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			queuedJobs--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::Execute(Job& job) {
+	NCL_PROFILE_ZONE("Job");
+	job.func();
+	if (job.counter) {
+		job.counter->count--;
+	}
+}
+
+void JobSystem::WorkerThread(size_t queueIndex) {
+	threadSystem	= this;
+	threadQueue		= queueIndex;
+	Profiler::SetThreadName("Job Worker " + std::to_string(queueIndex));
+
+	while (true) {
+		Job job;
+		if (FindJob(job)) {
+			Execute(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepLock);
+		wakeCondition.wait(lock, [&] { return !running || queuedJobs > 0; });
+		if (!running) {
+			return;
+		}
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	while (!counter.IsDone()) {
+		Job job;
+		if (FindJob(job)) {
+			Execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize, const RangeFunc& func) {
+	if (batchSize == 0) {
+		batchSize = 1;
+	}
+	if (count <= batchSize) { //Not worth spreading out
+		func(0, count);
+		return;
+	}
+	JobCounter counter;
+	for (size_t start = 0; start < count; start += batchSize) {
+		size_t end = start + batchSize < count ? start + batchSize : count;
+		Run([&func, start, end]() { func(start, end); }, &counter);
+	}
+	Wait(counter);
+}
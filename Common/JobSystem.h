@@ -0,0 +1,90 @@
+/******************************************************************************
+Class:JobSystem
+Implements:
+Description:A simple work-stealing job system. A pool of worker threads is
+created up front, each with its own queue of jobs. Threads take new work from
+the back of their own queue, and when that runs dry, steal from the front of
+someone else's, so a thread that's finished early helps out rather than
+sitting idle.
+
+Jobs can be tracked with a JobCounter - waiting on a counter doesn't block
+the calling thread, it runs other jobs until the counter reaches zero, so
+it's fine to wait from inside a job.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace NCL {
+	class JobCounter {
+	public:
+		JobCounter() : count(0) {}
+
+		bool IsDone() const {
+			return count.load() == 0;
+		}
+
+	protected:
+		friend class JobSystem;
+		std::atomic<int> count;
+	};
+
+	class JobSystem {
+	public:
+		typedef std::function<void()>				JobFunc;
+		typedef std::function<void(size_t, size_t)>	RangeFunc;
+
+		//0 threads means one per core, minus one for the main thread
+		JobSystem(unsigned int threadCount = 0);
+		~JobSystem();
+
+		void Run(const JobFunc& job, JobCounter* counter = nullptr);
+
+		//Runs other jobs until every job added with this counter is done
+		void Wait(JobCounter& counter);
+
+		//Splits [0, count) into batches, calls func(start, end) on each of
+		//them in parallel, and returns once they've all finished
+		void ParallelFor(size_t count, size_t batchSize, const RangeFunc& func);
+
+		unsigned int GetWorkerCount() const {
+			return (unsigned int)workers.size();
+		}
+
+	protected:
+		struct Job {
+			JobFunc		func;
+			JobCounter* counter;
+		};
+
+		struct WorkQueue {
+			std::mutex			lock;
+			std::deque<Job>		jobs;
+		};
+
+		void	WorkerThread(size_t queueIndex);
+		bool	FindJob(Job& job);
+		void	Execute(Job& job);
+		size_t	GetQueueIndex() const;
+
+		std::vector<std::thread>				workers;
+		std::vector<std::unique_ptr<WorkQueue>>	queues; //0 is for non-worker threads
+
+		std::atomic<bool>		running;
+		std::atomic<int>		queuedJobs;
+		std::mutex				sleepLock;
+		std::condition_variable	wakeCondition;
+	};
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+Class:MappedFile
+Implements:
+Description:Maps a whole file into memory, read only. Nothing is actually read
+until a page of it is touched, and the pages are shared with every other
+process that maps the same file, so big data files that are used as they
+are on disk - rather than parsed into something else - load instantly, and
+only cost their memory once per machine, not once per process.
+
+Uses mmap, or CreateFileMapping on Windows. Empty files can't be mapped.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <cstddef>
+
+namespace NCL {
+	class MappedFile {
+	public:
+		MappedFile();
+		MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&)				= delete;
+		MappedFile& operator=(const MappedFile&)	= delete;
+
+		//Returns false, and leaves nothing mapped, if the file can't be
+		//opened or is empty
+		bool Open(const std::string& filename);
+		void Close();
+
+		bool IsOpen() const {
+			return data != nullptr;
+		}
+		const char* GetData() const {
+			return data;
+		}
+		size_t GetSize() const {
+			return size;
+		}
+
+	protected:
+		const char* data;
+		size_t		size;
+#ifdef _WIN32
+		void*		fileHandle;
+		void*		mappingHandle;
+#endif
+	};
+}
@@ -1,5 +1,6 @@
 #include "Matrix2.h"
 #include "Maths.h"
+#include <cmath>
 
 using namespace NCL;
 using namespace NCL::Maths;
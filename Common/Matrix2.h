@@ -1,6 +1,7 @@
 #pragma once
 #include "Vector2.h"
 #include <assert.h>
+#include <cstring>
 namespace NCL {
 	namespace Maths {
 		class Matrix2 {
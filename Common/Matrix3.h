@@ -1,6 +1,7 @@
 #pragma once
 #include "Matrix4.h"
 #include <assert.h>
+#include <cstring>
 
 namespace NCL {
 	namespace Maths {
@@ -16,15 +16,17 @@ _-_-_-_-_-_-_-""  ""
 #pragma once
 
 #include <iostream>
+#include <cstring>
 #include "Vector3.h"
 #include "Vector4.h"
+#include "SIMD.h"
 
 namespace NCL {
 	namespace Maths {
 		class Vector3;
 		class Matrix3;
 
-		class Matrix4 {
+		class NCL_SIMD_ALIGN Matrix4 {
 		public:
 			Matrix4(void);
 			Matrix4(float elements[16]);
@@ -103,6 +105,12 @@ namespace NCL {
 			//Multiplies 'this' matrix by matrix 'a'. Performs the multiplication in 'OpenGL' order (ie, backwards)
 			inline Matrix4 operator*(const Matrix4 &a) const {
 				Matrix4 out;
+#ifdef NCL_USE_SSE
+				//Each column of the result is this matrix's columns, weighted by a column of 'a'
+				for (unsigned int r = 0; r < 4; ++r) {
+					_mm_storeu_ps(&out.values[r * 4], SIMD::Transform4(values, _mm_loadu_ps(&a.values[r * 4])));
+				}
+#else
 				//Students! You should be able to think up a really easy way of speeding this up...
 				for (unsigned int r = 0; r < 4; ++r) {
 					for (unsigned int c = 0; c < 4; ++c) {
@@ -112,11 +120,23 @@ namespace NCL {
 						}
 					}
 				}
+#endif
 				return out;
 			}
 
 			inline Vector3 operator*(const Vector3 &v) const {
 				Vector3 vec;
+#ifdef NCL_USE_SSE
+				__m128 r = SIMD::Transform4(values, _mm_set_ps(1.0f, v.z, v.y, v.x));
+				r = _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+
+				float temp[4];
+				_mm_storeu_ps(temp, r);
+				vec.x = temp[0];
+				vec.y = temp[1];
+				vec.z = temp[2];
+				return vec;
+#else
 
 				float temp;
 
@@ -131,15 +151,20 @@ namespace NCL {
 				vec.z = vec.z / temp;
 
 				return vec;
+#endif
 			};
 
 			inline Vector4 operator*(const Vector4 &v) const {
+#ifdef NCL_USE_SSE
+				return Vector4(SIMD::Transform4(values, v.ToSSE()));
+#else
 				return Vector4(
 					v.x*values[0] + v.y*values[4] + v.z*values[8] + v.w * values[12],
 					v.x*values[1] + v.y*values[5] + v.z*values[9] + v.w * values[13],
 					v.x*values[2] + v.y*values[6] + v.z*values[10] + v.w * values[14],
 					v.x*values[3] + v.y*values[7] + v.z*values[11] + v.w * values[15]
 				);
+#endif
 			};
 
 			//Handy string output for the matrix. Can get a bit messy, but better than nothing!
@@ -0,0 +1,92 @@
+#include "MemoryArena.h"
+#include <algorithm>
+
+using namespace NCL;
+
+//new[] gives back memory that's 16 byte aligned on x64, so as long as every
+//allocation is rounded up to 16 bytes, they all stay aligned
+const size_t ARENA_ALIGNMENT = 16;
+
+MemoryArena::MemoryArena(size_t size) {
+	blockSize		= size;
+	currentBlock	= 0;
+	blockOffset		= 0;
+	liveCount		= 0;
+	bytesUsed		= 0;
+}
+
+MemoryArena::~MemoryArena() {
+	for (auto& i : blocks) {
+		delete[] i.data;
+	}
+}
+
+MemoryArena& MemoryArena::GetLevelArena() {
+	static MemoryArena levelArena;
+	return levelArena;
+}
+
+namespace {
+	size_t RoundUp(size_t size) {
+		return (std::max(size, (size_t)1) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	}
+}
+
+/*
+Anything freed earlier that's the same size gets reused first. Otherwise,
+anything that doesn't fit in what's left of the current block moves on to
+the next one, leaving the end of the current one empty - there's no going
+back to fill it in. Anything too big for a block gets a block of its own.
+*/
+void* MemoryArena::Allocate(size_t size) {
+	size = RoundUp(size);
+
+	auto freeList = freeLists.find(size);
+	if (freeList != freeLists.end() && freeList->second) {
+		FreeBlock* b		= freeList->second;
+		freeList->second	= b->next;
+		bytesUsed			+= size;
+		liveCount++;
+		return b;
+	}
+	while (currentBlock < blocks.size() && blockOffset + size > blocks[currentBlock].size) {
+		currentBlock++;
+		blockOffset = 0;
+	}
+	if (currentBlock == blocks.size()) {
+		Block b;
+		b.size = std::max(size, blockSize);
+		b.data = new char[b.size];
+		blocks.emplace_back(b);
+	}
+	void* p = blocks[currentBlock].data + blockOffset;
+	blockOffset += size;
+	bytesUsed	+= size;
+	liveCount++;
+	return p;
+}
+
+//Every allocation is at least 16 bytes, so there's always room for the link
+void MemoryArena::Free(void* p, size_t size) {
+	if (!p) {
+		return;
+	}
+	size = RoundUp(size);
+	FreeBlock*	b		= (FreeBlock*)p;
+	FreeBlock*&	head	= freeLists[size];
+	b->next		= head;
+	head		= b;
+	bytesUsed	-= size;
+	liveCount--;
+}
+
+bool MemoryArena::Reset() {
+	if (liveCount > 0) {
+		return false;
+	}
+	currentBlock	= 0;
+	blockOffset		= 0;
+	bytesUsed		= 0;
+	freeLists.clear();
+	return true;
+}
@@ -0,0 +1,105 @@
+/******************************************************************************
+Class:MemoryArena
+Implements:
+Description:A bump allocator for memory that mostly all goes away at the same
+time - everything belonging to a level, say. Allocating just moves a pointer
+along a big block. Anything freed goes onto a free list for its size, and
+the next allocation of that size gets it back, so memory that keeps being
+freed and allocated again within a level (strings growing, say) doesn't
+keep growing the arena. Reset takes the lot back in one go, once nothing's
+using any of it.
+
+Blocks are kept after a Reset, so the next level can fill them straight back
+up without going to the heap at all. Like the pools, the arena is NOT thread
+safe - main thread only!
+
+The level arena is the one every MemoryPool takes its chunks from, so all of
+a level's pooled objects live in it, and LevelString puts strings in it too.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+
+namespace NCL {
+	class MemoryArena {
+	public:
+		MemoryArena(size_t blockSize = 1024 * 1024);
+		~MemoryArena();
+
+		MemoryArena(const MemoryArena&)				= delete;
+		MemoryArena& operator=(const MemoryArena&)	= delete;
+
+		//Always 16 byte aligned, so it's safe for SIMD types
+		void*	Allocate(size_t size);
+		//size has to be what it was allocated with
+		void	Free(void* p, size_t size);
+
+		//Returns false, and leaves everything where it is, if anything
+		//allocated from the arena hasn't been freed yet
+		bool	Reset();
+
+		size_t	GetLiveCount()	const { return liveCount; }
+		size_t	GetBytesUsed()	const { return bytesUsed; }	//allocated, and not freed yet
+		size_t	GetBlockCount() const { return blocks.size(); }
+
+		static MemoryArena& GetLevelArena();
+
+	protected:
+		struct Block {
+			char*	data;
+			size_t	size;
+		};
+
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		size_t	blockSize;
+		size_t	currentBlock;
+		size_t	blockOffset;
+		size_t	liveCount;
+		size_t	bytesUsed;
+
+		std::vector<Block> blocks;
+		std::unordered_map<size_t, FreeBlock*> freeLists;	//by rounded up size
+	};
+
+	//Lets standard containers allocate from the level arena
+	template<class T>
+	class LevelAllocator {
+	public:
+		typedef T value_type;
+
+		LevelAllocator() {}
+		template<class U>
+		LevelAllocator(const LevelAllocator<U>&) {}
+
+		T* allocate(size_t count) {
+			return (T*)MemoryArena::GetLevelArena().Allocate(count * sizeof(T));
+		}
+
+		void deallocate(T* p, size_t count) {
+			MemoryArena::GetLevelArena().Free(p, count * sizeof(T));
+		}
+
+		template<class U>
+		bool operator==(const LevelAllocator<U>&) const {
+			return true;
+		}
+
+		template<class U>
+		bool operator!=(const LevelAllocator<U>&) const {
+			return false;
+		}
+	};
+
+	typedef std::basic_string<char, std::char_traits<char>, LevelAllocator<char>> LevelString;
+}
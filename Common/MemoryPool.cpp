@@ -0,0 +1,86 @@
+#include "MemoryPool.h"
+#include "MemoryArena.h"
+#include <algorithm>
+
+using namespace NCL;
+
+//Slots are rounded up to 16 bytes - chunks come from the level arena, which
+//is 16 byte aligned, so every slot is too, and can safely hold SIMD types
+const size_t POOL_ALIGNMENT = 16;
+
+MemoryPool::MemoryPool(size_t size, size_t perChunk) {
+	size_t minSize	= std::max(size, sizeof(FreeSlot));
+	slotSize		= (minSize + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT - 1);
+	slotsPerChunk	= perChunk;
+	liveCount		= 0;
+	freeList		= nullptr;
+
+	GetAllPools().emplace_back(this);
+}
+
+MemoryPool::~MemoryPool() {
+	std::vector<MemoryPool*>& pools = GetAllPools();
+	pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+
+	//Pools only go away with the program, and so does the arena their
+	//chunks live in - it might even have gone first, so leave it alone
+}
+
+std::vector<MemoryPool*>& MemoryPool::GetAllPools() {
+	static std::vector<MemoryPool*> allPools;
+	return allPools;
+}
+
+void MemoryPool::AddChunk() {
+	char* chunk = (char*)MemoryArena::GetLevelArena().Allocate(slotSize * slotsPerChunk);
+	chunks.emplace_back(chunk);
+
+	//Thread the new slots onto the front of the free list, in address order
+	for (size_t i = slotsPerChunk; i > 0; --i) {
+		FreeSlot* slot	= (FreeSlot*)(chunk + ((i - 1) * slotSize));
+		slot->next		= freeList;
+		freeList		= slot;
+	}
+}
+
+void* MemoryPool::Allocate() {
+	if (!freeList) {
+		AddChunk();
+	}
+	FreeSlot* slot = freeList;
+	freeList = slot->next;
+	liveCount++;
+	return slot;
+}
+
+void MemoryPool::Free(void* p) {
+	if (!p) {
+		return;
+	}
+	FreeSlot* slot	= (FreeSlot*)p;
+	slot->next		= freeList;
+	freeList		= slot;
+	liveCount--;
+}
+
+bool MemoryPool::ReleaseAll() {
+	if (liveCount > 0) {
+		return false;
+	}
+	for (auto& i : chunks) {
+		MemoryArena::GetLevelArena().Free(i, slotSize * slotsPerChunk);
+	}
+	chunks.clear();
+	freeList = nullptr;
+	return true;
+}
+
+size_t MemoryPool::ReleaseUnusedPools() {
+	size_t live = 0;
+	for (auto& i : GetAllPools()) {
+		if (!i->ReleaseAll()) {
+			live += i->GetLiveCount();
+		}
+	}
+	return live;
+}
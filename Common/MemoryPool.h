@@ -0,0 +1,98 @@
+/******************************************************************************
+Class:MemoryPool
+Implements:
+Description:A simple fixed-size block allocator. Memory is grabbed from the
+level's MemoryArena in large chunks, and handed out one slot at a time from a
+free list, so creating lots of small objects doesn't mean lots of trips to
+the heap, and freeing them doesn't leave the heap fragmented. Once a level's
+objects are all gone, the pools let go of their chunks, and the arena can
+take the whole level's memory back in one go.
+
+Classes can route their new / delete through a pool by inheriting from
+PoolAllocated<T>. Pools are NOT thread safe - create and destroy pooled
+objects from the main thread only!
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <vector>
+#include <cstddef>
+
+namespace NCL {
+	class MemoryPool {
+	public:
+		MemoryPool(size_t slotSize, size_t slotsPerChunk = 256);
+		~MemoryPool();
+
+		void*	Allocate();
+		void	Free(void* slot);
+
+		//Hands every chunk back to the level arena. Returns false, and
+		//keeps them, if any object allocated from this pool is still alive
+		bool	ReleaseAll();
+
+		size_t	GetSlotSize()	const { return slotSize; }
+		size_t	GetLiveCount()	const { return liveCount; }
+		size_t	GetChunkCount() const { return chunks.size(); }
+
+		//Releases every registered pool that has no live objects left in it,
+		//and returns how many objects are still alive in the ones that do
+		static size_t ReleaseUnusedPools();
+
+	protected:
+		void AddChunk();
+
+		struct FreeSlot {
+			FreeSlot* next;
+		};
+
+		size_t slotSize;
+		size_t slotsPerChunk;
+		size_t liveCount;
+
+		FreeSlot*			freeList;
+		std::vector<char*>	chunks;
+
+		static std::vector<MemoryPool*>& GetAllPools();
+	};
+
+	/*
+	Inheriting from this gives a class its own MemoryPool, which all of its
+	'new' and 'delete' calls go through. A derived class that is bigger than
+	the pool's slots falls back to the normal heap, so subclasses still work -
+	as long as the destructor is virtual, so that delete gets the right size!
+	SlotSize can be set to make one pool serve a whole family of small classes.
+	*/
+	template<class T, size_t SlotSize = 0>
+	class PoolAllocated {
+	public:
+		static void* operator new(size_t size) {
+			MemoryPool& pool = GetPool();
+			if (size > pool.GetSlotSize()) {
+				return ::operator new(size);
+			}
+			return pool.Allocate();
+		}
+
+		static void operator delete(void* p, size_t size) {
+			if (!p) {
+				return;
+			}
+			MemoryPool& pool = GetPool();
+			if (size > pool.GetSlotSize()) {
+				::operator delete(p);
+				return;
+			}
+			pool.Free(p);
+		}
+
+		static MemoryPool& GetPool() {
+			static MemoryPool pool(SlotSize ? SlotSize : sizeof(T));
+			return pool;
+		}
+	};
+}
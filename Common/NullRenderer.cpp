@@ -0,0 +1,22 @@
+#include "NullRenderer.h"
+
+using namespace NCL;
+using namespace Rendering;
+
+NullRenderer::NullRenderer(Window& w) : RendererBase(w) {
+	frameCount		= 0;
+	currentWidth	= (int)w.GetScreenSize().x;
+	currentHeight	= (int)w.GetScreenSize().y;
+}
+
+NullRenderer::~NullRenderer() {
+}
+
+void NullRenderer::OnWindowResize(int w, int h) {
+	currentWidth	= w;
+	currentHeight	= h;
+}
+
+void NullRenderer::EndFrame() {
+	frameCount++;
+}
@@ -0,0 +1,39 @@
+/******************************************************************************
+Class:NullRenderer
+Implements:RendererBase
+Description:A renderer that doesn't draw anything, for running the game without
+a GPU - on a dedicated server, or in the headless Linux build. Anything that
+needs a RendererBase can be given one of these, and every frame is just
+counted and thrown away.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "RendererBase.h"
+
+namespace NCL {
+	namespace Rendering {
+		class NullRenderer : public RendererBase {
+		public:
+			NullRenderer(Window& w);
+			~NullRenderer();
+
+			int GetFrameCount() const {
+				return frameCount;
+			}
+
+		protected:
+			void OnWindowResize(int w, int h)	override;
+
+			void BeginFrame()	override {}
+			void RenderFrame()	override {}
+			void EndFrame()		override;
+
+			int frameCount;
+		};
+	}
+}
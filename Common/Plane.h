@@ -13,7 +13,7 @@ _-_-_-_-_-_-_-""  ""
 *//////////////////////////////////////////////////////////////////////////////
 
 #pragma once
-#include "vector3.h"
+#include "Vector3.h"
 namespace NCL {
 	namespace Maths {
 		class Plane {
@@ -0,0 +1,215 @@
+#include "Profiler.h"
+#include "GameTimer.h"
+#include <mutex>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <fstream>
+
+using namespace NCL;
+
+std::atomic<bool>					Profiler::enabled(true);
+std::vector<Profiler::ZoneSummary>	Profiler::frameSummary;
+float								Profiler::frameTime		= 0.0f;
+int64_t								Profiler::frameStart	= GameTimer::GetNanoseconds();
+
+namespace {
+	/*
+	Each thread only ever writes to its own buffer, so the only thing shared
+	with the reader is the written count. The reader copies events out, and
+	then checks the count again - if the writer has lapped it in the
+	meantime, anything it copied from the lapped part is thrown away, rather
+	than trying to lock the writer out. The slots are relaxed atomics so that
+	reading one mid-write is just a stale value rather than undefined - on
+	x86 they're the same plain loads and stores as ever.
+	*/
+	struct EventSlot {
+		std::atomic<const char*>	name;
+		std::atomic<int64_t>		start;
+		std::atomic<int64_t>		end;
+		std::atomic<int>			depth;
+	};
+
+	struct ThreadBuffer {
+		static const uint64_t CAPACITY = 1 << 14;
+
+		ThreadBuffer(int id) : written(0), depth(0), id(id), summaryRead(0) {
+			name = "Thread " + std::to_string(id);
+		}
+
+		EventSlot				events[CAPACITY];
+		std::atomic<uint64_t>	written;
+		int						depth;		//only touched by the owning thread
+		int						id;
+		std::string				name;		//guarded by registryLock
+		uint64_t				summaryRead;//only touched by EndFrame
+	};
+
+	std::mutex									registryLock;
+	std::vector<std::unique_ptr<ThreadBuffer>>	registry;	//never shrinks, so buffers outlive their threads
+
+	thread_local ThreadBuffer* localBuffer = nullptr;
+
+	const int64_t traceEpoch = GameTimer::GetNanoseconds();
+
+	ThreadBuffer* GetThreadBuffer() {
+		if (!localBuffer) {
+			std::lock_guard<std::mutex> guard(registryLock);
+			registry.emplace_back(new ThreadBuffer((int)registry.size()));
+			localBuffer = registry.back().get();
+		}
+		return localBuffer;
+	}
+
+	//Copies out whichever events from index 'from' onwards are still intact,
+	//and returns the index after the last one written
+	uint64_t ReadEvents(const ThreadBuffer& buffer, uint64_t from, std::vector<ProfileEvent>& out) {
+		const uint64_t CAPACITY = ThreadBuffer::CAPACITY;
+
+		uint64_t to = buffer.written.load(std::memory_order_acquire);
+		from = std::max(from, to > CAPACITY ? to - CAPACITY : 0);
+
+		size_t firstOut = out.size();
+		for (uint64_t i = from; i < to; ++i) {
+			const EventSlot& slot = buffer.events[i % CAPACITY];
+			ProfileEvent e;
+			e.name	= slot.name.load(std::memory_order_relaxed);
+			e.start	= slot.start.load(std::memory_order_relaxed);
+			e.end	= slot.end.load(std::memory_order_relaxed);
+			e.depth	= slot.depth.load(std::memory_order_relaxed);
+			out.push_back(e);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		//The slot for index i gets reused while written == i + CAPACITY
+		uint64_t after	= buffer.written.load(std::memory_order_relaxed);
+		uint64_t safe	= after >= CAPACITY ? after - CAPACITY + 1 : 0;
+		if (safe > from) {
+			size_t lost = (size_t)std::min(safe - from, to - from);
+			out.erase(out.begin() + firstOut, out.begin() + firstOut + lost);
+		}
+		return to;
+	}
+
+	void WriteEscaped(std::ostream& file, const std::string& text) {
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				file << '\\';
+			}
+			file << c;
+		}
+	}
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> guard(registryLock);
+	buffer->name = name;
+}
+
+int Profiler::BeginZone() {
+	if (!IsEnabled()) {
+		return -1;
+	}
+	return GetThreadBuffer()->depth++;
+}
+
+void Profiler::EndZone(const char* name, int64_t start, int depth) {
+	int64_t end = GameTimer::GetNanoseconds();
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+	buffer->depth = depth;
+
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	EventSlot& slot = buffer->events[index % ThreadBuffer::CAPACITY];
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame() {
+	int64_t now = GameTimer::GetNanoseconds();
+	frameTime	= (now - frameStart) / 1000000.0f;
+	frameStart	= now;
+
+	std::vector<ProfileEvent> events;
+	{
+		std::lock_guard<std::mutex> guard(registryLock);
+		for (auto& buffer : registry) {
+			buffer->summaryRead = ReadEvents(*buffer, buffer->summaryRead, events);
+		}
+	}
+
+	std::map<std::string, ZoneSummary> zones;
+	for (const ProfileEvent& e : events) {
+		auto i = zones.find(e.name);
+		if (i == zones.end()) {
+			ZoneSummary zone = { e.name, 0.0f, 0, e.depth };
+			i = zones.insert(std::make_pair(zone.name, zone)).first;
+		}
+		i->second.milliseconds	+= (e.end - e.start) / 1000000.0f;
+		i->second.calls			+= 1;
+		i->second.depth			= std::min(i->second.depth, e.depth);
+	}
+
+	frameSummary.clear();
+	for (auto& i : zones) {
+		frameSummary.push_back(i.second);
+	}
+	std::sort(frameSummary.begin(), frameSummary.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+		return a.milliseconds > b.milliseconds;
+	});
+}
+
+/*
+The trace format is a list of 'complete' events (ph:X), each with a start
+time and duration in microseconds - the viewer works out the nesting from
+the times, so the depth isn't needed. The metadata events (ph:M) just give
+each thread id a readable name.
+*/
+bool Profiler::WriteChromeTrace(const std::string& filename) {
+	std::ofstream file(filename);
+	if (!file) {
+		return false;
+	}
+	file << "{\"traceEvents\":[\n";
+	file.setf(std::ios::fixed);
+	file.precision(3);
+
+	bool first = true;
+	std::vector<ProfileEvent> events;
+
+	std::lock_guard<std::mutex> guard(registryLock);
+	for (auto& buffer : registry) {
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+		WriteEscaped(file, buffer->name);
+		file << "\"}}";
+		first = false;
+
+		events.clear();
+		ReadEvents(*buffer, 0, events);
+
+		for (const ProfileEvent& e : events) {
+			file << ",\n{\"name\":\"";
+			WriteEscaped(file, e.name);
+			file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->id
+				<< ",\"ts\":"	<< (e.start - traceEpoch) / 1000.0
+				<< ",\"dur\":"	<< (e.end - e.start) / 1000.0 << "}";
+		}
+	}
+	file << "\n]}\n";
+	return (bool)file;
+}
+
+ProfileZone::ProfileZone(const char* name) : name(name) {
+	depth = Profiler::BeginZone();
+	start = depth >= 0 ? GameTimer::GetNanoseconds() : 0;
+}
+
+ProfileZone::~ProfileZone() {
+	if (depth >= 0) {
+		Profiler::EndZone(name, start, depth);
+	}
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+Class:Profiler
+Implements:
+Description:A lightweight scoped CPU profiler. Drop an NCL_PROFILE_ZONE("Name")
+(or NCL_PROFILE_FUNCTION()) at the top of a block, and the time spent until
+the end of that block gets recorded, along with how deeply it's nested inside
+other zones.
+
+Each thread writes its zones into its own fixed size ring buffer, so
+recording a zone never takes a lock - a thread only grabs the registry lock
+the very first time it records anything. Old zones get overwritten once a
+buffer wraps around, so only the last few thousand zones per thread are
+ever kept.
+
+Call EndFrame once a frame to build a summary of where that frame's time went
+(GetFrameSummary), and WriteChromeTrace to save everything still in the
+buffers as a .json file that chrome://tracing or ui.perfetto.dev can open.
+
+Defining NCL_DISABLE_PROFILER compiles the zones out entirely, and
+SetEnabled(false) turns them off at runtime.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+namespace NCL {
+	struct ProfileEvent {
+		const char* name;	//must outlive the profiler - use string literals!
+		int64_t		start;	//nanoseconds, from GameTimer::GetNanoseconds
+		int64_t		end;
+		int			depth;
+	};
+
+	class Profiler {
+	public:
+		struct ZoneSummary {
+			std::string name;
+			float		milliseconds;	//total across every call, including nested zones
+			int			calls;
+			int			depth;			//shallowest depth it was seen at
+		};
+
+		static void SetEnabled(bool state) {
+			enabled.store(state, std::memory_order_relaxed);
+		}
+
+		static bool IsEnabled() {
+			return enabled.load(std::memory_order_relaxed);
+		}
+
+		//Names the calling thread in the trace output
+		static void SetThreadName(const std::string& name);
+
+		//Marks the end of a frame, and totals up the zones that finished
+		//during it, on every thread
+		static void EndFrame();
+
+		//Sorted by longest first
+		static const std::vector<ZoneSummary>& GetFrameSummary() {
+			return frameSummary;
+		}
+
+		static float GetFrameTime() {
+			return frameTime;
+		}
+
+		//Writes out every zone still held in the ring buffers, in the Chrome
+		//trace event format. Returns false if the file couldn't be written
+		static bool WriteChromeTrace(const std::string& filename);
+
+		//Used by ProfileZone - call these directly if a zone can't be scoped
+		static int	BeginZone();
+		static void EndZone(const char* name, int64_t start, int depth);
+
+	protected:
+		static std::atomic<bool>		enabled;
+		static std::vector<ZoneSummary> frameSummary;
+		static float					frameTime;
+		static int64_t					frameStart;
+	};
+
+	class ProfileZone {
+	public:
+		ProfileZone(const char* name);
+		~ProfileZone();
+
+	protected:
+		const char* name;
+		int64_t		start;
+		int			depth;
+	};
+}
+
+#ifdef NCL_DISABLE_PROFILER
+#define NCL_PROFILE_ZONE(name)
+#else
+#define NCL_PROFILE_JOIN_INNER(a, b) a##b
+#define NCL_PROFILE_JOIN(a, b) NCL_PROFILE_JOIN_INNER(a, b)
+#define NCL_PROFILE_ZONE(name) NCL::ProfileZone NCL_PROFILE_JOIN(profileZone, __LINE__)(name)
+#endif
+
+#define NCL_PROFILE_FUNCTION() NCL_PROFILE_ZONE(__FUNCTION__)
@@ -2,6 +2,7 @@
 #include "Matrix3.h"
 #include "Maths.h"
 #include <algorithm>
+#include <cmath>
 
 using namespace NCL;
 using namespace NCL::Maths;
@@ -32,10 +33,22 @@ Quaternion::~Quaternion(void)
 }
 
 float Quaternion::Dot(const Quaternion &a,const Quaternion &b){
+#ifdef NCL_USE_SSE
+	return _mm_cvtss_f32(SIMD::Dot4(_mm_loadu_ps(a.array), _mm_loadu_ps(b.array)));
+#else
 	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+#endif
 }
 
 void Quaternion::Normalise(){
+#ifdef NCL_USE_SSE
+	__m128 q			= _mm_loadu_ps(array);
+	__m128 magnitude	= _mm_sqrt_ps(SIMD::Dot4(q, q));
+
+	if (_mm_cvtss_f32(magnitude) > 0.0f) {
+		_mm_storeu_ps(array, _mm_div_ps(q, magnitude));
+	}
+#else
 	float magnitude = sqrt(x*x + y*y + z*z + w*w);
 
 	if(magnitude > 0.0f){
@@ -46,6 +59,7 @@ void Quaternion::Normalise(){
 		z *= t;
 		w *= t;
 	}
+#endif
 }
 
 Matrix4 Quaternion::ToMatrix4() const{
@@ -130,9 +144,9 @@ Quaternion Quaternion::FromMatrix(const Matrix4 &m) {
 	//q.y = sqrt( max( 0.0f, (1.0f - m.values[0] + m.values[5] - m.values[10]) ) ) / 2.0f;
 	//q.z = sqrt( max( 0.0f, (1.0f - m.values[0] - m.values[5] + m.values[10]) ) ) / 2.0f;
 
-	//q.x = (float)_copysign( q.x, m.values[9] - m.values[6] );
-	//q.y = (float)_copysign( q.y, m.values[2] - m.values[8] );
-	//q.z = (float)_copysign( q.z, m.values[4] - m.values[1] );
+	//q.x = (float)std::copysign( q.x, m.values[9] - m.values[6] );
+	//q.y = (float)std::copysign( q.y, m.values[2] - m.values[8] );
+	//q.z = (float)std::copysign( q.z, m.values[4] - m.values[1] );
 
 	q.w = sqrt(std::max(0.0f, (1.0f + m.values[0] + m.values[5] + m.values[10])))  * 0.5f;
 
@@ -141,9 +155,9 @@ Quaternion Quaternion::FromMatrix(const Matrix4 &m) {
 		q.y = sqrt( std::max( 0.0f, (1.0f - m.values[0] + m.values[5] - m.values[10]) ) ) / 2.0f;
 		q.z = sqrt( std::max( 0.0f, (1.0f - m.values[0] - m.values[5] + m.values[10]) ) ) / 2.0f;
 
-		q.x = (float)_copysign( q.x, m.values[9] - m.values[6] );
-		q.y = (float)_copysign( q.y, m.values[2] - m.values[8] );
-		q.z = (float)_copysign( q.z, m.values[4] - m.values[1] );
+		q.x = (float)std::copysign( q.x, m.values[9] - m.values[6] );
+		q.y = (float)std::copysign( q.y, m.values[2] - m.values[8] );
+		q.z = (float)std::copysign( q.z, m.values[4] - m.values[1] );
 	}
 	else {
 		float qrFour = 4.0f * q.w;
@@ -165,9 +179,9 @@ Quaternion Quaternion::FromMatrix(const Matrix3 &m) {
 	//q.y = sqrt(max(0.0f, (1.0f - m.values[0] + m.values[4] - m.values[8]))) / 2.0f;
 	//q.z = sqrt(max(0.0f, (1.0f - m.values[0] - m.values[4] + m.values[8]))) / 2.0f;
 
-	//q.x = (float)_copysign(q.x, m.values[7] - m.values[5]);
-	//q.y = (float)_copysign(q.y, m.values[2] - m.values[6]);
-	//q.z = (float)_copysign(q.z, m.values[3] - m.values[1]);
+	//q.x = (float)std::copysign(q.x, m.values[7] - m.values[5]);
+	//q.y = (float)std::copysign(q.y, m.values[2] - m.values[6]);
+	//q.z = (float)std::copysign(q.z, m.values[3] - m.values[1]);
 
 	q.w = sqrt(std::max(0.0f, (1.0f + m.values[0] + m.values[4] + m.values[8]))) * 0.5f;
 
@@ -26,7 +26,7 @@ namespace NCL {
 	namespace Maths {
 		class Matrix4;
 
-		class Quaternion {
+		class NCL_SIMD_ALIGN Quaternion {
 		public:
 			union {
 				struct {
@@ -85,12 +85,35 @@ namespace NCL {
 			}
 
 			inline Quaternion  operator *(const Quaternion &b)	const {
+#ifdef NCL_USE_SSE
+				/*
+				Each lane of the result is a sum of 4 products - the shuffles line
+				up the right pairs of components, and the sign mask flips the
+				w lane, which subtracts where the other 3 add.
+				*/
+				__m128 qa		= _mm_loadu_ps(array);
+				__m128 qb		= _mm_loadu_ps(b.array);
+				__m128 wSign	= _mm_set_ps(-0.0f, 0.0f, 0.0f, 0.0f);
+
+				__m128 t0 = _mm_mul_ps(qa, _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(3, 3, 3, 3)));
+				__m128 t1 = _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(0, 3, 3, 3)), _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(0, 2, 1, 0)));
+				__m128 t2 = _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(1, 1, 0, 2)));
+				__m128 t3 = _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(2, 1, 0, 2)), _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(2, 0, 2, 1)));
+
+				__m128 r = _mm_add_ps(t0, _mm_xor_ps(_mm_add_ps(t1, t2), wSign));
+				r = _mm_sub_ps(r, t3);
+
+				Quaternion out;
+				_mm_storeu_ps(out.array, r);
+				return out;
+#else
 				return Quaternion(
 					(x * b.w) + (w * b.x) + (y * b.z) - (z * b.y),
 					(y * b.w) + (w * b.y) + (z * b.x) - (x * b.z),
 					(z * b.w) + (w * b.z) + (x * b.y) - (y * b.x),
 					(w * b.w) - (x * b.x) - (y * b.y) - (z * b.z)
 				);
+#endif
 			}
 
 			inline Vector3		operator *(const Vector3 &a)	const {
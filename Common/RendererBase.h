@@ -12,12 +12,14 @@ _-_-_-_-_-_-_-""  ""
 *//////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "Window.h"
+#include "Vector3.h"
+#include "Vector4.h"
 
 namespace NCL {
 	namespace Rendering {
 		class RendererBase {
 		public:
-			friend class Window;
+			friend class NCL::Window;
 
 			RendererBase(Window& w);
 			virtual ~RendererBase();
@@ -26,6 +28,11 @@ namespace NCL {
 
 			virtual void Update(float msec) {}
 
+			//Debug drawing - renderers that can't draw text or lines can
+			//just leave these alone
+			virtual void DrawString(const std::string& text, const Vector2& pos, const Vector4& colour = Vector4(0.75f, 0.75f, 0.75f, 1)) {}
+			virtual void DrawLine(const Vector3& start, const Vector3& end, const Vector4& colour) {}
+
 			void Render() {
 				BeginFrame();
 				RenderFrame();
@@ -0,0 +1,67 @@
+/******************************************************************************
+Class:SIMD
+Implements:
+Description:Picks which backend the maths classes use. On x64 every CPU has
+SSE2, and the heap hands out 16 byte aligned memory, so the SSE paths are
+used by default. Anywhere else - or if NCL_FORCE_SCALAR is defined, which is
+handy for checking the SSE results against the plain C++ versions - the
+original scalar code is used instead.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#if !defined(NCL_FORCE_SCALAR) && (defined(_M_X64) || defined(__x86_64__))
+#define NCL_USE_SSE
+#endif
+
+#ifdef NCL_USE_SSE
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#define NCL_SIMD_ALIGN alignas(16)
+#else
+#define NCL_SIMD_ALIGN
+#endif
+
+#ifdef NCL_USE_SSE
+namespace NCL {
+	namespace Maths {
+		namespace SIMD {
+			//Adds up all 4 lanes of a * b, and puts the result in every lane
+			inline __m128 Dot4(__m128 a, __m128 b) {
+				__m128 m		= _mm_mul_ps(a, b);
+				__m128 shuf		= _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1));
+				__m128 sums		= _mm_add_ps(m, shuf);
+				shuf			= _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+				return _mm_add_ps(sums, shuf);
+			}
+
+			//Only the xyz lanes are used - w comes out as 0
+			inline __m128 Cross3(__m128 a, __m128 b) {
+				__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+				__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+				__m128 c	= _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+				return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+			}
+
+			//Multiplies the 4 columns starting at m by v
+			inline __m128 Transform4(const float* m, __m128 v) {
+				__m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+				__m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+				__m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+				__m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+				__m128 r = _mm_mul_ps(_mm_loadu_ps(m), x);
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 4), y));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 8), z));
+				r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 12), w));
+				return r;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,179 @@
+#include "TRSBatch.h"
+#include "SIMD.h"
+
+using namespace NCL;
+using namespace Maths;
+
+void TRSBatch::Clear() {
+	px.clear(); py.clear(); pz.clear();
+	qx.clear(); qy.clear(); qz.clear(); qw.clear();
+	sx.clear(); sy.clear(); sz.clear();
+}
+
+void TRSBatch::Reserve(size_t count) {
+	px.reserve(count); py.reserve(count); pz.reserve(count);
+	qx.reserve(count); qy.reserve(count); qz.reserve(count); qw.reserve(count);
+	sx.reserve(count); sy.reserve(count); sz.reserve(count);
+}
+
+size_t TRSBatch::Add(const Vector3& position, const Quaternion& orientation, const Vector3& scale) {
+	px.emplace_back(position.x);
+	py.emplace_back(position.y);
+	pz.emplace_back(position.z);
+
+	qx.emplace_back(orientation.x);
+	qy.emplace_back(orientation.y);
+	qz.emplace_back(orientation.z);
+	qw.emplace_back(orientation.w);
+
+	sx.emplace_back(scale.x);
+	sy.emplace_back(scale.y);
+	sz.emplace_back(scale.z);
+
+	return px.size() - 1;
+}
+
+/*
+This is Quaternion::ToMatrix3, with each column multiplied by its scale,
+and the translation dropped into the last column.
+*/
+static void BuildTRS(float x, float y, float z, float w,
+	float tx, float ty, float tz, float sx, float sy, float sz, float* m) {
+	float xx = x * x;	float yy = y * y;	float zz = z * z;
+	float xy = x * y;	float xz = x * z;	float yz = y * z;
+	float xw = x * w;	float yw = y * w;	float zw = z * w;
+
+	m[0]  = (1 - 2 * yy - 2 * zz) * sx;
+	m[1]  = (2 * xy + 2 * zw) * sx;
+	m[2]  = (2 * xz - 2 * yw) * sx;
+	m[3]  = 0.0f;
+
+	m[4]  = (2 * xy - 2 * zw) * sy;
+	m[5]  = (1 - 2 * xx - 2 * zz) * sy;
+	m[6]  = (2 * yz + 2 * xw) * sy;
+	m[7]  = 0.0f;
+
+	m[8]  = (2 * xz + 2 * yw) * sz;
+	m[9]  = (2 * yz - 2 * xw) * sz;
+	m[10] = (1 - 2 * xx - 2 * yy) * sz;
+	m[11] = 0.0f;
+
+	m[12] = tx;
+	m[13] = ty;
+	m[14] = tz;
+	m[15] = 1.0f;
+}
+
+void TRSBatch::ComposeScalar(size_t i, Matrix4& out) const {
+	BuildTRS(qx[i], qy[i], qz[i], qw[i], px[i], py[i], pz[i], sx[i], sy[i], sz[i], out.values);
+}
+
+Matrix4 TRSBatch::Compose(const Vector3& position, const Quaternion& orientation, const Vector3& scale) {
+	Matrix4 out;
+	BuildTRS(orientation.x, orientation.y, orientation.z, orientation.w,
+		position.x, position.y, position.z, scale.x, scale.y, scale.z, out.values);
+	return out;
+}
+
+namespace {
+	Matrix4& Target(Matrix4* out, size_t i) {
+		return out[i];
+	}
+
+	Matrix4& Target(Matrix4* const* out, size_t i) {
+		return *out[i];
+	}
+}
+
+template <typename Output>
+void TRSBatch::ComposeInto(Output out) const {
+	size_t count	= Size();
+	size_t i		= 0;
+#ifdef NCL_USE_SSE
+	/*
+	Each register holds the same matrix element for 4 different objects, so
+	the maths is exactly the same as BuildTRS. At the end, each column is a
+	4x4 transpose away from being 4 columns of 4 different matrices.
+	*/
+	const __m128 one	= _mm_set1_ps(1.0f);
+	const __m128 two	= _mm_set1_ps(2.0f);
+	const __m128 zero	= _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(&qx[i]);
+		__m128 y = _mm_loadu_ps(&qy[i]);
+		__m128 z = _mm_loadu_ps(&qz[i]);
+		__m128 w = _mm_loadu_ps(&qw[i]);
+
+		__m128 xx = _mm_mul_ps(_mm_mul_ps(x, x), two);
+		__m128 yy = _mm_mul_ps(_mm_mul_ps(y, y), two);
+		__m128 zz = _mm_mul_ps(_mm_mul_ps(z, z), two);
+		__m128 xy = _mm_mul_ps(_mm_mul_ps(x, y), two);
+		__m128 xz = _mm_mul_ps(_mm_mul_ps(x, z), two);
+		__m128 yz = _mm_mul_ps(_mm_mul_ps(y, z), two);
+		__m128 xw = _mm_mul_ps(_mm_mul_ps(x, w), two);
+		__m128 yw = _mm_mul_ps(_mm_mul_ps(y, w), two);
+		__m128 zw = _mm_mul_ps(_mm_mul_ps(z, w), two);
+
+		__m128 scaleX = _mm_loadu_ps(&sx[i]);
+		__m128 scaleY = _mm_loadu_ps(&sy[i]);
+		__m128 scaleZ = _mm_loadu_ps(&sz[i]);
+
+		__m128 c0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, yy), zz), scaleX);
+		__m128 c1 = _mm_mul_ps(_mm_add_ps(xy, zw), scaleX);
+		__m128 c2 = _mm_mul_ps(_mm_sub_ps(xz, yw), scaleX);
+		__m128 c3 = zero;
+
+		__m128 c4 = _mm_mul_ps(_mm_sub_ps(xy, zw), scaleY);
+		__m128 c5 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx), zz), scaleY);
+		__m128 c6 = _mm_mul_ps(_mm_add_ps(yz, xw), scaleY);
+		__m128 c7 = zero;
+
+		__m128 c8  = _mm_mul_ps(_mm_add_ps(xz, yw), scaleZ);
+		__m128 c9  = _mm_mul_ps(_mm_sub_ps(yz, xw), scaleZ);
+		__m128 c10 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx), yy), scaleZ);
+		__m128 c11 = zero;
+
+		__m128 c12 = _mm_loadu_ps(&px[i]);
+		__m128 c13 = _mm_loadu_ps(&py[i]);
+		__m128 c14 = _mm_loadu_ps(&pz[i]);
+		__m128 c15 = one;
+
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_MM_TRANSPOSE4_PS(c4, c5, c6, c7);
+		_MM_TRANSPOSE4_PS(c8, c9, c10, c11);
+		_MM_TRANSPOSE4_PS(c12, c13, c14, c15);
+
+		_mm_storeu_ps(&Target(out, i + 0).values[0], c0);
+		_mm_storeu_ps(&Target(out, i + 1).values[0], c1);
+		_mm_storeu_ps(&Target(out, i + 2).values[0], c2);
+		_mm_storeu_ps(&Target(out, i + 3).values[0], c3);
+
+		_mm_storeu_ps(&Target(out, i + 0).values[4], c4);
+		_mm_storeu_ps(&Target(out, i + 1).values[4], c5);
+		_mm_storeu_ps(&Target(out, i + 2).values[4], c6);
+		_mm_storeu_ps(&Target(out, i + 3).values[4], c7);
+
+		_mm_storeu_ps(&Target(out, i + 0).values[8], c8);
+		_mm_storeu_ps(&Target(out, i + 1).values[8], c9);
+		_mm_storeu_ps(&Target(out, i + 2).values[8], c10);
+		_mm_storeu_ps(&Target(out, i + 3).values[8], c11);
+
+		_mm_storeu_ps(&Target(out, i + 0).values[12], c12);
+		_mm_storeu_ps(&Target(out, i + 1).values[12], c13);
+		_mm_storeu_ps(&Target(out, i + 2).values[12], c14);
+		_mm_storeu_ps(&Target(out, i + 3).values[12], c15);
+	}
+#endif
+	for (; i < count; ++i) { //Whatever's left over
+		ComposeScalar(i, Target(out, i));
+	}
+}
+
+void TRSBatch::Compose(Matrix4* out) const {
+	ComposeInto(out);
+}
+
+void TRSBatch::Compose(Matrix4* const* out) const {
+	ComposeInto(out);
+}
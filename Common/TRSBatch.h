@@ -0,0 +1,64 @@
+/******************************************************************************
+Class:TRSBatch
+Implements:
+Description:Builds lots of Translation * Rotation * Scale matrices in one go.
+Positions, orientations and scales are added to the batch, and are stored as
+separate arrays of floats, so that Compose can work on 4 objects at a time
+using SSE, writing the finished matrices out into one contiguous array.
+
+Rather than multiply 3 matrices together, the rotation matrix is built
+straight from the quaternion, and each of its columns scaled by the matching
+scale axis - the same result, without the 2 full 4x4 multiplies.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include <vector>
+
+namespace NCL {
+	namespace Maths {
+		class TRSBatch {
+		public:
+			TRSBatch() {}
+			~TRSBatch() {}
+
+			void	Clear();
+			void	Reserve(size_t count);
+
+			//Returns the index the result will be written to in Compose
+			size_t	Add(const Vector3& position, const Quaternion& orientation, const Vector3& scale);
+
+			size_t	Size() const {
+				return px.size();
+			}
+
+			//out must have room for Size() matrices
+			void	Compose(Matrix4* out) const;
+
+			//Writes each matrix to wherever out has a pointer for it, so they
+			//can go straight to where they're needed, rather than being
+			//copied out of a contiguous array afterwards
+			void	Compose(Matrix4* const* out) const;
+
+			//Single matrix version, for when there's nothing to batch up
+			static Matrix4 Compose(const Vector3& position, const Quaternion& orientation, const Vector3& scale);
+
+		protected:
+			template <typename Output>
+			void ComposeInto(Output out) const;
+
+			void ComposeScalar(size_t i, Matrix4& out) const;
+
+			std::vector<float> px, py, pz;
+			std::vector<float> qx, qy, qz, qw;
+			std::vector<float> sx, sy, sz;
+		};
+	}
+}
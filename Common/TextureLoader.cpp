@@ -3,9 +3,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 
 #include "./stb/stb_image.h"
-#include <filesystem>
 #include "Assets.h"
-using namespace std::experimental::filesystem::v1;
 
 using namespace NCL;
 using namespace Rendering;
@@ -43,11 +41,14 @@ void TextureLoader::RegisterTextureLoadFunction(TextureLoadFunction f, const std
 }
 
 std::string TextureLoader::GetFileExtension(const std::string& fileExtension) {
-	path p = path(fileExtension);
+	//Everything from the last '.' in the file name, as path::extension does
+	size_t dot		= fileExtension.find_last_of('.');
+	size_t slash	= fileExtension.find_last_of("/\\");
 
-	path ext = p.extension();
-
-	return ext.string();
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+		return "";
+	}
+	return fileExtension.substr(dot);
 }
 
 void TextureLoader::RegisterAPILoadFunction(APILoadFunction f) {
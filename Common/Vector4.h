@@ -11,10 +11,12 @@ _-_-_-_-_-_-_-""  ""
 
 */
 #pragma once
+#include "SIMD.h"
+#include <cmath>
 
 namespace NCL {
 	namespace Maths {
-		class Vector4 {
+		class NCL_SIMD_ALIGN Vector4 {
 		public:
 			Vector4(void) {
 				x = y = z = w = 1.0f;
@@ -38,8 +40,68 @@ namespace NCL {
 			float w;
 
 
+#ifdef NCL_USE_SSE
+			Vector4(__m128 v) {
+				_mm_storeu_ps(&x, v);
+			}
+
+			inline __m128 ToSSE() const {
+				return _mm_loadu_ps(&x);
+			}
+#endif
+
+			static float Dot(const Vector4 &a, const Vector4 &b) {
+#ifdef NCL_USE_SSE
+				return _mm_cvtss_f32(SIMD::Dot4(a.ToSSE(), b.ToSSE()));
+#else
+				return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+#endif
+			}
+
+			//Cross product of the xyz parts - w is set to 0
+			static Vector4 Cross(const Vector4 &a, const Vector4 &b) {
+#ifdef NCL_USE_SSE
+				return Vector4(SIMD::Cross3(a.ToSSE(), b.ToSSE()));
+#else
+				return Vector4((a.y*b.z) - (a.z*b.y), (a.z*b.x) - (a.x*b.z), (a.x*b.y) - (a.y*b.x), 0.0f);
+#endif
+			}
+
+			float Length() const {
+				return sqrt(Dot(*this, *this));
+			}
+
+			void Normalise() {
+#ifdef NCL_USE_SSE
+				__m128 v	= ToSSE();
+				__m128 len	= _mm_sqrt_ps(SIMD::Dot4(v, v));
+				if (_mm_cvtss_f32(len) != 0.0f) {
+					_mm_storeu_ps(&x, _mm_div_ps(v, len));
+				}
+#else
+				float length = Length();
+				if (length != 0.0f) {
+					length = 1.0f / length;
+					x = x * length;
+					y = y * length;
+					z = z * length;
+					w = w * length;
+				}
+#endif
+			}
+
+			Vector4 Normalised() const {
+				Vector4 temp(*this);
+				temp.Normalise();
+				return temp;
+			}
+
 			inline Vector4  operator*(const float a) const {
+#ifdef NCL_USE_SSE
+				return Vector4(_mm_mul_ps(ToSSE(), _mm_set1_ps(a)));
+#else
 				return Vector4(x * a, y * a, z * a, w * a);
+#endif
 			}
 
 			inline Vector4  operator/(const float a) const {
@@ -48,11 +110,27 @@ namespace NCL {
 			}
 
 			inline Vector4  operator+(const Vector4  &a) const {
+#ifdef NCL_USE_SSE
+				return Vector4(_mm_add_ps(ToSSE(), a.ToSSE()));
+#else
 				return Vector4(x + a.x, y + a.y, z + a.z, w + a.w);
+#endif
 			}
 
 			inline Vector4  operator-(const Vector4  &a) const {
+#ifdef NCL_USE_SSE
+				return Vector4(_mm_sub_ps(ToSSE(), a.ToSSE()));
+#else
 				return Vector4(x - a.x, y - a.y, z - a.z, w - a.w);
+#endif
+			}
+
+			inline Vector4  operator*(const Vector4  &a) const {
+#ifdef NCL_USE_SSE
+				return Vector4(_mm_mul_ps(ToSSE(), a.ToSSE()));
+#else
+				return Vector4(x * a.x, y * a.y, z * a.z, w * a.w);
+#endif
 			}
 
 			inline void operator+=(const Vector4  &a) {
@@ -0,0 +1,608 @@
+/******************************************************************************
+Class:Floatx4, Floatx8, Vector3x4, Vector3x8, Quaternionx4, Matrix3x4
+Implements:
+Description:'Wide' maths types, for doing the same sums on several objects
+at once. Rather than storing x,y,z together for each vector (Array of
+Structures), each of these stores all of the xs together, all of the ys
+together and so on (Structure of Arrays), so one SSE instruction can work on
+4 (or, with AVX, 8) different vectors at a time.
+
+Comparisons return masks rather than bools - a lane is all 1s if the test
+passed for that lane - which can then be used with Select to pick between
+two results, or tested with AnyTrue / AllTrue / MoveMask.
+
+Use Load / Store to transpose to and from arrays of the normal Vector3 and
+Quaternion types, and Gather / Scatter to work on an arbitrary set of them.
+
+-_-_-_-_-_-_-_,------,
+_-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
+-_-_-_-_-_-_-~|__( ^ .^) /
+_-_-_-_-_-_-_-""  ""
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "SIMD.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Matrix3.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(NCL_USE_SSE) && defined(__AVX__)
+#include <immintrin.h>
+#define NCL_USE_AVX
+#endif
+
+namespace NCL {
+	namespace Maths {
+		class Floatx4 {
+		public:
+			static const int Width = 4;
+
+			Floatx4() {}
+#ifdef NCL_USE_SSE
+			Floatx4(float f) : v(_mm_set1_ps(f)) {}
+			Floatx4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+			explicit Floatx4(__m128 in) : v(in) {}
+
+			static Floatx4 Load(const float* p)		{ return Floatx4(_mm_loadu_ps(p)); }
+			void Store(float* p) const				{ _mm_storeu_ps(p, v); }
+
+			Floatx4 operator+(const Floatx4& a) const { return Floatx4(_mm_add_ps(v, a.v)); }
+			Floatx4 operator-(const Floatx4& a) const { return Floatx4(_mm_sub_ps(v, a.v)); }
+			Floatx4 operator*(const Floatx4& a) const { return Floatx4(_mm_mul_ps(v, a.v)); }
+			Floatx4 operator/(const Floatx4& a) const { return Floatx4(_mm_div_ps(v, a.v)); }
+			Floatx4 operator-() const				  { return Floatx4(_mm_xor_ps(v, _mm_set1_ps(-0.0f))); }
+
+			Floatx4 operator< (const Floatx4& a) const { return Floatx4(_mm_cmplt_ps(v, a.v)); }
+			Floatx4 operator<=(const Floatx4& a) const { return Floatx4(_mm_cmple_ps(v, a.v)); }
+			Floatx4 operator> (const Floatx4& a) const { return Floatx4(_mm_cmpgt_ps(v, a.v)); }
+			Floatx4 operator>=(const Floatx4& a) const { return Floatx4(_mm_cmpge_ps(v, a.v)); }
+			Floatx4 operator==(const Floatx4& a) const { return Floatx4(_mm_cmpeq_ps(v, a.v)); }
+			Floatx4 operator!=(const Floatx4& a) const { return Floatx4(_mm_cmpneq_ps(v, a.v)); }
+
+			Floatx4 operator&(const Floatx4& a) const { return Floatx4(_mm_and_ps(v, a.v)); }
+			Floatx4 operator|(const Floatx4& a) const { return Floatx4(_mm_or_ps(v, a.v)); }
+			Floatx4 operator^(const Floatx4& a) const { return Floatx4(_mm_xor_ps(v, a.v)); }
+
+			static Floatx4 Sqrt(const Floatx4& a)						{ return Floatx4(_mm_sqrt_ps(a.v)); }
+			static Floatx4 Min(const Floatx4& a, const Floatx4& b)		{ return Floatx4(_mm_min_ps(a.v, b.v)); }
+			static Floatx4 Max(const Floatx4& a, const Floatx4& b)		{ return Floatx4(_mm_max_ps(a.v, b.v)); }
+			static Floatx4 Abs(const Floatx4& a)						{ return Floatx4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+
+			//mask ? a : b, for each lane
+			static Floatx4 Select(const Floatx4& mask, const Floatx4& a, const Floatx4& b) {
+				return Floatx4(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+			}
+
+			//One bit per lane, set if that lane of the mask is set
+			static int MoveMask(const Floatx4& mask) {
+				return _mm_movemask_ps(mask.v);
+			}
+
+			__m128 v;
+#else
+			Floatx4(float f)							{ for (int i = 0; i < 4; ++i) { v[i] = f; } }
+			Floatx4(float a, float b, float c, float d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+
+			static Floatx4 Load(const float* p)		{ Floatx4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+			void Store(float* p) const				{ memcpy(p, v, sizeof(v)); }
+
+			Floatx4 operator+(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = v[i] + a.v[i]; } return r; }
+			Floatx4 operator-(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = v[i] - a.v[i]; } return r; }
+			Floatx4 operator*(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = v[i] * a.v[i]; } return r; }
+			Floatx4 operator/(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = v[i] / a.v[i]; } return r; }
+			Floatx4 operator-() const				  { Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = -v[i]; } return r; }
+
+			Floatx4 operator< (const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] <  a.v[i]); } return r; }
+			Floatx4 operator<=(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] <= a.v[i]); } return r; }
+			Floatx4 operator> (const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] >  a.v[i]); } return r; }
+			Floatx4 operator>=(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] >= a.v[i]); } return r; }
+			Floatx4 operator==(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] == a.v[i]); } return r; }
+			Floatx4 operator!=(const Floatx4& a) const { Floatx4 r; for (int i = 0; i < 4; ++i) { r.SetMaskLane(i, v[i] != a.v[i]); } return r; }
+
+			Floatx4 operator&(const Floatx4& a) const { return Bitwise(a, [](uint32_t x, uint32_t y) { return x & y; }); }
+			Floatx4 operator|(const Floatx4& a) const { return Bitwise(a, [](uint32_t x, uint32_t y) { return x | y; }); }
+			Floatx4 operator^(const Floatx4& a) const { return Bitwise(a, [](uint32_t x, uint32_t y) { return x ^ y; }); }
+
+			static Floatx4 Sqrt(const Floatx4& a)						{ Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = sqrt(a.v[i]); } return r; }
+			static Floatx4 Min(const Floatx4& a, const Floatx4& b)		{ Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; } return r; }
+			static Floatx4 Max(const Floatx4& a, const Floatx4& b)		{ Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; } return r; }
+			static Floatx4 Abs(const Floatx4& a)						{ Floatx4 r; for (int i = 0; i < 4; ++i) { r.v[i] = fabs(a.v[i]); } return r; }
+
+			static Floatx4 Select(const Floatx4& mask, const Floatx4& a, const Floatx4& b) {
+				Floatx4 r;
+				for (int i = 0; i < 4; ++i) {
+					r.v[i] = mask.GetMaskLane(i) ? a.v[i] : b.v[i];
+				}
+				return r;
+			}
+
+			static int MoveMask(const Floatx4& mask) {
+				int bits = 0;
+				for (int i = 0; i < 4; ++i) {
+					bits |= mask.GetMaskLane(i) ? (1 << i) : 0;
+				}
+				return bits;
+			}
+
+			float v[4];
+
+		protected:
+			void SetMaskLane(int i, bool state) {
+				uint32_t bits = state ? 0xFFFFFFFF : 0;
+				memcpy(&v[i], &bits, sizeof(float));
+			}
+
+			bool GetMaskLane(int i) const {
+				uint32_t bits;
+				memcpy(&bits, &v[i], sizeof(float));
+				return (bits & 0x80000000) != 0;
+			}
+
+			template<class F>
+			Floatx4 Bitwise(const Floatx4& a, F func) const {
+				Floatx4 r;
+				for (int i = 0; i < 4; ++i) {
+					uint32_t x, y;
+					memcpy(&x, &v[i], sizeof(float));
+					memcpy(&y, &a.v[i], sizeof(float));
+					uint32_t out = func(x, y);
+					memcpy(&r.v[i], &out, sizeof(float));
+				}
+				return r;
+			}
+#endif
+		public:
+			float GetLane(int i) const {
+				float temp[4];
+				Store(temp);
+				return temp[i];
+			}
+
+			void SetLane(int i, float f) {
+				float temp[4];
+				Store(temp);
+				temp[i] = f;
+				*this = Load(temp);
+			}
+
+			static bool AnyTrue(const Floatx4& mask) { return MoveMask(mask) != 0; }
+			static bool AllTrue(const Floatx4& mask) { return MoveMask(mask) == 0xF; }
+		};
+
+		/*
+		With AVX, 8 lanes fit into one register. Without it, a Floatx8 is just
+		a pair of Floatx4s, so code written for 8 lanes still works anywhere.
+		*/
+		class Floatx8 {
+		public:
+			static const int Width = 8;
+
+			Floatx8() {}
+#ifdef NCL_USE_AVX
+			Floatx8(float f) : v(_mm256_set1_ps(f)) {}
+			explicit Floatx8(__m256 in) : v(in) {}
+
+			static Floatx8 Load(const float* p)		{ return Floatx8(_mm256_loadu_ps(p)); }
+			void Store(float* p) const				{ _mm256_storeu_ps(p, v); }
+
+			Floatx8 operator+(const Floatx8& a) const { return Floatx8(_mm256_add_ps(v, a.v)); }
+			Floatx8 operator-(const Floatx8& a) const { return Floatx8(_mm256_sub_ps(v, a.v)); }
+			Floatx8 operator*(const Floatx8& a) const { return Floatx8(_mm256_mul_ps(v, a.v)); }
+			Floatx8 operator/(const Floatx8& a) const { return Floatx8(_mm256_div_ps(v, a.v)); }
+			Floatx8 operator-() const				  { return Floatx8(_mm256_xor_ps(v, _mm256_set1_ps(-0.0f))); }
+
+			Floatx8 operator< (const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_LT_OQ)); }
+			Floatx8 operator<=(const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_LE_OQ)); }
+			Floatx8 operator> (const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_GT_OQ)); }
+			Floatx8 operator>=(const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_GE_OQ)); }
+			Floatx8 operator==(const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_EQ_OQ)); }
+			Floatx8 operator!=(const Floatx8& a) const { return Floatx8(_mm256_cmp_ps(v, a.v, _CMP_NEQ_UQ)); }
+
+			Floatx8 operator&(const Floatx8& a) const { return Floatx8(_mm256_and_ps(v, a.v)); }
+			Floatx8 operator|(const Floatx8& a) const { return Floatx8(_mm256_or_ps(v, a.v)); }
+			Floatx8 operator^(const Floatx8& a) const { return Floatx8(_mm256_xor_ps(v, a.v)); }
+
+			static Floatx8 Sqrt(const Floatx8& a)					{ return Floatx8(_mm256_sqrt_ps(a.v)); }
+			static Floatx8 Min(const Floatx8& a, const Floatx8& b)	{ return Floatx8(_mm256_min_ps(a.v, b.v)); }
+			static Floatx8 Max(const Floatx8& a, const Floatx8& b)	{ return Floatx8(_mm256_max_ps(a.v, b.v)); }
+			static Floatx8 Abs(const Floatx8& a)					{ return Floatx8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+
+			static Floatx8 Select(const Floatx8& mask, const Floatx8& a, const Floatx8& b) {
+				return Floatx8(_mm256_blendv_ps(b.v, a.v, mask.v));
+			}
+
+			static int MoveMask(const Floatx8& mask) {
+				return _mm256_movemask_ps(mask.v);
+			}
+
+			__m256 v;
+#else
+			Floatx8(float f) : lo(f), hi(f) {}
+			Floatx8(const Floatx4& l, const Floatx4& h) : lo(l), hi(h) {}
+
+			static Floatx8 Load(const float* p)		{ return Floatx8(Floatx4::Load(p), Floatx4::Load(p + 4)); }
+			void Store(float* p) const				{ lo.Store(p); hi.Store(p + 4); }
+
+			Floatx8 operator+(const Floatx8& a) const { return Floatx8(lo + a.lo, hi + a.hi); }
+			Floatx8 operator-(const Floatx8& a) const { return Floatx8(lo - a.lo, hi - a.hi); }
+			Floatx8 operator*(const Floatx8& a) const { return Floatx8(lo * a.lo, hi * a.hi); }
+			Floatx8 operator/(const Floatx8& a) const { return Floatx8(lo / a.lo, hi / a.hi); }
+			Floatx8 operator-() const				  { return Floatx8(-lo, -hi); }
+
+			Floatx8 operator< (const Floatx8& a) const { return Floatx8(lo <  a.lo, hi <  a.hi); }
+			Floatx8 operator<=(const Floatx8& a) const { return Floatx8(lo <= a.lo, hi <= a.hi); }
+			Floatx8 operator> (const Floatx8& a) const { return Floatx8(lo >  a.lo, hi >  a.hi); }
+			Floatx8 operator>=(const Floatx8& a) const { return Floatx8(lo >= a.lo, hi >= a.hi); }
+			Floatx8 operator==(const Floatx8& a) const { return Floatx8(lo == a.lo, hi == a.hi); }
+			Floatx8 operator!=(const Floatx8& a) const { return Floatx8(lo != a.lo, hi != a.hi); }
+
+			Floatx8 operator&(const Floatx8& a) const { return Floatx8(lo & a.lo, hi & a.hi); }
+			Floatx8 operator|(const Floatx8& a) const { return Floatx8(lo | a.lo, hi | a.hi); }
+			Floatx8 operator^(const Floatx8& a) const { return Floatx8(lo ^ a.lo, hi ^ a.hi); }
+
+			static Floatx8 Sqrt(const Floatx8& a)					{ return Floatx8(Floatx4::Sqrt(a.lo), Floatx4::Sqrt(a.hi)); }
+			static Floatx8 Min(const Floatx8& a, const Floatx8& b)	{ return Floatx8(Floatx4::Min(a.lo, b.lo), Floatx4::Min(a.hi, b.hi)); }
+			static Floatx8 Max(const Floatx8& a, const Floatx8& b)	{ return Floatx8(Floatx4::Max(a.lo, b.lo), Floatx4::Max(a.hi, b.hi)); }
+			static Floatx8 Abs(const Floatx8& a)					{ return Floatx8(Floatx4::Abs(a.lo), Floatx4::Abs(a.hi)); }
+
+			static Floatx8 Select(const Floatx8& mask, const Floatx8& a, const Floatx8& b) {
+				return Floatx8(Floatx4::Select(mask.lo, a.lo, b.lo), Floatx4::Select(mask.hi, a.hi, b.hi));
+			}
+
+			static int MoveMask(const Floatx8& mask) {
+				return Floatx4::MoveMask(mask.lo) | (Floatx4::MoveMask(mask.hi) << 4);
+			}
+
+			Floatx4 lo;
+			Floatx4 hi;
+#endif
+			float GetLane(int i) const {
+				float temp[8];
+				Store(temp);
+				return temp[i];
+			}
+
+			void SetLane(int i, float f) {
+				float temp[8];
+				Store(temp);
+				temp[i] = f;
+				*this = Load(temp);
+			}
+
+			static bool AnyTrue(const Floatx8& mask) { return MoveMask(mask) != 0; }
+			static bool AllTrue(const Floatx8& mask) { return MoveMask(mask) == 0xFF; }
+		};
+
+		/*
+		The wide vector types are written once, in terms of whichever float
+		type is used for their lanes - so a Vector3x4 and Vector3x8 share all
+		of the same code.
+		*/
+		template<class F>
+		class Vector3Wide {
+		public:
+			static const int Width = F::Width;
+
+			Vector3Wide() {}
+			Vector3Wide(const F& inX, const F& inY, const F& inZ) : x(inX), y(inY), z(inZ) {}
+
+			//Puts the same vector in every lane
+			explicit Vector3Wide(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+
+			//Transposes count vectors (up to Width) from src into the lanes.
+			//Any lanes past count are zeroed
+			static Vector3Wide Load(const Vector3* src, int count = Width) {
+				float xs[Width] = { 0 };
+				float ys[Width] = { 0 };
+				float zs[Width] = { 0 };
+				for (int i = 0; i < count && i < Width; ++i) {
+					xs[i] = src[i].x;
+					ys[i] = src[i].y;
+					zs[i] = src[i].z;
+				}
+				return Vector3Wide(F::Load(xs), F::Load(ys), F::Load(zs));
+			}
+
+			//Transposes the first count lanes back out into dst
+			void Store(Vector3* dst, int count = Width) const {
+				float xs[Width];
+				float ys[Width];
+				float zs[Width];
+				x.Store(xs);
+				y.Store(ys);
+				z.Store(zs);
+				for (int i = 0; i < count && i < Width; ++i) {
+					dst[i] = Vector3(xs[i], ys[i], zs[i]);
+				}
+			}
+
+			//Loads base[indices[i]] into lane i
+			static Vector3Wide Gather(const Vector3* base, const int* indices, int count = Width) {
+				float xs[Width] = { 0 };
+				float ys[Width] = { 0 };
+				float zs[Width] = { 0 };
+				for (int i = 0; i < count && i < Width; ++i) {
+					const Vector3& v = base[indices[i]];
+					xs[i] = v.x;
+					ys[i] = v.y;
+					zs[i] = v.z;
+				}
+				return Vector3Wide(F::Load(xs), F::Load(ys), F::Load(zs));
+			}
+
+			//Writes lane i out to base[indices[i]]
+			void Scatter(Vector3* base, const int* indices, int count = Width) const {
+				float xs[Width];
+				float ys[Width];
+				float zs[Width];
+				x.Store(xs);
+				y.Store(ys);
+				z.Store(zs);
+				for (int i = 0; i < count && i < Width; ++i) {
+					base[indices[i]] = Vector3(xs[i], ys[i], zs[i]);
+				}
+			}
+
+			Vector3 GetLane(int i) const {
+				return Vector3(x.GetLane(i), y.GetLane(i), z.GetLane(i));
+			}
+
+			void SetLane(int i, const Vector3& v) {
+				x.SetLane(i, v.x);
+				y.SetLane(i, v.y);
+				z.SetLane(i, v.z);
+			}
+
+			Vector3Wide operator+(const Vector3Wide& a) const { return Vector3Wide(x + a.x, y + a.y, z + a.z); }
+			Vector3Wide operator-(const Vector3Wide& a) const { return Vector3Wide(x - a.x, y - a.y, z - a.z); }
+			Vector3Wide operator*(const Vector3Wide& a) const { return Vector3Wide(x * a.x, y * a.y, z * a.z); }
+			Vector3Wide operator*(const F& a) const { return Vector3Wide(x * a, y * a, z * a); }
+			Vector3Wide operator/(const F& a) const { return Vector3Wide(x / a, y / a, z / a); }
+			Vector3Wide operator-() const { return Vector3Wide(-x, -y, -z); }
+
+			void operator+=(const Vector3Wide& a) { *this = *this + a; }
+			void operator-=(const Vector3Wide& a) { *this = *this - a; }
+			void operator*=(const F& a) { *this = *this * a; }
+
+			static F Dot(const Vector3Wide& a, const Vector3Wide& b) {
+				return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+			}
+
+			static Vector3Wide Cross(const Vector3Wide& a, const Vector3Wide& b) {
+				return Vector3Wide(
+					(a.y * b.z) - (a.z * b.y),
+					(a.z * b.x) - (a.x * b.z),
+					(a.x * b.y) - (a.y * b.x));
+			}
+
+			F LengthSquared() const {
+				return Dot(*this, *this);
+			}
+
+			F Length() const {
+				return F::Sqrt(LengthSquared());
+			}
+
+			//Zero length lanes are left as zero, rather than filled with NaNs
+			Vector3Wide Normalised() const {
+				F len		= Length();
+				F valid		= len > F(0.0f);
+				F safeLen	= F::Select(valid, len, F(1.0f));
+				return *this / safeLen;
+			}
+
+			static Vector3Wide Select(const F& mask, const Vector3Wide& a, const Vector3Wide& b) {
+				return Vector3Wide(F::Select(mask, a.x, b.x), F::Select(mask, a.y, b.y), F::Select(mask, a.z, b.z));
+			}
+
+			static Vector3Wide Min(const Vector3Wide& a, const Vector3Wide& b) {
+				return Vector3Wide(F::Min(a.x, b.x), F::Min(a.y, b.y), F::Min(a.z, b.z));
+			}
+
+			static Vector3Wide Max(const Vector3Wide& a, const Vector3Wide& b) {
+				return Vector3Wide(F::Max(a.x, b.x), F::Max(a.y, b.y), F::Max(a.z, b.z));
+			}
+
+			F x;
+			F y;
+			F z;
+		};
+
+		template<class F>
+		class QuaternionWide {
+		public:
+			static const int Width = F::Width;
+
+			QuaternionWide() {}
+			QuaternionWide(const F& inX, const F& inY, const F& inZ, const F& inW) : x(inX), y(inY), z(inZ), w(inW) {}
+
+			explicit QuaternionWide(const Quaternion& q) : x(q.x), y(q.y), z(q.z), w(q.w) {}
+
+			static QuaternionWide Load(const Quaternion* src, int count = Width) {
+				float xs[Width] = { 0 };
+				float ys[Width] = { 0 };
+				float zs[Width] = { 0 };
+				float ws[Width] = { 0 };
+				for (int i = 0; i < count && i < Width; ++i) {
+					xs[i] = src[i].x;
+					ys[i] = src[i].y;
+					zs[i] = src[i].z;
+					ws[i] = src[i].w;
+				}
+				return QuaternionWide(F::Load(xs), F::Load(ys), F::Load(zs), F::Load(ws));
+			}
+
+			void Store(Quaternion* dst, int count = Width) const {
+				float xs[Width];
+				float ys[Width];
+				float zs[Width];
+				float ws[Width];
+				x.Store(xs);
+				y.Store(ys);
+				z.Store(zs);
+				w.Store(ws);
+				for (int i = 0; i < count && i < Width; ++i) {
+					dst[i] = Quaternion(xs[i], ys[i], zs[i], ws[i]);
+				}
+			}
+
+			Quaternion GetLane(int i) const {
+				return Quaternion(x.GetLane(i), y.GetLane(i), z.GetLane(i), w.GetLane(i));
+			}
+
+			//Same as Quaternion::operator*, for every lane
+			QuaternionWide operator*(const QuaternionWide& b) const {
+				return QuaternionWide(
+					(x * b.w) + (w * b.x) + (y * b.z) - (z * b.y),
+					(y * b.w) + (w * b.y) + (z * b.x) - (x * b.z),
+					(z * b.w) + (w * b.z) + (x * b.y) - (y * b.x),
+					(w * b.w) - (x * b.x) - (y * b.y) - (z * b.z));
+			}
+
+			QuaternionWide operator+(const QuaternionWide& b) const {
+				return QuaternionWide(x + b.x, y + b.y, z + b.z, w + b.w);
+			}
+
+			QuaternionWide operator*(const F& a) const {
+				return QuaternionWide(x * a, y * a, z * a, w * a);
+			}
+
+			QuaternionWide Conjugate() const {
+				return QuaternionWide(-x, -y, -z, w);
+			}
+
+			static F Dot(const QuaternionWide& a, const QuaternionWide& b) {
+				return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+			}
+
+			void Normalise() {
+				F len		= F::Sqrt(Dot(*this, *this));
+				F valid		= len > F(0.0f);
+				F scale		= F::Select(valid, F(1.0f) / F::Select(valid, len, F(1.0f)), F(1.0f));
+				*this		= *this * scale;
+			}
+
+			//Same as Quaternion::operator*(Vector3)
+			Vector3Wide<F> operator*(const Vector3Wide<F>& a) const {
+				Vector3Wide<F> qvec(x, y, z);
+				Vector3Wide<F> uv	= -Vector3Wide<F>::Cross(qvec, a);
+				Vector3Wide<F> uuv	= -Vector3Wide<F>::Cross(qvec, uv);
+				uv	*= (w * F(2.0f));
+				uuv *= F(2.0f);
+				return a + (uv + uuv);
+			}
+
+			F x;
+			F y;
+			F z;
+			F w;
+		};
+
+		/*
+		values is laid out the same way as Matrix3::values - so values[0-2] are
+		the first column - with each of the 9 elements holding Width matrices.
+		*/
+		template<class F>
+		class Matrix3Wide {
+		public:
+			static const int Width = F::Width;
+
+			Matrix3Wide() {
+				for (int i = 0; i < 9; ++i) {
+					values[i] = F((i % 4) == 0 ? 1.0f : 0.0f);
+				}
+			}
+
+			explicit Matrix3Wide(const Matrix3& m) {
+				for (int i = 0; i < 9; ++i) {
+					values[i] = F(m.values[i]);
+				}
+			}
+
+			static Matrix3Wide Load(const Matrix3* src, int count = Width) {
+				Matrix3Wide out;
+				for (int e = 0; e < 9; ++e) {
+					float lanes[Width] = { 0 };
+					for (int i = 0; i < count && i < Width; ++i) {
+						lanes[i] = src[i].values[e];
+					}
+					out.values[e] = F::Load(lanes);
+				}
+				return out;
+			}
+
+			void Store(Matrix3* dst, int count = Width) const {
+				for (int e = 0; e < 9; ++e) {
+					float lanes[Width];
+					values[e].Store(lanes);
+					for (int i = 0; i < count && i < Width; ++i) {
+						dst[i].values[e] = lanes[i];
+					}
+				}
+			}
+
+			//Same as Quaternion::ToMatrix3, for every lane
+			static Matrix3Wide FromQuaternion(const QuaternionWide<F>& q) {
+				Matrix3Wide m;
+				F two(2.0f);
+				F one(1.0f);
+
+				F yy = q.y * q.y;	F zz = q.z * q.z;	F xy = q.x * q.y;
+				F zw = q.z * q.w;	F xz = q.x * q.z;	F yw = q.y * q.w;
+				F xx = q.x * q.x;	F yz = q.y * q.z;	F xw = q.x * q.w;
+
+				m.values[0] = one - two * yy - two * zz;
+				m.values[1] = two * xy + two * zw;
+				m.values[2] = two * xz - two * yw;
+
+				m.values[3] = two * xy - two * zw;
+				m.values[4] = one - two * xx - two * zz;
+				m.values[5] = two * yz + two * xw;
+
+				m.values[6] = two * xz + two * yw;
+				m.values[7] = two * yz - two * xw;
+				m.values[8] = one - two * xx - two * yy;
+				return m;
+			}
+
+			Vector3Wide<F> operator*(const Vector3Wide<F>& v) const {
+				return Vector3Wide<F>(
+					v.x * values[0] + v.y * values[3] + v.z * values[6],
+					v.x * values[1] + v.y * values[4] + v.z * values[7],
+					v.x * values[2] + v.y * values[5] + v.z * values[8]);
+			}
+
+			Matrix3Wide operator*(const Matrix3Wide& a) const {
+				Matrix3Wide out;
+				for (int r = 0; r < 3; ++r) {
+					for (int c = 0; c < 3; ++c) {
+						out.values[c + (r * 3)] =
+							values[c]		* a.values[(r * 3)] +
+							values[c + 3]	* a.values[(r * 3) + 1] +
+							values[c + 6]	* a.values[(r * 3) + 2];
+					}
+				}
+				return out;
+			}
+
+			Matrix3Wide Transposed() const {
+				Matrix3Wide out;
+				for (int r = 0; r < 3; ++r) {
+					for (int c = 0; c < 3; ++c) {
+						out.values[c + (r * 3)] = values[r + (c * 3)];
+					}
+				}
+				return out;
+			}
+
+			F values[9];
+		};
+
+		typedef Vector3Wide<Floatx4>	Vector3x4;
+		typedef Vector3Wide<Floatx8>	Vector3x8;
+		typedef QuaternionWide<Floatx4>	Quaternionx4;
+		typedef Matrix3Wide<Floatx4>	Matrix3x4;
+	}
+}
@@ -4,6 +4,7 @@
 #ifdef _WIN32
 #include "Win32Window.h"
 #endif
+#include "HeadlessWindow.h"
 
 #include "RendererBase.h"
 
@@ -33,9 +34,18 @@ Window* Window::CreateGameWindow(std::string title, int sizeX, int sizeY, bool f
 	}
 #ifdef _WIN32
 	return new Win32Code::Win32Window(title, sizeX, sizeY, fullScreen, offsetX, offsetY);
+#else
+	return new Headless::HeadlessWindow(title, sizeX, sizeY);
 #endif
 }
 
+Window* Window::CreateHeadlessWindow(std::string title, int sizeX, int sizeY) {
+	if (window) {
+		return nullptr;
+	}
+	return new Headless::HeadlessWindow(title, sizeX, sizeY);
+}
+
 void	Window::SetRenderer(RendererBase* r) {
 	if (renderer && renderer != r) {
 		renderer->OnWindowDetach();
@@ -28,8 +28,12 @@ namespace NCL {
 	
 	class Window {
 	public:
+		//Without Win32, this is always a HeadlessWindow
 		static Window* CreateGameWindow(std::string title = "NCLGL!", int sizeX = 800, int sizeY = 600, bool fullScreen = false, int offsetX = 100, int offsetY = 100);
 
+		//A window with no OS window or input, for servers and tools
+		static Window* CreateHeadlessWindow(std::string title = "NCLGL!", int sizeX = 800, int sizeY = 600);
+
 		static void DestroyGameWindow() {
 			delete window;
 			window = nullptr;
@@ -0,0 +1,279 @@
+/*
+Bakes navigation data for a level, from its static collision geometry, so
+that grids and meshes don't have to be made by hand.
+
+Usage:
+	NavBaker --scene level.txt (--grid out.txt | --binary-grid out.navgrid | --mesh out.navmesh)
+		[--cell-size 1] [--cell-height 0.25] [--agent-height 2]
+		[--agent-radius 0.5] [--max-climb 0.5] [--max-slope 45]
+		[--start x,y,z] [--node-size 1]
+
+The scene is a text file, one object per line, with # for comments:
+
+	box		px py pz	hx hy hz				an axis aligned box, as placed by
+											AddCubeToWorld or AddFloorToWorld
+	mesh	file.msh	px py pz	sx sy sz	[yaw]	a mesh from Assets/Meshes,
+											scaled, turned about y (degrees)
+											and then moved
+
+Only the walkable region the --start position is in is kept - or without a
+start, the biggest one. --grid writes a NavigationGrid text file, with nodes
+--node-size apart, covering everything in the scene, and --binary-grid
+writes the same grid in the binary format, which loads much faster; --mesh
+writes a NavigationMesh file. Any of them can be given together.
+*/
+#include "../CSC8503/CSC8503Common/NavigationBaker.h"
+#include "../CSC8503/CSC8503Common/NavigationMesh.h"
+#include "../Common/MeshGeometry.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NCL;
+using namespace NCL::CSC8503;
+
+namespace {
+	//MeshGeometry can't be made on its own, as it doesn't know how to
+	//upload itself - but nothing here needs it on the GPU
+	class BakeMesh : public MeshGeometry {
+	public:
+		BakeMesh(const std::string& filename) : MeshGeometry(filename) {}
+		void UploadToGPU() override {}
+	};
+
+	struct Settings {
+		NavigationBakeSettings	bake;
+		std::string				sceneFile;
+		std::string				gridFile;
+		std::string				binaryGridFile;
+		std::string				meshFile;
+		int						nodeSize = 1;
+		bool					hasStart = false;
+		Vector3					start;
+	};
+
+	bool ParseVector(const std::string& text, Vector3& out) {
+		std::istringstream input(text);
+		char comma1 = 0;
+		char comma2 = 0;
+		input >> out.x >> comma1 >> out.y >> comma2 >> out.z;
+		return input && comma1 == ',' && comma2 == ',';
+	}
+
+	//Reads a number that has to make up all of text - std::stof would
+	//throw on rubbish, and quietly ignore anything after the number
+	template<typename T>
+	bool ParseNumber(const std::string& arg, const std::string& text, T& out) {
+		std::istringstream input(text);
+		char extra = 0;
+		input >> out;
+		if (!input || input >> extra) {
+			std::cerr << arg << " should be a number, not " << text << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseArguments(int argc, char** argv, Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg		= argv[i];
+			bool		hasNext = i + 1 < argc;
+			bool		valid	= true;
+
+			if (arg == "--scene" && hasNext) {
+				settings.sceneFile = argv[++i];
+			}
+			else if (arg == "--grid" && hasNext) {
+				settings.gridFile = argv[++i];
+			}
+			else if (arg == "--binary-grid" && hasNext) {
+				settings.binaryGridFile = argv[++i];
+			}
+			else if (arg == "--mesh" && hasNext) {
+				settings.meshFile = argv[++i];
+			}
+			else if (arg == "--cell-size" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.cellSize);
+			}
+			else if (arg == "--cell-height" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.cellHeight);
+			}
+			else if (arg == "--agent-height" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.agentHeight);
+			}
+			else if (arg == "--agent-radius" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.agentRadius);
+			}
+			else if (arg == "--max-climb" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.maxClimb);
+			}
+			else if (arg == "--max-slope" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.bake.maxSlope);
+			}
+			else if (arg == "--node-size" && hasNext) {
+				valid = ParseNumber(arg, argv[++i], settings.nodeSize);
+			}
+			else if (arg == "--start" && hasNext) {
+				valid = ParseVector(argv[++i], settings.start);
+				if (!valid) {
+					std::cerr << "--start should be x,y,z\n";
+				}
+				settings.hasStart = true;
+			}
+			else {
+				std::cerr << "Unknown argument " << arg << "\n";
+				return false;
+			}
+			if (!valid) {
+				return false;
+			}
+		}
+		if (settings.sceneFile.empty()) {
+			std::cerr << "No --scene given\n";
+			return false;
+		}
+		if (settings.gridFile.empty() && settings.binaryGridFile.empty() && settings.meshFile.empty()) {
+			std::cerr << "Nothing to write - give --grid, --binary-grid or --mesh\n";
+			return false;
+		}
+		if (settings.bake.cellSize <= 0.0f || settings.bake.cellHeight <= 0.0f) {
+			std::cerr << "--cell-size and --cell-height have to be above 0\n";
+			return false;
+		}
+		if (settings.nodeSize < 1) {
+			std::cerr << "--node-size has to be at least 1\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool LoadScene(const std::string& filename, NavigationBaker& baker) {
+		std::ifstream file(filename);
+		if (!file) {
+			std::cerr << "Couldn't open " << filename << "\n";
+			return false;
+		}
+		int			lineNumber	= 0;
+		int			objects		= 0;
+		std::string line;
+		while (std::getline(file, line)) {
+			lineNumber++;
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream	input(line);
+			std::string			type;
+			if (!(input >> type)) {
+				continue; //blank
+			}
+			if (type == "box") {
+				Vector3 position;
+				Vector3 halfSize;
+				input >> position.x >> position.y >> position.z >> halfSize.x >> halfSize.y >> halfSize.z;
+				if (!input) {
+					std::cerr << filename << ":" << lineNumber << ": expected box px py pz hx hy hz\n";
+					return false;
+				}
+				baker.AddBox(position, halfSize);
+			}
+			else if (type == "mesh") {
+				std::string meshName;
+				Vector3		position;
+				Vector3		scale;
+				float		yaw = 0.0f;
+				input >> meshName >> position.x >> position.y >> position.z >> scale.x >> scale.y >> scale.z;
+				if (!input) {
+					std::cerr << filename << ":" << lineNumber << ": expected mesh file.msh px py pz sx sy sz [yaw]\n";
+					return false;
+				}
+				input >> yaw;
+
+				BakeMesh mesh(meshName);
+				if (mesh.GetVertexCount() == 0) {
+					std::cerr << filename << ":" << lineNumber << ": couldn't load " << meshName << "\n";
+					return false;
+				}
+				Matrix4 transform = Matrix4::Translation(position) * Matrix4::Rotation(yaw, Vector3(0, 1, 0)) * Matrix4::Scale(scale);
+				baker.AddTriangles(mesh.GetPositionData(), mesh.GetIndexData(), transform);
+			}
+			else {
+				std::cerr << filename << ":" << lineNumber << ": unknown object type " << type << "\n";
+				return false;
+			}
+			objects++;
+		}
+		std::cerr << "Loaded " << objects << " objects from " << filename << "\n";
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	Settings settings;
+	if (!ParseArguments(argc, argv, settings)) {
+		return 1;
+	}
+	NavigationBaker baker(settings.bake);
+	if (!LoadScene(settings.sceneFile, baker)) {
+		return 1;
+	}
+
+	bool baked = settings.hasStart ? baker.Bake(settings.start) : baker.Bake();
+	if (!baked) {
+		std::cerr << "Nothing walkable was found!\n";
+		return 1;
+	}
+	int walkable = 0;
+	for (int z = 0; z < baker.GetDepth(); ++z) {
+		for (int x = 0; x < baker.GetWidth(); ++x) {
+			walkable += baker.IsWalkable(x, z) ? 1 : 0;
+		}
+	}
+	std::cerr << "Baked " << baker.GetWidth() << "x" << baker.GetDepth() << " columns, " << walkable
+		<< " walkable, from " << baker.GetRegionCount() << " regions\n";
+
+	if (!settings.gridFile.empty()) {
+		std::ofstream file(settings.gridFile);
+		if (!file) {
+			std::cerr << "Couldn't open " << settings.gridFile << " for writing\n";
+			return 1;
+		}
+		if (!baker.WriteGrid(file, settings.nodeSize)) {
+			std::cerr << "None of the grid's nodes are walkable - try a smaller --node-size\n";
+			return 1;
+		}
+		std::cerr << "Wrote " << settings.gridFile << "\n";
+	}
+	if (!settings.binaryGridFile.empty()) {
+		std::ofstream file(settings.binaryGridFile, std::ios::binary);
+		if (!file) {
+			std::cerr << "Couldn't open " << settings.binaryGridFile << " for writing\n";
+			return 1;
+		}
+		if (!baker.WriteBinaryGrid(file, settings.nodeSize)) {
+			std::cerr << "None of the grid's nodes are walkable - try a smaller --node-size\n";
+			return 1;
+		}
+		std::cerr << "Wrote " << settings.binaryGridFile << "\n";
+	}
+	if (!settings.meshFile.empty()) {
+		std::vector<Vector3>			vertices;
+		std::vector<std::vector<int>>	polygons;
+		baker.BuildMesh(vertices, polygons);
+		NavigationMesh mesh(vertices, polygons);
+
+		std::ofstream file(settings.meshFile, std::ios::binary);
+		if (!file) {
+			std::cerr << "Couldn't open " << settings.meshFile << " for writing\n";
+			return 1;
+		}
+		if (!mesh.WriteMesh(file)) {
+			std::cerr << "Couldn't write " << settings.meshFile << "\n";
+			return 1;
+		}
+		std::cerr << "Wrote " << settings.meshFile << " - " << mesh.GetPolygonCount() << " polygons, "
+			<< mesh.GetVertexCount() << " vertices\n";
+	}
+	return 0;
+}
@@ -32,9 +32,9 @@ namespace NCL {
 
 			void OnWindowResize(int w, int h)	override;
 
-			void DrawString(const std::string& text, const Vector2&pos, const Vector4& colour = Vector4(0.75f, 0.75f, 0.75f,1));
+			void DrawString(const std::string& text, const Vector2&pos, const Vector4& colour = Vector4(0.75f, 0.75f, 0.75f,1)) override;
 
-			void DrawLine(const Vector3& start, const Vector3& end, const Vector4& colour);
+			void DrawLine(const Vector3& start, const Vector3& end, const Vector4& colour) override;
 
 		protected:			
 			void BeginFrame()	override;